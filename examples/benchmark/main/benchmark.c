@@ -0,0 +1,114 @@
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "rc522.h"
+#include "driver/rc522_spi.h"
+#include "picc/rc522_mifare.h"
+
+static const char *TAG = "rc522-benchmark-example";
+
+#define RC522_SPI_BUS_GPIO_MISO    (25)
+#define RC522_SPI_BUS_GPIO_MOSI    (23)
+#define RC522_SPI_BUS_GPIO_SCLK    (19)
+#define RC522_SPI_SCANNER_GPIO_SDA (22)
+#define RC522_SCANNER_GPIO_RST     (-1) // soft-reset
+
+// Set to 1 to measure the half-duplex mode,
+// where every byte is read in a separate transaction
+#define BENCHMARK_SPI_HALF_DUPLEX (0)
+
+#define BENCHMARK_BLOCK_ADDRESS (4)
+#define BENCHMARK_ITERATIONS    (100)
+
+static volatile uint32_t spi_transactions = 0;
+
+static void IRAM_ATTR on_spi_transaction_done(spi_transaction_t *trans)
+{
+    spi_transactions++;
+}
+
+static rc522_spi_config_t driver_config = {
+    .host_id = SPI3_HOST,
+    .bus_config = &(spi_bus_config_t){
+        .miso_io_num = RC522_SPI_BUS_GPIO_MISO,
+        .mosi_io_num = RC522_SPI_BUS_GPIO_MOSI,
+        .sclk_io_num = RC522_SPI_BUS_GPIO_SCLK,
+    },
+    .dev_config = {
+        .spics_io_num = RC522_SPI_SCANNER_GPIO_SDA,
+        .post_cb = on_spi_transaction_done,
+#if BENCHMARK_SPI_HALF_DUPLEX
+        .flags = SPI_DEVICE_HALFDUPLEX,
+#endif
+    },
+    .rst_io_num = RC522_SCANNER_GPIO_RST,
+};
+
+static rc522_driver_handle_t driver;
+static rc522_handle_t scanner;
+
+static esp_err_t benchmark(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    rc522_mifare_key_t key = {
+        .value = { RC522_MIFARE_KEY_VALUE_DEFAULT },
+    };
+
+    ESP_RETURN_ON_ERROR(rc522_mifare_auth(scanner, picc, BENCHMARK_BLOCK_ADDRESS, &key), TAG, "auth fail");
+
+    uint8_t buffer[RC522_MIFARE_BLOCK_SIZE];
+    uint32_t transactions_start = spi_transactions;
+    int64_t time_start = esp_timer_get_time();
+
+    for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        ESP_RETURN_ON_ERROR(rc522_mifare_read(scanner, picc, BENCHMARK_BLOCK_ADDRESS, buffer), TAG, "read fail");
+    }
+
+    int64_t time_us = esp_timer_get_time() - time_start;
+    uint32_t transactions = spi_transactions - transactions_start;
+
+    ESP_LOGI(TAG, "Mode: %s", BENCHMARK_SPI_HALF_DUPLEX ? "half-duplex (byte per transaction)" : "full-duplex (burst)");
+    ESP_LOGI(TAG, "Reads: %d (block %d)", BENCHMARK_ITERATIONS, BENCHMARK_BLOCK_ADDRESS);
+    ESP_LOGI(TAG, "SPI transactions per read: %" PRIu32, transactions / BENCHMARK_ITERATIONS);
+    ESP_LOGI(TAG, "Time per read: %" PRId64 " us", time_us / BENCHMARK_ITERATIONS);
+
+    return ESP_OK;
+}
+
+static void on_picc_state_changed(void *arg, esp_event_base_t base, int32_t event_id, void *data)
+{
+    rc522_picc_state_changed_event_t *event = (rc522_picc_state_changed_event_t *)data;
+    rc522_picc_t *picc = event->picc;
+
+    if (picc->state != RC522_PICC_STATE_ACTIVE) {
+        return;
+    }
+
+    rc522_picc_print(picc);
+
+    if (!rc522_mifare_type_is_classic_compatible(picc->type)) {
+        ESP_LOGW(TAG, "Card is not supported by this example");
+        return;
+    }
+
+    if (benchmark(scanner, picc) != ESP_OK) {
+        ESP_LOGE(TAG, "Benchmark failed");
+    }
+
+    if (rc522_mifare_deauth(scanner, picc) != ESP_OK) {
+        ESP_LOGW(TAG, "Deauth failed");
+    }
+}
+
+void app_main()
+{
+    rc522_spi_create(&driver_config, &driver);
+    rc522_driver_install(driver);
+
+    rc522_config_t scanner_config = {
+        .driver = driver,
+    };
+
+    rc522_create(&scanner_config, &scanner);
+    rc522_register_events(scanner, RC522_EVENT_PICC_STATE_CHANGED, on_picc_state_changed, NULL);
+    rc522_start(scanner);
+}
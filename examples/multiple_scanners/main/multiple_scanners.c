@@ -1,5 +1,6 @@
 #include <esp_log.h>
 #include "rc522.h"
+#include "rc522_group.h"
 #include "driver/rc522_spi.h"
 #include "rc522_picc.h"
 
@@ -49,8 +50,9 @@ static rc522_spi_config_t scanner_2_config = {
 static rc522_driver_handle_t driver_1;
 static rc522_driver_handle_t driver_2;
 
-// Scanners
+// Scanners share a single polling task
 
+static rc522_group_handle_t group;
 static rc522_handle_t scanner_1;
 static rc522_handle_t scanner_2;
 
@@ -93,15 +95,19 @@ void app_main()
 
     // Create scanners
 
+    rc522_group_create(&(rc522_group_config_t) { 0 }, &group);
+
     rc522_create(
         &(rc522_config_t) {
             .driver = driver_1,
+            .group = group,
         },
         &scanner_1);
 
     rc522_create(
         &(rc522_config_t) {
             .driver = driver_2,
+            .group = group,
         },
         &scanner_2);
 
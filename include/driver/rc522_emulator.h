@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rc522_types.h"
+#include "rc522_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_EMULATOR_PICC_COUNT_MAX (4)
+
+typedef enum
+{
+    RC522_EMULATOR_PICC_MIFARE_1K = 0,
+    RC522_EMULATOR_PICC_MIFARE_4K,
+    RC522_EMULATOR_PICC_MIFARE_UL, // MIFARE Ultralight, 64 bytes
+    RC522_EMULATOR_PICC_NTAG213,
+    RC522_EMULATOR_PICC_NTAG215,
+    RC522_EMULATOR_PICC_NTAG216,
+
+    /**
+     * ISO/IEC 14443-4 PICC with one 2 KB transparent file, accessed by SELECT,
+     * READ BINARY and UPDATE BINARY APDUs. UPDATE BINARY asks for a waiting time extension.
+     * Bit rates up to 848 kbit/s can be set by PPS.
+     */
+    RC522_EMULATOR_PICC_ISO_14443_4,
+} rc522_emulator_picc_type_t;
+
+typedef struct
+{
+    /**
+     * Value of the VersionReg register.
+     * Defaults to 0x92 (v2.0) if not set.
+     */
+    uint8_t firmware;
+
+    /**
+     * Signal the end of a command through the virtual IRQ
+     * (see rc522_driver_raise_irq), instead of letting the driver poll.
+     */
+    bool irq;
+} rc522_emulator_config_t;
+
+typedef struct
+{
+    rc522_emulator_picc_type_t type;
+    uint8_t uid[RC522_PICC_UID_SIZE_MAX];
+
+    /**
+     * 4, 7 or 10 bytes. MIFARE Ultralight and NTAG PICCs have 7 byte UID.
+     * ISO/IEC 14443-4 PICC with 7 byte UID is identified as MIFARE DESFire (by its ATQA).
+     */
+    uint8_t uid_length;
+
+    /**
+     * Highest bit rate (in kbit/s) at which frames still get through, like with a PICC far from the antenna.
+     * Higher bit rates are accepted by PPS, but frames exchanged at them are lost. 0 for no limit.
+     */
+    uint16_t max_bitrate_kbps;
+
+    /**
+     * Waiting time extension multiplier (1-59) asked for by UPDATE BINARY of ISO/IEC 14443-4 PICC.
+     * The write then takes all but one FWT of the extended waiting time. Defaults to 2 if not set.
+     */
+    uint8_t wtxm;
+} rc522_emulator_picc_config_t;
+
+/**
+ * Creates driver of a software MFRC522 (register file, FIFO, timer, CRC coprocessor,
+ * commands and interrupts), with virtual PICCs in its field.
+ *
+ * Crypto1 is terminated by the PCD, so the driver never sees the cipher stream.
+ * The emulator models the authentication (keys from sector trailers, UID) and
+ * the encrypted session, but does not implement the cipher itself.
+ * Access conditions of MIFARE Classic sectors are not enforced.
+ */
+esp_err_t rc522_emulator_create(const rc522_emulator_config_t *config, rc522_driver_handle_t *driver);
+
+/**
+ * Puts new PICC into the field. Memory of the PICC is initialized to factory
+ * defaults (transport keys for MIFARE Classic, empty NDEF message for NTAG).
+ *
+ * @param[out] out_index Index of the PICC, used with other rc522_emulator_picc_* functions
+ */
+esp_err_t rc522_emulator_picc_add(
+    rc522_driver_handle_t driver, const rc522_emulator_picc_config_t *config, uint8_t *out_index);
+
+/**
+ * Removes PICC from the field and releases its memory
+ */
+esp_err_t rc522_emulator_picc_remove(rc522_driver_handle_t driver, uint8_t index);
+
+/**
+ * Moves PICC into or out of the field, keeping its memory.
+ * PICC that enters the field is in IDLE state.
+ */
+esp_err_t rc522_emulator_picc_set_in_field(rc522_driver_handle_t driver, uint8_t index, bool in_field);
+
+/**
+ * Reads memory of the PICC. Memory is addressed by blocks (MIFARE Classic)
+ * or pages (Ultralight, NTAG), so the offset of the block N is N * 16
+ * and offset of the page N is N * 4. Memory of ISO/IEC 14443-4 PICC is its file.
+ */
+esp_err_t rc522_emulator_picc_read_memory(
+    rc522_driver_handle_t driver, uint8_t index, uint16_t offset, uint8_t *buffer, uint16_t length);
+
+esp_err_t rc522_emulator_picc_write_memory(
+    rc522_driver_handle_t driver, uint8_t index, uint16_t offset, const uint8_t *buffer, uint16_t length);
+
+/**
+ * Returns the time the RF interface has been busy since the emulator was created: frames in both directions
+ * at their bit rates, frame delay times and expired timeouts. Unlike the wall-clock time of the tests,
+ * it is what a real PCD would spend on the air, so it is used to compare bit rates.
+ */
+esp_err_t rc522_emulator_get_air_time(rc522_driver_handle_t driver, uint32_t *out_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -20,10 +20,45 @@ typedef struct
      * Set to -1 if the RST pin is not connected.
      */
     gpio_num_t rst_io_num;
+
+    /**
+     * Set if the RC522 IRQ pin is connected to irq_io_num.
+     * The driver then sleeps until the PCD signals completion
+     * of a command, instead of polling its interrupt registers.
+     * Left unset, irq_io_num is not touched.
+     */
+    bool irq_enabled;
+
+    /**
+     * GPIO number of the RC522 IRQ pin, used only if irq_enabled is set
+     */
+    gpio_num_t irq_io_num;
 } rc522_i2c_config_t;
 
+#define RC522_I2C_BATCH_OPS_MAX (8) // Ops per I2C command link, longer batches are split
+
+// Every op takes up to two "transactions" (start, address, register, [start, address], data)
+#define RC522_I2C_BATCH_LINK_SIZE (I2C_LINK_RECOMMENDED_SIZE(2 * RC522_I2C_BATCH_OPS_MAX))
+
+/**
+ * Storage of the driver created by rc522_i2c_create_static(), must stay valid as long as the driver is used
+ */
+typedef struct
+{
+    rc522_driver_static_t driver;
+    rc522_i2c_config_t config;
+    uint8_t batch_link[RC522_I2C_BATCH_LINK_SIZE]; /*<! Command link of batched transactions */
+} rc522_i2c_static_t;
+
 esp_err_t rc522_i2c_create(const rc522_i2c_config_t *config, rc522_driver_handle_t *driver);
 
+/**
+ * Same as rc522_i2c_create(), but without heap. Note that i2c_driver_install(),
+ * called when the driver is installed, allocates memory of the I2C port
+ */
+esp_err_t rc522_i2c_create_static(
+    const rc522_i2c_config_t *config, rc522_i2c_static_t *buffers, rc522_driver_handle_t *driver);
+
 #ifdef __cplusplus
 }
 #endif
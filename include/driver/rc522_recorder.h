@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "rc522_types.h"
+#include "rc522_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Every record starts with a header (all fields are little-endian):
+ *
+ *   0  uint32  timestamp, in microseconds since the recording started
+ *   4  uint16  duration of the transaction, in microseconds (saturated)
+ *   6  uint8   type (rc522_record_type_t) and flags
+ *   7  uint8   register address
+ *   8  uint8   length of the payload
+ *
+ * followed by the payload: bytes written to or read from the register,
+ * or the esp_err_t (4 bytes) returned by the driver if the ERROR flag is set.
+ */
+#define RC522_RECORD_HEADER_SIZE (9)
+
+typedef enum
+{
+    RC522_RECORD_WRITE = 0,
+    RC522_RECORD_READ,
+    RC522_RECORD_RESET,
+} rc522_record_type_t;
+
+#define RC522_RECORD_TYPE_MASK  (0x0F)
+#define RC522_RECORD_FLAG_BATCH (0x80) // Op is part of the batch started by the previous record
+#define RC522_RECORD_FLAG_ERROR (0x40) // Driver failed, payload holds the esp_err_t
+
+typedef struct
+{
+    /**
+     * Driver which does the actual bus transactions.
+     * Recorder takes its ownership, it is installed and uninstalled
+     * together with the recorder.
+     */
+    rc522_driver_handle_t driver;
+
+    /**
+     * Size of the in-memory ring buffer. When the buffer is full,
+     * the oldest records are dropped. Set to 0 to record into the file only.
+     */
+    size_t buffer_size;
+
+    /**
+     * Optional. Records are also appended to this file, e.g. on SD card
+     * or SPIFFS. File is not closed by the recorder.
+     */
+    FILE *file;
+} rc522_recorder_config_t;
+
+/**
+ * Creates driver which passes every register access to the wrapped driver
+ * and records it, including timing and errors. Recording can be played back
+ * with rc522_replay driver.
+ *
+ * IRQ of the wrapped driver (if enabled) is used by the recorder.
+ */
+esp_err_t rc522_recorder_create(const rc522_recorder_config_t *config, rc522_driver_handle_t *driver);
+
+/**
+ * Copies records from the ring buffer, oldest first.
+ *
+ * @return ESP_ERR_INVALID_SIZE if the buffer is too small
+ */
+esp_err_t rc522_recorder_read(rc522_driver_handle_t driver, uint8_t *buffer, size_t size, size_t *out_length);
+
+/**
+ * Drops all records from the ring buffer and restarts the timestamps
+ */
+esp_err_t rc522_recorder_clear(rc522_driver_handle_t driver);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rc522_types.h"
+#include "rc522_driver.h"
+#include "driver/rc522_recorder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    /**
+     * Records produced by rc522_recorder. Must stay valid while the driver is installed.
+     */
+    const uint8_t *log;
+    size_t length;
+
+    /**
+     * Hold every transaction until its recorded end, so timeouts
+     * of the library expire the same way as during the recording.
+     * Otherwise the log is played back as fast as possible.
+     */
+    bool paced;
+} rc522_replay_config_t;
+
+/**
+ * Creates driver which answers register accesses from the log,
+ * without touching any hardware. Every write and read must match
+ * the recorded one (type, address, length and written bytes),
+ * otherwise RC522_ERR_REPLAY_MISMATCH is returned. Recorded errors
+ * are returned the same way as they were returned by the recorded driver.
+ *
+ * Replay driver has no IRQ, so the log has to be recorded
+ * with a driver that polls for the completion of commands.
+ */
+esp_err_t rc522_replay_create(const rc522_replay_config_t *config, rc522_driver_handle_t *driver);
+
+/**
+ * @param[out] out_finished All records have been played back
+ */
+esp_err_t rc522_replay_finished(rc522_driver_handle_t driver, bool *out_finished);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,6 +15,18 @@ typedef struct
 {
     spi_host_device_t host_id;
     spi_bus_config_t *bus_config;
+
+    /**
+     * Device configuration. Mode, command, address and dummy bits
+     * are overwritten by the driver.
+     *
+     * By default device is used in full-duplex mode, which allows
+     * reading multiple bytes (e.g. FIFO) in a single transaction.
+     * Set SPI_DEVICE_HALFDUPLEX flag to fall back to one transaction per byte.
+     *
+     * Frames of batched register accesses are queued together, up to queue_size
+     * (defaults to 7) at once, and use DMA if dma_chan is set.
+     */
     spi_device_interface_config_t dev_config;
     spi_dma_chan_t dma_chan;
 
@@ -23,10 +35,38 @@ typedef struct
      * Set to -1 if the RST pin is not connected.
      */
     gpio_num_t rst_io_num;
+
+    /**
+     * Set if the RC522 IRQ pin is connected to irq_io_num.
+     * The driver then sleeps until the PCD signals completion
+     * of a command, instead of polling its interrupt registers.
+     * Left unset, irq_io_num is not touched.
+     */
+    bool irq_enabled;
+
+    /**
+     * GPIO number of the RC522 IRQ pin, used only if irq_enabled is set
+     */
+    gpio_num_t irq_io_num;
 } rc522_spi_config_t;
 
+/**
+ * Storage of the driver created by rc522_spi_create_static(), must stay valid as long as the driver is used
+ */
+typedef struct
+{
+    rc522_driver_static_t driver;
+    rc522_spi_config_t config;
+} rc522_spi_static_t;
+
 esp_err_t rc522_spi_create(const rc522_spi_config_t *config, rc522_driver_handle_t *driver);
 
+/**
+ * Same as rc522_spi_create(), but without heap
+ */
+esp_err_t rc522_spi_create_static(
+    const rc522_spi_config_t *config, rc522_spi_static_t *buffers, rc522_driver_handle_t *driver);
+
 #ifdef __cplusplus
 }
 #endif
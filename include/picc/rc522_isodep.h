@@ -0,0 +1,145 @@
+#pragma once
+
+#include "rc522_types.h"
+#include "rc522_picc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_ERR_ISODEP_BASE                (RC522_ERR_BASE + 0x1FF)
+#define RC522_ERR_ISODEP_INVALID_ATS         (RC522_ERR_ISODEP_BASE + 1)
+#define RC522_ERR_ISODEP_PROTOCOL_ERROR      (RC522_ERR_ISODEP_BASE + 2) // Unexpected or malformed block
+#define RC522_ERR_ISODEP_RESPONSE_TOO_LONG   (RC522_ERR_ISODEP_BASE + 3) // Response APDU does not fit the buffer
+#define RC522_ERR_ISODEP_BITRATE_UNSUPPORTED (RC522_ERR_ISODEP_BASE + 4) // Bit rate not supported by the PICC
+
+/**
+ * Largest frame exchanged with the PICC, including PCB and CRC_A (FSD = 256, FSDI = 8).
+ * Frames longer than the FIFO of the PCD are streamed through it, so APDUs are chained less often.
+ */
+#define RC522_ISODEP_FRAME_SIZE_MAX (256)
+#define RC522_ISODEP_ATS_SIZE_MAX   (RC522_ISODEP_FRAME_SIZE_MAX - 2) // ATS without CRC_A
+
+typedef enum
+{
+    RC522_ISODEP_BITRATE_106 = 0, /*<! 106 kbit/s, used by every PICC until PPS */
+    RC522_ISODEP_BITRATE_212,
+    RC522_ISODEP_BITRATE_424,
+    RC522_ISODEP_BITRATE_848,
+} rc522_isodep_bitrate_t;
+
+/**
+ * Answer To Select (ISO/IEC 14443-4, section 5.2), with defaults for the missing interface bytes
+ */
+typedef struct
+{
+    uint16_t fsc;       /*<! Largest frame the PICC receives, including PCB and CRC_A (from FSCI) */
+    uint8_t fwi;        /*<! Frame Waiting time Integer */
+    uint8_t sfgi;       /*<! Start-up Frame Guard time Integer */
+    uint8_t ta;         /*<! TA(1), bit rates supported by the PICC, 0x00 if only 106 kbit/s */
+    bool cid_supported; /*<! PICC accepts CID in the blocks */
+    bool nad_supported; /*<! PICC accepts NAD in the blocks */
+    uint8_t historical_bytes[RC522_ISODEP_ATS_SIZE_MAX];
+    uint8_t historical_bytes_length;
+} rc522_isodep_ats_t;
+
+/**
+ * ISO-DEP (ISO/IEC 14443-4) session with the active PICC, created by rc522_isodep_activate().
+ * CID and NAD are not used, so only one PICC at a time can be in the session.
+ */
+typedef struct
+{
+    rc522_isodep_ats_t ats;
+    uint32_t fwt_us;            /*<! Frame waiting time, from FWI */
+    uint16_t frame_size;        /*<! Largest frame sent to the PICC: FSC, limited by RC522_ISODEP_FRAME_SIZE_MAX */
+    uint8_t block_number;       /*<! Block number of the PCD, toggled by every acknowledged I-block */
+    rc522_isodep_bitrate_t dsi; /*<! Bit rate from the PICC to the PCD, set by PPS */
+    rc522_isodep_bitrate_t dri; /*<! Bit rate from the PCD to the PICC, set by PPS */
+} rc522_isodep_t;
+
+/**
+ * @brief Checks if the PICC supports ISO/IEC 14443-4 (SAK bit 6)
+ */
+bool rc522_isodep_is_compliant(const rc522_picc_t *picc);
+
+/**
+ * @brief Moves the selected PICC into the ISO-DEP protocol.
+ *
+ * Sends RATS (with FSD of @c RC522_ISODEP_FRAME_SIZE_MAX and CID 0), parses the ATS
+ * and waits the start-up frame guard time of the PICC.
+ *
+ * @note Until it is deselected, the PICC answers ISO-DEP blocks only, so it ignores WUPA of the presence check.
+ *       Call @c rc522_isodep_deselect() once done with the PICC.
+ *
+ * @param rc522 RC522 handle
+ * @param picc PICC that is currently selected
+ * @param[out] out_isodep Session with the PICC
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if the PICC is not ISO/IEC 14443-4 compliant
+ */
+esp_err_t rc522_isodep_activate(const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_isodep_t *out_isodep);
+
+/**
+ * @brief Sends PPS with the bit rates of both directions and switches the PCD to them.
+ *
+ * Must be the first exchange after @c rc522_isodep_activate().
+ * Bit rates are not verified, a PICC which is too far from the antenna may accept them and still
+ * lose frames exchanged at them. Use @c rc522_isodep_negotiate_bitrate() to fall back automatically.
+ *
+ * @param dsi Bit rate from the PICC to the PCD
+ * @param dri Bit rate from the PCD to the PICC
+ *
+ * @return RC522_ERR_ISODEP_BITRATE_UNSUPPORTED if the PICC does not support the bit rates (TA(1) of its ATS)
+ */
+esp_err_t rc522_isodep_pps(
+    const rc522_handle_t rc522, rc522_isodep_t *isodep, rc522_isodep_bitrate_t dsi, rc522_isodep_bitrate_t dri);
+
+/**
+ * @brief Raises the bit rates to the highest ones supported by both the PICC and the PCD.
+ *
+ * Sends PPS with the highest bit rates of TA(1), not above @p max_bitrate, and checks them with R(NAK),
+ * which the PICC answers by R(ACK). If frames do not get through, the RF field is reset,
+ * the PICC is activated again (WUPA, SELECT and RATS) and the next lower bit rates are tried,
+ * down to 106 kbit/s. Reset of the field moves other PICCs in it back into IDLE state.
+ *
+ * Must be the first exchange after @c rc522_isodep_activate(). PICC which supports 106 kbit/s only is left as is.
+ *
+ * @param rc522 RC522 handle
+ * @param picc PICC of the session
+ * @param isodep Session with the PICC, its bit rates are set to the negotiated ones
+ * @param max_bitrate Highest bit rate to use, e.g. @c RC522_ISODEP_BITRATE_848
+ *
+ * @return Error if the PICC cannot be activated again after a failed attempt
+ */
+esp_err_t rc522_isodep_negotiate_bitrate(const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_isodep_t *isodep,
+    rc522_isodep_bitrate_t max_bitrate);
+
+/**
+ * @brief Sends command APDU and receives response APDU.
+ *
+ * APDUs which do not fit into one frame are chained in both directions. Waiting time extensions
+ * requested by the PICC are granted, lost or corrupted blocks are recovered with R-blocks.
+ *
+ * @param rc522 RC522 handle
+ * @param isodep Session with the PICC
+ * @param[in] apdu Command APDU
+ * @param apdu_length Length of the command APDU
+ * @param[out] out_buffer Buffer for the response APDU, including SW1 and SW2
+ * @param buffer_size Size of the buffer
+ * @param[out] out_length Length of the response APDU
+ *
+ * @return RC522_ERR_ISODEP_RESPONSE_TOO_LONG if the response does not fit into the buffer.
+ *         The rest of the response is still received, so the session stays usable.
+ */
+esp_err_t rc522_isodep_transceive_apdu(const rc522_handle_t rc522, rc522_isodep_t *isodep, const uint8_t *apdu,
+    size_t apdu_length, uint8_t *out_buffer, size_t buffer_size, size_t *out_length);
+
+/**
+ * @brief Sends S(DESELECT), which moves the PICC into HALT state and ends the session.
+ * PCD is switched back to 106 kbit/s.
+ */
+esp_err_t rc522_isodep_deselect(const rc522_handle_t rc522, rc522_isodep_t *isodep);
+
+#ifdef __cplusplus
+}
+#endif
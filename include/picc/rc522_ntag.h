@@ -10,6 +10,17 @@ extern "C" {
 #define NTAG_PAGE_SIZE  (4)
 #define NTAG_TVL_FIND_SIZE   (4)
 #define NTAG_PAGE_READ_SIZE (16)
+#define NTAG_FAST_READ_PAGES_MAX (63) // Pages of one FAST_READ frame, 252 bytes and CRC_A streamed through the FIFO
+#define NTAG_CACHE_PAGES_MAX (224) // Pages 0 to 221 of NTAG216 (Capability Container 0x6D), rounded up to 32
+
+/**
+ * Counters of rc522_ntag_readn() calls, see CONFIG_RC522_NTAG_CACHE
+ */
+typedef struct
+{
+    uint32_t hits;   /*<! Calls served from the cache */
+    uint32_t misses; /*<! Calls which have sent at least one frame to the PICC */
+} rc522_ntag_cache_stats_t;
 
 typedef struct ntag_tvl_info{
     uint8_t type;
@@ -46,14 +57,57 @@ typedef struct ndef_record {
 
 
 esp_err_t rc522_ntag_read(const rc522_handle_t rc522, const rc522_picc_t *picc, uint8_t block_address,uint8_t out_buffer[NTAG_PAGE_SIZE]);
+
+/**
+ * @brief Reads @p len bytes from the byte @p address.
+ *
+ * Uses FAST_READ if the PICC answers GET_VERSION (asked once per PICC), otherwise READ.
+ * A PICC which does not answer falls back to IDLE, so it is selected again.
+ */
 esp_err_t rc522_ntag_readn(const rc522_handle_t rc522, const rc522_picc_t *picc, uint16_t address,uint8_t* out_buffer,int len);
 
+/**
+ * @brief Reads the pages from @p start_page to @p end_page (both included) with FAST_READ (NTAG21x, Ultralight EV1).
+ *
+ * Not supported by the original MIFARE Ultralight, Ultralight C and NTAG203, use @c rc522_ntag_readn() for them.
+ *
+ * Ranges longer than @c NTAG_FAST_READ_PAGES_MAX pages are read in several frames.
+ *
+ * @param[out] out_buffer Buffer of (end_page - start_page + 1) * NTAG_PAGE_SIZE bytes
+ */
+esp_err_t rc522_ntag_fast_read(const rc522_handle_t rc522, const rc522_picc_t *picc, uint8_t start_page,
+    uint8_t end_page, uint8_t *out_buffer);
+
+/**
+ * @brief Writes one page with WRITE (NTAG21x, Ultralight).
+ *
+ * The page is dropped from the cache. Write of the Capability Container (page 3) drops the whole cache.
+ */
+esp_err_t rc522_ntag_write(const rc522_handle_t rc522, const rc522_picc_t *picc, uint8_t page_address,
+    const uint8_t buffer[NTAG_PAGE_SIZE]);
+
+#if CONFIG_RC522_NTAG_CACHE
+/**
+ * @brief Drops all cached pages, e.g. after the memory of the PICC has been changed by another reader.
+ *
+ * Pages are dropped automatically when they are written by @c rc522_ntag_write() and when the PICC leaves the field.
+ */
+esp_err_t rc522_ntag_cache_invalidate(const rc522_handle_t rc522);
+
+esp_err_t rc522_ntag_get_cache_stats(const rc522_handle_t rc522, rc522_ntag_cache_stats_t *out_stats);
+#endif
+
+esp_err_t ntag_get_tlv_info(const rc522_handle_t rc522, const rc522_picc_t *picc, ntag_tvl_info_t* tvl_info);
 NDEFHeader parse_header(uint8_t byte);
+void print_ndef_records(ndef_record *head);
+
+// Records are allocated on the heap, so these are not available with CONFIG_RC522_STATIC_ALLOCATION
+#if !CONFIG_RC522_STATIC_ALLOCATION
 ndef_record *create_ndef_record(NDEFHeader header, uint32_t payload_length, uint8_t type_length, uint8_t id_length, uint8_t lang_code_length, uint8_t *lang_code, uint8_t *type, uint8_t *id, uint8_t *payload);
 ndef_record *parse_ndef_records(uint8_t *data, size_t length);
-void print_ndef_records(ndef_record *head);
 void free_ndef_records(ndef_record *head);
 esp_err_t ntag_read_ndef(const rc522_handle_t rc522, const rc522_picc_t *picc, uint8_t **dataptr, ndef_record **records);
+#endif
 
 #ifdef __cplusplus
 }
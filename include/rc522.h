@@ -1,6 +1,8 @@
 #pragma once
 
 #include "rc522_types.h"
+#include "rc522_stats.h"
+#include "picc/rc522_ntag.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -8,8 +10,59 @@ extern "C" {
 
 ESP_EVENT_DECLARE_BASE(RC522_EVENTS);
 
+#if CONFIG_RC522_STATS
+#define RC522_STATIC_STATS_SIZE (sizeof(rc522_stats_t) + 8 * sizeof(void *))
+#else
+#define RC522_STATIC_STATS_SIZE (0)
+#endif
+
+#if CONFIG_RC522_STATIC_ALLOCATION
+#define RC522_STATIC_EVENTS_SIZE (CONFIG_RC522_EVENT_HANDLERS_MAX * 3 * sizeof(void *))
+#else
+#define RC522_STATIC_EVENTS_SIZE (0)
+#endif
+
+#if CONFIG_RC522_NTAG_CACHE
+#define RC522_STATIC_NTAG_CACHE_SIZE (NTAG_CACHE_PAGES_MAX * (NTAG_PAGE_SIZE + 1) + 8 * sizeof(void *))
+#else
+#define RC522_STATIC_NTAG_CACHE_SIZE (0)
+#endif
+
+/**
+ * Upper bound of the scanner handle size, checked when the component is built
+ */
+#define RC522_STATIC_HANDLE_SIZE                                                                                       \
+    (sizeof(rc522_config_t) + (RC522_INVENTORY_SIZE_MAX + 1) * sizeof(rc522_picc_t) + sizeof(rc522_detect_result_t)    \
+        + sizeof(StaticQueue_t) + sizeof(StaticEventGroup_t) + RC522_STATIC_STATS_SIZE + RC522_STATIC_EVENTS_SIZE      \
+        + RC522_STATIC_NTAG_CACHE_SIZE + 64 * sizeof(void *))
+
+/**
+ * Storage of the scanner created by rc522_create_static(), must stay valid until rc522_destroy()
+ */
+typedef struct
+{
+    uint64_t handle[(RC522_STATIC_HANDLE_SIZE + 7) / 8];
+    StaticTask_t task; /*<! Polling task, not used if rc522_config_t::group is set */
+
+    /**
+     * Stack of the polling task, rc522_config_t::task_stack_size bytes.
+     * Not used if rc522_config_t::group is set
+     */
+    StackType_t *task_stack;
+} rc522_static_t;
+
 esp_err_t rc522_create(const rc522_config_t *config, rc522_handle_t *out_rc522);
 
+/**
+ * Same as rc522_create(), but the scanner is created in the caller's storage, without heap.
+ * rc522_config_t::task_stack_size must be set, unless the scanner is a member of a group.
+ *
+ * With CONFIG_RC522_STATIC_ALLOCATION, the scanner does not use heap after this call.
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if rc522_config_t::dispatcher is enabled, the dispatcher needs heap
+ */
+esp_err_t rc522_create_static(const rc522_config_t *config, rc522_static_t *buffers, rc522_handle_t *out_rc522);
+
 esp_err_t rc522_register_events(
     const rc522_handle_t rc522, rc522_event_t event, esp_event_handler_t event_handler, void *event_handler_arg);
 
@@ -21,6 +74,37 @@ esp_err_t rc522_pause(rc522_handle_t rc522);
 
 esp_err_t rc522_destroy(rc522_handle_t rc522);
 
+/**
+ * Enumerates all PICCs in the field: wakes them up with WUPA, then repeats
+ * anticollision, SELECT and HLTA until no PICC answers REQA anymore.
+ * PICCs are left in HALT state. Fires RC522_EVENT_PICC_ARRIVED and RC522_EVENT_PICC_LEFT
+ * events, compared to the result of the previous inventory.
+ *
+ * Must be called from the event handler or while the scanner is paused,
+ * unless the scanner runs inventory by itself (see rc522_config_t::inventory).
+ *
+ * @param[out] out_piccs Optional, PICCs found in the field
+ * @param capacity Size of the out_piccs table. At most RC522_INVENTORY_SIZE_MAX PICCs are found
+ * @param[out] out_count Optional, number of PICCs found
+ */
+esp_err_t rc522_inventory(rc522_handle_t rc522, rc522_picc_t *out_piccs, uint8_t capacity, uint8_t *out_count);
+
+/**
+ * Copies latency histograms and bus transaction counts of the protocol stages
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if CONFIG_RC522_STATS is disabled
+ */
+esp_err_t rc522_get_stats(const rc522_handle_t rc522, rc522_stats_t *out_stats);
+
+esp_err_t rc522_reset_stats(const rc522_handle_t rc522);
+
+/**
+ * Copies counters of the event dispatcher (see rc522_config_t::dispatcher)
+ *
+ * @return ESP_ERR_INVALID_STATE if the dispatcher is not enabled
+ */
+esp_err_t rc522_get_dispatcher_stats(const rc522_handle_t rc522, rc522_dispatcher_stats_t *out_stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "rc522_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_ARBITER_SIZE_MAX (16)
+
+/**
+ * Arbiter serializes PICC transactions of scanners which share a bus (e.g. SPI host).
+ * A scanner holds the bus for a single frame exchange with the PICC, so a long
+ * operation (e.g. MIFARE dump) of one scanner is interleaved with transactions of others.
+ * Waiting scanners get the bus in the order they have asked for it.
+ * Scanners use the arbiter set in rc522_config_t::arbiter and leave it by rc522_destroy().
+ *
+ * Time spent waiting for the bus is reported in RC522_STATS_STAGE_BUS_WAIT (needs CONFIG_RC522_STATS).
+ */
+esp_err_t rc522_arbiter_create(rc522_arbiter_handle_t *out_arbiter);
+
+/**
+ * All scanners using the arbiter must be destroyed before
+ */
+esp_err_t rc522_arbiter_destroy(rc522_arbiter_handle_t arbiter);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "rc522_types.h"
+#include "rc522_picc.h"
+#include "picc/rc522_mifare.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    RC522_DETECT_STEP_MIFARE_AUTH = 0, /*<! Authenticates the sector of the block with the key */
+    RC522_DETECT_STEP_MIFARE_READ,     /*<! Reads MIFARE Classic blocks of the authenticated sector */
+    RC522_DETECT_STEP_NTAG_READ,       /*<! Reads NTAG (or MIFARE Ultralight) pages */
+} rc522_detect_step_type_t;
+
+typedef struct
+{
+    rc522_detect_step_type_t type;
+    uint8_t address;               /*<! Block (MIFARE) or first page (NTAG) */
+    uint8_t count;                 /*<! Number of blocks or pages to read, ignored by auth */
+    const rc522_mifare_key_t *key; /*<! Auth only */
+} rc522_detect_step_t;
+
+/**
+ * Steps run by the polling task right after the PICC of rc522_detect_plan_t::picc_type is selected,
+ * before RC522_EVENT_PICC_STATE_CHANGED is dispatched. Data read by the steps is delivered
+ * in rc522_picc_state_changed_event_t::detect_result of that event, so the first
+ * read does not wait for the event to reach the handler.
+ *
+ * Steps run in order and stop at the first failed one. Read data of all steps of a plan
+ * must fit into RC522_DETECT_DATA_SIZE_MAX bytes. If the plan has authenticated,
+ * crypto1 is stopped and the PICC is selected again, so the handler gets it as usual.
+ *
+ * Plans are set in rc522_config_t::detect_plans, the first plan of the PICC type is used.
+ * Plans are not run in the inventory mode.
+ *
+ * Time of the plan is reported in RC522_STATS_STAGE_DETECT_PLAN (needs CONFIG_RC522_STATS).
+ */
+struct rc522_detect_plan
+{
+    rc522_picc_type_t picc_type;
+    const rc522_detect_step_t *steps;
+    uint8_t step_count;
+};
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,11 +1,24 @@
 #pragma once
 
+#include <freertos/FreeRTOS.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 typedef struct rc522_driver_handle *rc522_driver_handle_t;
 
+// Pointer-sized words of the driver handle, with the semaphore of the IRQ
+#define RC522_DRIVER_STATIC_SIZE (16 + (sizeof(StaticSemaphore_t) + sizeof(void *) - 1) / sizeof(void *))
+
+/**
+ * Storage of the driver handle, part of the storage given to the `_static` create function of the driver
+ */
+typedef struct
+{
+    void *handle[RC522_DRIVER_STATIC_SIZE];
+} rc522_driver_static_t;
+
 esp_err_t rc522_driver_install(const rc522_driver_handle_t driver);
 
 esp_err_t rc522_driver_uninstall(const rc522_driver_handle_t driver);
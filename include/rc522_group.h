@@ -0,0 +1,32 @@
+#pragma once
+
+#include "rc522_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_GROUP_SIZE_MAX (16)
+
+/**
+ * Group polls many scanners from a single task, so they do not need
+ * a task (and its stack) each and do not contend for the bus.
+ * Scanners join the group by rc522_config_t::group and leave it by rc522_destroy().
+ * Event handlers of all scanners in the group run in the group task.
+ */
+typedef struct
+{
+    size_t task_stack_size; /*<! Stack size of the group task */
+    uint8_t task_priority;  /*<! Priority of the group task */
+} rc522_group_config_t;
+
+esp_err_t rc522_group_create(const rc522_group_config_t *config, rc522_group_handle_t *out_group);
+
+/**
+ * All scanners of the group must be destroyed before
+ */
+esp_err_t rc522_group_destroy(rc522_group_handle_t group);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "rc522_types.h"
+#include "rc522_picc.h"
+#include "picc/rc522_mifare.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_OP_QUEUE_SIZE (8) // Operations submitted and not yet completed, per scanner
+
+typedef enum
+{
+    RC522_OP_MIFARE_READ = 0, /*<! Reads MIFARE Classic blocks, authenticating their sectors with the key */
+    RC522_OP_MIFARE_WRITE,    /*<! Writes MIFARE Classic blocks, authenticating their sectors with the key */
+    RC522_OP_NTAG_READ,       /*<! Reads NTAG (or MIFARE Ultralight) pages */
+} rc522_op_type_t;
+
+typedef struct rc522_op rc522_op_t;
+
+/**
+ * Called from the scanner task, so it must not block. The op is already completed and back with the caller,
+ * so the callback may release it. If the op is also waited for by rc522_op_wait(), the callback must not
+ * access it, since the waiting task may have released it in the meantime.
+ */
+typedef void (*rc522_op_callback_t)(rc522_op_t *op, void *arg);
+
+/**
+ * PICC operation which runs in the scanner task, while the scanner keeps polling.
+ * The descriptor (and the buffer) is owned by the scanner from rc522_op_submit()
+ * until the op is completed, i.e. until its callback is called or rc522_op_wait() returns.
+ */
+struct rc522_op
+{
+    rc522_op_type_t type;
+    uint8_t address; /*<! First block (MIFARE) or page (NTAG) */
+    uint8_t count;   /*<! Number of blocks or pages */
+
+    /**
+     * count * RC522_MIFARE_BLOCK_SIZE bytes for MIFARE, count * NTAG_PAGE_SIZE bytes for NTAG.
+     * Filled by reads, its content is written by writes
+     */
+    uint8_t *buffer;
+    rc522_mifare_key_t key;       /*<! MIFARE only */
+    rc522_picc_uid_t uid;         /*<! Optional, if the length is set the op runs only on the PICC with this UID */
+    rc522_op_callback_t callback; /*<! Optional, called when the op is completed */
+    void *callback_arg;
+    esp_err_t result; /*<! ESP_OK, error of the op, or RC522_ERR_OP_CANCELLED. Valid once completed */
+
+    // Private
+    StaticSemaphore_t done_buffer;
+    SemaphoreHandle_t done;
+};
+
+/**
+ * Queues the op. Queued ops run back-to-back, in the order of submission, once the active PICC
+ * has passed its presence check. They are cancelled if no PICC is active (e.g. it has left the field),
+ * or if the active PICC does not have rc522_op_t::uid.
+ * With presence check modes other than RC522_PRESENCE_CHECK_SELECT, the PICC is selected again before the ops run.
+ *
+ * @return ESP_ERR_NO_MEM if RC522_OP_QUEUE_SIZE ops are already queued
+ */
+esp_err_t rc522_op_submit(rc522_handle_t rc522, rc522_op_t *op);
+
+/**
+ * Waits until the op is completed. Must not be called from the scanner task (e.g. from the event handler).
+ *
+ * @return rc522_op_t::result, or ESP_ERR_TIMEOUT if the op has not been completed in time
+ */
+esp_err_t rc522_op_wait(rc522_op_t *op, uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
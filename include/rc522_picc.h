@@ -9,6 +9,7 @@ extern "C" {
 #define RC522_PICC_UID_SIZE_MAX            (10)
 #define RC522_PICC_UID_SIZE_MIN            (4)
 #define RC522_PICC_UID_STR_BUFFER_SIZE_MAX (RC522_PICC_UID_SIZE_MAX * 3)
+#define RC522_DETECT_DATA_SIZE_MAX         (64) // Bytes read by a single detect plan
 
 typedef struct
 {
@@ -128,12 +129,29 @@ typedef struct
     rc522_picc_state_t state;
 } rc522_picc_t;
 
+/**
+ * Result of the detect plan (see rc522_detect.h)
+ */
+typedef struct
+{
+    esp_err_t ret;      /*<! ESP_OK if all steps have succeeded, otherwise error of the failed step */
+    uint8_t steps_done; /*<! Steps which have succeeded */
+    uint8_t length;     /*<! Bytes read by the steps which have succeeded */
+    uint8_t data[RC522_DETECT_DATA_SIZE_MAX]; /*<! Data of the read steps, in the order of the steps */
+} rc522_detect_result_t;
+
 typedef struct
 {
     rc522_picc_state_t old_state;
     rc522_picc_t *picc;
+    const rc522_detect_result_t *detect_result; /*<! Set only when the PICC becomes active and a plan has run */
 } rc522_picc_state_changed_event_t;
 
+typedef struct
+{
+    rc522_picc_t *picc;
+} rc522_picc_inventory_event_t;
+
 char *rc522_picc_type_name(rc522_picc_type_t type);
 
 /**
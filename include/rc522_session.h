@@ -0,0 +1,65 @@
+#pragma once
+
+#include "rc522_types.h"
+#include "rc522_picc.h"
+#include "picc/rc522_mifare.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_SESSION_SIZE_MAX (RC522_INVENTORY_SIZE_MAX)
+
+typedef struct
+{
+    rc522_picc_t picc;           /*<! Pass it to PICC functions while the entry is active */
+    int8_t auth_sector;          /*<! MIFARE Classic sector authenticated since activation, -1 if none */
+    rc522_mifare_key_t auth_key; /*<! Key of the authentication, valid only if auth_sector is not -1 */
+} rc522_session_entry_t;
+
+/**
+ * Table of PICCs which stay in the field together. At most one of them is active,
+ * others are halted. Switching to another PICC costs HLTA, WUPA and one SELECT
+ * per cascade level, the anticollision is never repeated.
+ *
+ * Use rc522_session_halt() instead of rc522_mifare_deauth(), so the table keeps track of authentication.
+ */
+typedef struct
+{
+    rc522_session_entry_t entries[RC522_SESSION_SIZE_MAX];
+    uint8_t count;
+    int8_t active; /*<! Index of the active entry, -1 if all PICCs are halted */
+} rc522_session_t;
+
+/**
+ * Fills the session with PICCs, e.g. the ones found by rc522_inventory().
+ * PICCs must be halted, except one which may be active.
+ */
+esp_err_t rc522_session_init(rc522_session_t *session, const rc522_picc_t *piccs, uint8_t count);
+
+/**
+ * Halts the active PICC (if it is not the requested one), then wakes up
+ * the requested PICC and SELECTs it by its known UID.
+ *
+ * Must be called from the event handler or while the scanner is paused.
+ *
+ * @param[out] out_picc Optional, active PICC
+ */
+esp_err_t rc522_session_activate(
+    const rc522_handle_t rc522, rc522_session_t *session, uint8_t index, rc522_picc_t **out_picc);
+
+/**
+ * Halts the active PICC, if there is one
+ */
+esp_err_t rc522_session_halt(const rc522_handle_t rc522, rc522_session_t *session);
+
+/**
+ * Authenticates the sector of the block on the active PICC,
+ * unless it is already authenticated with the same key (type and value)
+ */
+esp_err_t rc522_session_mifare_auth(
+    const rc522_handle_t rc522, rc522_session_t *session, uint8_t block_address, const rc522_mifare_key_t *key);
+
+#ifdef __cplusplus
+}
+#endif
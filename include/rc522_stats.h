@@ -0,0 +1,65 @@
+#pragma once
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_STATS_BUCKET_COUNT   (16)
+#define RC522_STATS_BUCKET_0_LIMIT (32) // Upper bound (in microseconds) of the first bucket, doubled by each next one
+
+typedef enum
+{
+    RC522_STATS_STAGE_REQA = 0,      /*<! REQA or WUPA */
+    RC522_STATS_STAGE_ANTICOLLISION, /*<! Single ANTICOLLISION frame */
+    RC522_STATS_STAGE_SELECT,        /*<! Single SELECT frame */
+    RC522_STATS_STAGE_ACTIVATION,    /*<! From the REQA answered by the PICC until its UID is known (tap-to-UID) */
+    RC522_STATS_STAGE_CRC,           /*<! CRC_A calculation */
+    RC522_STATS_STAGE_MIFARE_AUTH,   /*<! MIFARE Classic authentication */
+    RC522_STATS_STAGE_READ,          /*<! MIFARE block or NTAG page read */
+    RC522_STATS_STAGE_WRITE,         /*<! MIFARE block write */
+    RC522_STATS_STAGE_HEARTBEAT,     /*<! Check that the active PICC is still in the field */
+    RC522_STATS_STAGE_DISPATCH,      /*<! Event dispatch, including the handlers unless the dispatcher queues it */
+    RC522_STATS_STAGE_BUS_WAIT,      /*<! Wait for the bus shared with other scanners (see rc522_arbiter.h) */
+    RC522_STATS_STAGE_DETECT_PLAN,   /*<! Detect plan run right after SELECT (see rc522_detect.h) */
+    RC522_STATS_STAGE_ISODEP,        /*<! ISO-DEP exchange: RATS, PPS, APDU with all its blocks, or DESELECT */
+    RC522_STATS_STAGE_COUNT,
+} rc522_stats_stage_t;
+
+/**
+ * Stages may be nested (e.g. CRC inside of SELECT), the time and
+ * bus transactions of the inner stage are included in the outer one.
+ */
+typedef struct
+{
+    uint32_t count;    /*<! Number of successful runs */
+    uint32_t errors;   /*<! Number of failed runs, not included in the latency */
+    uint32_t bus_ops;  /*<! Bus transactions (writes, reads and batches) of all runs */
+    uint32_t min_us;   /*<! Shortest successful run */
+    uint32_t max_us;   /*<! Longest successful run */
+    uint64_t total_us; /*<! Sum of all successful runs, to calculate the mean */
+
+    /**
+     * Bucket N counts runs shorter than RC522_STATS_BUCKET_0_LIMIT << N microseconds
+     * (and not shorter than the limit of the bucket N-1). The last bucket counts everything longer.
+     */
+    uint32_t histogram[RC522_STATS_BUCKET_COUNT];
+} rc522_stage_stats_t;
+
+typedef struct
+{
+    rc522_stage_stats_t stages[RC522_STATS_STAGE_COUNT];
+    uint32_t scan_interval_ms; /*<! Current delay between scans of the empty field */
+} rc522_stats_t;
+
+typedef struct
+{
+    const rc522_stats_t *stats; /*<! Live statistics, valid only in the handler. Use rc522_get_stats() to copy */
+} rc522_stats_event_t;
+
+char *rc522_stats_stage_name(rc522_stats_stage_t stage);
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,9 +28,61 @@ extern "C" {
 #define RC522_ERR_RST_PIN_UNUSED                (RC522_ERR_BASE + 12)
 #define RC522_ERR_PCD_FIFO_EMPTY                (RC522_ERR_BASE + 13)
 #define RC522_ERR_HLTA_NOT_ACKED                (RC522_ERR_BASE + 14)
+#define RC522_ERR_REPLAY_MISMATCH               (RC522_ERR_BASE + 15)
+#define RC522_ERR_OP_CANCELLED                  (RC522_ERR_BASE + 16)
+
+#define RC522_INVENTORY_SIZE_MAX   (8) // Max number of PICCs found by single inventory
+#define RC522_DISPATCHER_RING_SIZE (8) // Events queued by the dispatcher, must be a power of two
 
 typedef struct rc522 *rc522_handle_t;
 
+typedef struct rc522_group *rc522_group_handle_t;
+
+typedef struct rc522_arbiter *rc522_arbiter_handle_t;
+
+typedef struct rc522_detect_plan rc522_detect_plan_t;
+
+/**
+ * How the scanner checks that the active PICC is still in the field
+ */
+typedef enum
+{
+    RC522_PRESENCE_CHECK_SELECT = 0, /*<! REQA/WUPA and SELECT of the known UID, PICC stays selected */
+    RC522_PRESENCE_CHECK_WUPA,       /*<! HLTA and WUPA, PICC answers with ATQA but does not stay selected */
+    RC522_PRESENCE_CHECK_READ,       /*<! READ of page 0 of MIFARE Ultralight and NTAG, WUPA for other PICCs */
+} rc522_presence_check_mode_t;
+
+typedef struct
+{
+    rc522_presence_check_mode_t mode;
+    uint16_t interval_ms;      /*<! Delay between checks, 0 for the default of the mode */
+    uint8_t failure_threshold; /*<! Failed checks in a row after which the PICC is removed, 0 for the default */
+} rc522_presence_check_config_t;
+
+/**
+ * Dispatcher runs event handlers in its own task, so slow handlers do not delay polling.
+ * Events are queued by value: the PICC (or statistics) in the event is a snapshot
+ * taken when the event was fired, valid until the handler returns.
+ *
+ * Handlers run while the scanner keeps polling, so they must not call PICC functions.
+ */
+typedef struct
+{
+    bool enabled;
+    size_t task_stack_size;  /*<! Stack size of the dispatcher task, 0 for the default */
+    uint8_t task_priority;   /*<! Priority of the dispatcher task, 0 for the default */
+    bool task_pinned;        /*<! Pin the dispatcher task to task_core_id */
+    BaseType_t task_core_id; /*<! Valid only if task_pinned is set */
+} rc522_dispatcher_config_t;
+
+typedef struct
+{
+    uint32_t dispatched; /*<! Events passed to the handlers */
+    uint32_t dropped;    /*<! Events lost because the ring was full */
+    uint32_t overflows;  /*<! Times the ring became full, each followed by one or more dropped events */
+    uint32_t high_water; /*<! Most events queued at once */
+} rc522_dispatcher_stats_t;
+
 typedef struct
 {
     rc522_driver_handle_t driver;
@@ -38,6 +90,18 @@ typedef struct
     size_t task_stack_size;       /*<! Stack size of rc522 task */
     uint8_t task_priority;        /*<! Priority of rc522 task */
     SemaphoreHandle_t task_mutex; /*<! Mutex for rc522 task */
+    uint32_t stats_interval_ms;   /*<! Period of RC522_EVENT_STATS (needs CONFIG_RC522_STATS), 0 to disable */
+    bool inventory;               /*<! Enumerate all PICCs on every poll (see rc522_inventory), instead of one */
+    rc522_presence_check_config_t presence_check;
+    uint16_t scan_interval_floor_ms;   /*<! Delay between scans of the empty field after a PICC arrives or leaves */
+    uint16_t scan_interval_ceiling_ms; /*<! Longest delay between scans, reached by doubling the delay */
+    uint32_t scan_backoff_after_ms;    /*<! How long the field stays empty before the delay starts doubling */
+    rc522_group_handle_t group;        /*<! Poll from the task of the group (see rc522_group.h), not own task */
+    uint8_t group_weight;              /*<! Scanner with weight N is polled N times as often, 0 for 1 */
+    rc522_arbiter_handle_t arbiter;    /*<! Shared with scanners on the same bus (see rc522_arbiter.h), NULL if none */
+    rc522_dispatcher_config_t dispatcher;
+    const rc522_detect_plan_t *detect_plans; /*<! Optional, see rc522_detect.h. Must stay valid until rc522_destroy() */
+    uint8_t detect_plan_count;
 } rc522_config_t;
 
 typedef enum
@@ -45,6 +109,9 @@ typedef enum
     RC522_EVENT_ANY = ESP_EVENT_ANY_ID,
     RC522_EVENT_NONE,
     RC522_EVENT_PICC_STATE_CHANGED,
+    RC522_EVENT_STATS,        /*<! Periodic, see rc522_config_t::stats_interval_ms */
+    RC522_EVENT_PICC_ARRIVED, /*<! PICC found by the inventory, which was not found by the previous one */
+    RC522_EVENT_PICC_LEFT,    /*<! PICC found by the previous inventory is not in the field anymore */
 } rc522_event_t;
 
 #ifdef __cplusplus
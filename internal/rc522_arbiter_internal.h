@@ -0,0 +1,26 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+#include "rc522_arbiter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t rc522_arbiter_attach(rc522_arbiter_handle_t arbiter, rc522_handle_t rc522);
+
+esp_err_t rc522_arbiter_detach(rc522_arbiter_handle_t arbiter, rc522_handle_t rc522);
+
+/**
+ * Blocks until the bus is granted to the scanner. No-op if the scanner has no arbiter.
+ */
+esp_err_t rc522_arbiter_acquire(const rc522_handle_t rc522);
+
+/**
+ * Hands the bus over to the scanner which has waited the longest
+ */
+void rc522_arbiter_release(const rc522_handle_t rc522);
+
+#ifdef __cplusplus
+}
+#endif
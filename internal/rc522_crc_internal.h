@@ -0,0 +1,26 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+#include "rc522_pcd_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_CRC_A_PRESET (0x6363) // ISO/IEC 14443-3, section 6.2.4
+
+/**
+ * Calculates CRC_A in software, the same way as the CalcCRC command
+ * of the PCD does (with the CRC preset set to 0x6363)
+ */
+esp_err_t rc522_crc_a(const rc522_bytes_t *bytes, rc522_pcd_crc_t *result);
+
+/**
+ * Calculates CRC_A using the engine selected in the configuration
+ * (software by default, or the CRC coprocessor of the PCD)
+ */
+esp_err_t rc522_crc_calculate(const rc522_handle_t rc522, const rc522_bytes_t *bytes, rc522_pcd_crc_t *result);
+
+#ifdef __cplusplus
+}
+#endif
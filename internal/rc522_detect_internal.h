@@ -0,0 +1,24 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+#include "rc522_detect.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @return ESP_ERR_INVALID_ARG if a plan has invalid steps, or its data does not fit into the result
+ */
+esp_err_t rc522_detect_validate_plans(const rc522_detect_plan_t *plans, uint8_t plan_count);
+
+/**
+ * Runs the plan of the PICC type, if there is one
+ *
+ * @return false if there is no plan for the PICC
+ */
+bool rc522_detect_run(const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_detect_result_t *out_result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Creates the ring and starts the dispatcher task. Handlers registered
+ * by rc522_register_events() are run from that task from now on.
+ */
+esp_err_t rc522_dispatcher_create(rc522_handle_t rc522, rc522_dispatcher_handle_t *out_dispatcher);
+
+/**
+ * Runs handlers of the events left in the ring, then stops the task.
+ * The polling must be stopped before, since it is the only producer.
+ */
+esp_err_t rc522_dispatcher_destroy(rc522_dispatcher_handle_t dispatcher);
+
+/**
+ * Queues a snapshot of the event. Called only from the polling task (single producer).
+ *
+ * @return ESP_ERR_NO_MEM if the ring is full and the event has been dropped
+ */
+esp_err_t rc522_dispatcher_push(
+    rc522_dispatcher_handle_t dispatcher, rc522_event_t event, const void *data, size_t data_size);
+
+void rc522_dispatcher_get_stats(rc522_dispatcher_handle_t dispatcher, rc522_dispatcher_stats_t *out_stats);
+
+bool rc522_dispatcher_is_current_task(rc522_dispatcher_handle_t dispatcher);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,10 +1,31 @@
+#pragma once
+
 #include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
 #include "rc522_types_internal.h"
 #include "rc522_driver.h"
 
 #define RC522_DRIVER_HARD_RST_PIN_PWR_DOWN_LEVEL (0)
 #define RC522_DRIVER_HARD_RST_PULSE_DURATION_MS  (15)
 
+typedef enum
+{
+    RC522_DRIVER_OP_WRITE = 0,
+    RC522_DRIVER_OP_READ,
+} rc522_driver_op_type_t;
+
+/**
+ * Single register access inside of the batch
+ */
+typedef struct
+{
+    rc522_driver_op_type_t type;
+    uint8_t address;
+    rc522_bytes_t bytes; /*<! Data to write, or buffer to read into (length is number of bytes to read) */
+} rc522_driver_op_t;
+
 typedef esp_err_t (*rc522_driver_install_handler_t)(const rc522_driver_handle_t driver);
 
 typedef esp_err_t (*rc522_driver_send_handler_t)(
@@ -13,6 +34,9 @@ typedef esp_err_t (*rc522_driver_send_handler_t)(
 typedef esp_err_t (*rc522_driver_receive_handler_t)(
     const rc522_driver_handle_t driver, uint8_t address, rc522_bytes_t *bytes);
 
+typedef esp_err_t (*rc522_driver_batch_handler_t)(
+    const rc522_driver_handle_t driver, rc522_driver_op_t *ops, uint8_t count);
+
 typedef esp_err_t (*rc522_driver_reset_handler_t)(const rc522_driver_handle_t driver);
 
 typedef esp_err_t (*rc522_driver_uninstall_handler_t)(const rc522_driver_handle_t driver);
@@ -24,18 +48,69 @@ struct rc522_driver_handle
     rc522_driver_install_handler_t install;
     rc522_driver_send_handler_t send;
     rc522_driver_receive_handler_t receive;
+    rc522_driver_batch_handler_t batch; /*<! Optional. If not set, ops are executed one by one */
     rc522_driver_reset_handler_t reset;
     rc522_driver_uninstall_handler_t uninstall;
+    gpio_num_t irq_io_num;                 /*<! GPIO of the IRQ pin, or GPIO_NUM_NC if the IRQ is virtual */
+    bool irq_enabled;                      /*<! Completion is signalled by the IRQ instead of being polled */
+    volatile TaskHandle_t irq_task;        /*<! Task waiting for the IRQ, NULL if nobody is waiting */
+    StaticSemaphore_t irq_semaphore_buffer;
+    SemaphoreHandle_t irq_semaphore; /*<! Given by the IRQ, task notifications are left to the application */
+    struct rc522_driver_handle *irq_owner; /*<! Wrapped driver whose IRQ is used instead (see rc522_recorder) */
+    bool is_static;                        /*<! Storage is owned by the caller (see rc522_driver_create_static()) */
 };
 
 esp_err_t rc522_driver_init_rst_pin(gpio_num_t rst_io_num);
 
+/**
+ * Configures the pin as input connected to the RC522 IRQ output
+ * and installs ISR that wakes up the task waiting in rc522_driver_irq_wait().
+ */
+esp_err_t rc522_driver_init_irq_pin(const rc522_driver_handle_t driver, gpio_num_t irq_io_num);
+
+esp_err_t rc522_driver_deinit_irq_pin(const rc522_driver_handle_t driver);
+
+bool rc522_driver_irq_enabled(const rc522_driver_handle_t driver);
+
+/**
+ * Registers the calling task as the receiver of the next IRQ and drops
+ * any IRQ raised before. Must be called before the command that raises the IRQ is started.
+ */
+esp_err_t rc522_driver_irq_arm(const rc522_driver_handle_t driver);
+
+/**
+ * Blocks until the IRQ is raised or until the timeout expires (ESP_ERR_TIMEOUT).
+ */
+esp_err_t rc522_driver_irq_wait(const rc522_driver_handle_t driver, uint32_t timeout_ms);
+
+esp_err_t rc522_driver_irq_disarm(const rc522_driver_handle_t driver);
+
+/**
+ * Raises the IRQ from the task context, as if the IRQ pin has been asserted.
+ * Used by drivers without a physical pin (e.g. on Linux target).
+ */
+esp_err_t rc522_driver_raise_irq(const rc522_driver_handle_t driver);
+
 esp_err_t rc522_driver_create(const void *config, size_t config_size, rc522_driver_handle_t *driver);
 
+/**
+ * Same as rc522_driver_create(), but the handle and the copy of the config are placed into the caller's storage
+ *
+ * @param config_buffer Storage of config_size bytes
+ */
+esp_err_t rc522_driver_create_static(const void *config, size_t config_size, rc522_driver_static_t *handle_buffer,
+    void *config_buffer, rc522_driver_handle_t *driver);
+
 esp_err_t rc522_driver_send(const rc522_driver_handle_t driver, uint8_t address, const rc522_bytes_t *bytes);
 
 esp_err_t rc522_driver_receive(const rc522_driver_handle_t driver, uint8_t address, rc522_bytes_t *bytes);
 
+/**
+ * Executes list of register writes and reads, in order, as a single bus transaction
+ * if the driver supports it, or one by one otherwise.
+ */
+esp_err_t rc522_driver_batch(const rc522_driver_handle_t driver, rc522_driver_op_t *ops, uint8_t count);
+
 esp_err_t rc522_driver_reset(const rc522_driver_handle_t driver);
 
 esp_err_t rc522_driver_destroy(rc522_driver_handle_t driver);
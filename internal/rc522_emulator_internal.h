@@ -0,0 +1,174 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "rc522_types_internal.h"
+#include "driver/rc522_emulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_EMULATOR_FIFO_SIZE       (64)
+#define RC522_EMULATOR_FRAME_SIZE_MAX  (256) // Including CRC_A, largest FSD of ISO/IEC 14443-4
+#define RC522_EMULATOR_REGISTERS_COUNT (64)
+#define RC522_EMULATOR_APDU_SIZE_MAX   (261) // Short command APDU: header, Lc, 255 bytes of data and Le
+
+/**
+ * Bit-oriented frame, as transferred over the RF interface.
+ * Bits are sent LSBit first, starting with the bit 0 of the first byte.
+ */
+typedef struct
+{
+    uint8_t bytes[RC522_EMULATOR_FRAME_SIZE_MAX];
+    uint16_t bits; /*<! Number of valid bits */
+} rc522_emulator_frame_t;
+
+typedef enum
+{
+    RC522_EMULATOR_PICC_STATE_IDLE = 0,
+    RC522_EMULATOR_PICC_STATE_READY,
+    RC522_EMULATOR_PICC_STATE_ACTIVE,
+    RC522_EMULATOR_PICC_STATE_HALT,
+} rc522_emulator_picc_state_t;
+
+/**
+ * ISO/IEC 14443-4 protocol state of the PICC
+ */
+typedef struct
+{
+    bool active;                                       /*<! RATS received, blocks are expected until DESELECT */
+    bool pps_allowed;                                  /*<! Nothing has been received since the ATS */
+    bool wtx_pending;                                  /*<! Response is held back until S(WTX) is answered */
+    uint8_t dsi;                                       /*<! Bit rate to the PCD, set by PPS (0 is 106 kbit/s) */
+    uint8_t dri;                                       /*<! Bit rate from the PCD, set by PPS */
+    uint8_t cid;                                       /*<! CID assigned by RATS */
+    uint8_t block_number;                              /*<! Block number of the PICC */
+    uint16_t fsd;                                      /*<! Largest frame received by the PCD */
+    uint8_t last_block[RC522_EMULATOR_FRAME_SIZE_MAX]; /*<! Sent again when the PCD reports it lost */
+    uint8_t last_block_length;
+    uint8_t command[RC522_EMULATOR_APDU_SIZE_MAX];     /*<! Command APDU, assembled from chained I-blocks */
+    uint16_t command_length;
+    uint8_t response[RC522_EMULATOR_APDU_SIZE_MAX];    /*<! Response APDU, sent in chained I-blocks */
+    uint16_t response_length;
+    uint16_t response_offset;                          /*<! Part of the response already sent */
+} rc522_emulator_isodep_t;
+
+typedef struct
+{
+    bool used;     /*<! Slot is taken */
+    bool in_field; /*<! PICC receives frames */
+    rc522_emulator_picc_type_t type;
+    uint8_t uid[RC522_PICC_UID_SIZE_MAX];
+    uint8_t uid_length;
+    rc522_emulator_picc_state_t state;
+    bool halted;           /*<! PICC was woken up from HALT (READY* and ACTIVE* states) */
+    uint8_t cascade_level; /*<! Current cascade level (0-based) in READY state */
+    uint8_t *memory;
+    uint16_t memory_size;
+    int16_t auth_sector;   /*<! Sector of the Crypto1 session, or -1 if not authenticated */
+    int16_t pending_write; /*<! Block waiting for data of the two-step WRITE, or -1 */
+    uint8_t speed_limit;   /*<! Highest bit rate at which frames get through (0 is 106 kbit/s) */
+    uint8_t wtxm;          /*<! Waiting time extension asked for by UPDATE BINARY */
+    rc522_emulator_isodep_t isodep;
+    uint64_t response_delay_ns; /*<! Processing time before the response that has just been prepared */
+    uint64_t busy_until_ns;     /*<! Air time when the delayed response is sent, frames are ignored until then */
+    rc522_emulator_frame_t delayed_response;
+} rc522_emulator_picc_t;
+
+typedef enum
+{
+    RC522_EMULATOR_TRANSFER_IDLE = 0,
+    RC522_EMULATOR_TRANSFER_TX, /*<! Frame is taken from the FIFO */
+    RC522_EMULATOR_TRANSFER_RX, /*<! Response is put into the FIFO */
+} rc522_emulator_transfer_state_t;
+
+/**
+ * Frame of the Transceive command on its way between the FIFO and the RF interface.
+ * Emulator has no notion of time, the transfer advances after each access of the host.
+ * Frames longer than the FIFO are streamed: while the LoAlert (HiAlert) interrupt is enabled,
+ * the transmitter (receiver) stops at the water level until the host refills (drains) the FIFO.
+ */
+typedef struct
+{
+    rc522_emulator_transfer_state_t state;
+    uint8_t tx_last_bits;
+    uint8_t rx_align;
+    bool encrypted;
+    rc522_emulator_frame_t frame; /*<! Frame taken from the FIFO, then the one received */
+    rc522_emulator_frame_t responses[RC522_EMULATOR_PICC_COUNT_MAX];
+    uint8_t rx_bytes[RC522_EMULATOR_FRAME_SIZE_MAX + 1]; /*<! Received frame, starting at RxAlign position */
+    uint16_t rx_length;
+    uint16_t rx_offset;   /*<! Bytes already put into the FIFO */
+    uint8_t rx_last_bits; /*<! Valid bits of the last byte */
+    uint8_t rx_error;     /*<! ErrorReg bits, reported once the whole frame is in the FIFO */
+} rc522_emulator_transfer_t;
+
+typedef struct
+{
+    rc522_driver_handle_t driver;
+    SemaphoreHandle_t mutex;
+    bool irq;
+    uint8_t firmware;
+    uint8_t registers[RC522_EMULATOR_REGISTERS_COUNT];
+    uint8_t fifo[RC522_EMULATOR_FIFO_SIZE];
+    uint8_t fifo_level;
+    bool crc_ready;       /*<! CRC result is valid (Status1Reg CRCReady bit) */
+    bool irq_asserted;    /*<! Level of the (virtual) IRQ pin */
+    uint64_t air_time_ns; /*<! Time spent on the RF interface by all transceives */
+    rc522_emulator_transfer_t transfer;
+    rc522_emulator_picc_t piccs[RC522_EMULATOR_PICC_COUNT_MAX];
+} rc522_emulator_t;
+
+esp_err_t rc522_emulator_picc_init(rc522_emulator_picc_t *picc, const rc522_emulator_picc_config_t *config);
+
+void rc522_emulator_picc_deinit(rc522_emulator_picc_t *picc);
+
+/**
+ * Returns PICC to IDLE (or HALT) state, like when it leaves the field
+ * or when it receives a command that is not valid in its current state.
+ */
+void rc522_emulator_picc_reset(rc522_emulator_picc_t *picc);
+
+/**
+ * Delivers frame sent by the PCD to the PICC.
+ * Frame is lost if it is sent at other bit rate than the PICC expects,
+ * and so is the response if the PCD receives at other bit rate than the PICC sends.
+ *
+ * @param encrypted Frame is sent over the Crypto1 session (Status2Reg MFCrypto1On bit is set)
+ * @param tx_speed TxSpeed of the PCD (0 is 106 kBd)
+ * @param rx_speed RxSpeed of the PCD
+ * @param[out] out_response Response of the PICC
+ *
+ * @return true if the PICC responds
+ */
+bool rc522_emulator_picc_receive(rc522_emulator_picc_t *picc, const rc522_emulator_frame_t *frame, bool encrypted,
+    uint8_t tx_speed, uint8_t rx_speed, rc522_emulator_frame_t *out_response);
+
+/**
+ * Executes the MIFARE Classic three pass authentication (MFAuthent command).
+ *
+ * @param data Auth command, block address, 6 bytes of the key and 4 bytes of the UID
+ *
+ * @return true if the Crypto1 session has been established
+ */
+bool rc522_emulator_picc_authenticate(rc522_emulator_picc_t *picc, const uint8_t data[12]);
+
+static inline uint8_t rc522_emulator_frame_bit(const rc522_emulator_frame_t *frame, uint16_t index)
+{
+    return (frame->bytes[index / 8] >> (index % 8)) & 0x01;
+}
+
+static inline void rc522_emulator_frame_set_bit(rc522_emulator_frame_t *frame, uint16_t index, uint8_t value)
+{
+    if (value) {
+        frame->bytes[index / 8] |= (1 << (index % 8));
+    }
+    else {
+        frame->bytes[index / 8] &= ~(1 << (index % 8));
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+#include "rc522_group.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t rc522_group_attach(rc522_group_handle_t group, rc522_handle_t rc522);
+
+/**
+ * Once detached, the scanner is not polled by the group task anymore
+ */
+esp_err_t rc522_group_detach(rc522_group_handle_t group, rc522_handle_t rc522);
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,6 +9,11 @@ extern "C" {
 
 uint32_t rc522_millis();
 
+/**
+ * Microseconds since the epoch, truncated to 32 bits (wraps every ~71 minutes)
+ */
+uint32_t rc522_micros();
+
 void rc522_delay_ms(uint32_t ms);
 
 esp_err_t rc522_buffer_to_hex_str(
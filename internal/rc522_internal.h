@@ -8,8 +8,28 @@ extern "C" {
 
 void rc522_task(void *arg);
 
+/**
+ * Resets the state of the polling, before the first rc522_poll_step()
+ */
+void rc522_poll_init(const rc522_handle_t rc522);
+
+/**
+ * Single iteration of the polling, does nothing unless the scanner is started
+ *
+ * @return Delay (in milliseconds) until the next step
+ */
+uint32_t rc522_poll_step(const rc522_handle_t rc522);
+
+/**
+ * Runs the event handlers, from the polling task or from the dispatcher task if it is enabled
+ */
 esp_err_t rc522_dispatch_event(const rc522_handle_t rc522, rc522_event_t event, const void *data, size_t data_size);
 
+/**
+ * Posts the event to the event loop and runs its handlers in the calling task
+ */
+esp_err_t rc522_run_event_handlers(const rc522_handle_t rc522, rc522_event_t event, const void *data, size_t data_size);
+
 #ifdef __cplusplus
 }
 #endif
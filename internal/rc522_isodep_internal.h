@@ -0,0 +1,83 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+#include "picc/rc522_isodep.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Protocol Control Byte of the blocks (ISO/IEC 14443-4, section 7.1.1)
+ */
+#define RC522_ISODEP_PCB_TYPE_MASK        (0xC0)
+#define RC522_ISODEP_PCB_I_BLOCK          (0x02) // Followed by the block number and chaining bits
+#define RC522_ISODEP_PCB_R_BLOCK          (0xA2) // Followed by the block number and NAK bits
+#define RC522_ISODEP_PCB_R_BLOCK_TYPE     (0x80)
+#define RC522_ISODEP_PCB_S_BLOCK_TYPE     (0xC0)
+#define RC522_ISODEP_PCB_S_DESELECT       (0xC2)
+#define RC522_ISODEP_PCB_S_WTX            (0xF2)
+#define RC522_ISODEP_PCB_BLOCK_NUMBER_BIT (0x01)
+#define RC522_ISODEP_PCB_NAD_BIT          (0x04) // I-blocks only
+#define RC522_ISODEP_PCB_CID_BIT          (0x08)
+#define RC522_ISODEP_PCB_CHAINING_BIT     (0x10) // I-blocks
+#define RC522_ISODEP_PCB_NAK_BIT          (0x10) // R-blocks
+#define RC522_ISODEP_PCB_S_MASK           (0xF7) // S-block without the CID bit
+
+#define RC522_ISODEP_WTXM_MASK (0x3F)
+#define RC522_ISODEP_WTXM_MAX  (59)
+
+/**
+ * RATS and PPS
+ */
+#define RC522_ISODEP_PPSS      (0xD0) // Followed by CID
+#define RC522_ISODEP_PPS0_PPS1 (0x11) // PPS1 is transmitted
+#define RC522_ISODEP_FSDI      (8)    // FSD of RC522_ISODEP_FRAME_SIZE_MAX
+
+/**
+ * Format byte T0 of the ATS
+ */
+#define RC522_ISODEP_T0_TA_BIT    (0x10)
+#define RC522_ISODEP_T0_TB_BIT    (0x20)
+#define RC522_ISODEP_T0_TC_BIT    (0x40)
+#define RC522_ISODEP_T0_FSCI_MASK (0x0F)
+
+/**
+ * Interface bytes TA(1) and TC(1) of the ATS
+ */
+#define RC522_ISODEP_TA_SAME_BITRATE_BIT (0x80) // Same bit rate is required in both directions
+#define RC522_ISODEP_TC_NAD_BIT          (0x01)
+#define RC522_ISODEP_TC_CID_BIT          (0x02)
+
+/**
+ * Defaults of the interface bytes missing in the ATS
+ */
+#define RC522_ISODEP_FSCI_DEFAULT (2)
+#define RC522_ISODEP_FWI_DEFAULT  (4)
+#define RC522_ISODEP_SFGI_DEFAULT (0)
+#define RC522_ISODEP_TC_DEFAULT   (RC522_ISODEP_TC_CID_BIT)
+
+#define RC522_ISODEP_SIZE_INTEGER_MAX (8)  // Largest FSCI and FSDI (256 bytes), higher values are RFU
+#define RC522_ISODEP_TIME_INTEGER_MAX (14) // Largest FWI and SFGI, 15 is RFU
+
+/**
+ * Frame size (FSC or FSD) coded by FSCI or FSDI
+ */
+static inline uint16_t rc522_isodep_frame_size(uint8_t size_integer)
+{
+    static const uint16_t sizes[] = { 16, 24, 32, 40, 48, 64, 96, 128, 256 };
+
+    return sizes[size_integer > RC522_ISODEP_SIZE_INTEGER_MAX ? RC522_ISODEP_SIZE_INTEGER_MAX : size_integer];
+}
+
+/**
+ * Time coded by FWI or SFGI: (256 * 16 / fc) * 2^integer, where fc is 13.56 MHz
+ */
+static inline uint32_t rc522_isodep_time_us(uint8_t time_integer)
+{
+    return (uint32_t)((((uint64_t)4096 << time_integer) * 1000 + 13559) / 13560);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+#include "picc/rc522_ntag.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RC522_NTAG_CC_PAGE      (3)
+#define RC522_NTAG_CC_MAGIC     (0xE1) // Byte 0 of the Capability Container of NDEF formatted PICCs
+#define RC522_NTAG_VERSION_SIZE (8)    // Response of GET_VERSION
+
+#if CONFIG_RC522_NTAG_CACHE
+/**
+ * Drops the cached pages if they belong to the PICC, e.g. because it has left the field
+ */
+void rc522_ntag_cache_forget(const rc522_handle_t rc522, const rc522_picc_t *picc);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+#include "rc522_op.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Runs queued ops on the active PICC, or cancels them if no PICC is active.
+ * Stops at the first failed op, the rest waits for the next presence check.
+ */
+void rc522_op_run_pending(const rc522_handle_t rc522);
+
+/**
+ * Completes all queued ops with RC522_ERR_OP_CANCELLED
+ */
+void rc522_op_cancel_pending(const rc522_handle_t rc522);
+
+#ifdef __cplusplus
+}
+#endif
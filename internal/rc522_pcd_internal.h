@@ -1,6 +1,7 @@
 #pragma once
 
 #include "rc522_types_internal.h"
+#include "rc522_driver_internal.h"
 #include "rc522_pcd.h"
 
 #ifdef __cplusplus
@@ -11,6 +12,31 @@ extern "C" {
 #define RC522_PCD_TX_MODE_REG_RESET_VALUE   (0x00)
 #define RC522_PCD_RX_MODE_REG_RESET_VALUE   (RC522_PCD_RX_NO_ERR_BIT)
 
+#define RC522_PCD_TIMER_PRESCALER    (169) // f_timer = 13.56 MHz / (2 * 169 + 1) = 40 kHz
+#define RC522_PCD_TIMER_PERIOD_US    (25)
+#define RC522_PCD_TIMER_SCALE_MAX    (23) // Largest odd multiple of the period with TPrescaler below 4096 (37.7 s)
+#define RC522_PCD_TIMEOUT_US_DEFAULT (25000)
+
+#define RC522_PCD_RF_RESET_OFF_MS   (6) // ISO/IEC 14443-3: field is switched off for 5.1 ms at least
+#define RC522_PCD_RF_RESET_GUARD_MS (5) // Time for the PICC to power up before the first command
+
+#define RC522_PCD_FIFO_SIZE        (64)
+#define RC522_PCD_WATER_LEVEL      (32) // Frames longer than the FIFO are streamed in chunks of at least this size
+#define RC522_PCD_WATER_LEVEL_MASK (0x3F)
+
+/**
+ * Initializers of rc522_driver_op_t, for use with rc522_pcd_batch()
+ */
+#define RC522_PCD_WRITE_OP(addr, value)                                                                                \
+    {                                                                                                                  \
+        .type = RC522_DRIVER_OP_WRITE, .address = (addr), .bytes = { .ptr = (uint8_t[]) { (value) }, .length = 1 },    \
+    }
+#define RC522_PCD_WRITE_N_OP(addr, bytes_) { .type = RC522_DRIVER_OP_WRITE, .address = (addr), .bytes = (bytes_) }
+#define RC522_PCD_READ_OP(addr, value_ref)                                                                             \
+    {                                                                                                                  \
+        .type = RC522_DRIVER_OP_READ, .address = (addr), .bytes = { .ptr = (value_ref), .length = 1 },                 \
+    }
+
 typedef enum
 {
     // Starts and stops command execution
@@ -33,6 +59,9 @@ typedef enum
     // Error bits showing the error status of the last command  executed
     RC522_PCD_ERROR_REG = 0x06,
 
+    // Communication status bits
+    RC522_PCD_STATUS_1_REG = 0x07,
+
     // Contains status bits of the receiver, transmitter and data mode detector
     RC522_PCD_STATUS_2_REG = 0x08,
 
@@ -42,6 +71,9 @@ typedef enum
     // Number of bytes stored in the FIFO buffer
     RC522_PCD_FIFO_LEVEL_REG = 0x0A,
 
+    // Level for FIFO underflow and overflow warning
+    RC522_PCD_WATER_LEVEL_REG = 0x0B,
+
     // Shows the MFRC522 software version
     RC522_PCD_VERSION_REG = 0x37,
 
@@ -164,6 +196,32 @@ enum // RC522_PCD_ERROR_REG
     RC522_PCD_PROTOCOL_ERR_BIT = BIT0,
 };
 
+enum // RC522_PCD_COM_INT_EN_REG
+{
+    /**
+     * 1 - signal on pin IRQ is inverted with respect to the Status1Reg register’s IRq bit
+     * 0 - signal on pin IRQ is equal to the IRq bit
+     * in combination with the DivIEnReg register’s IRqPushPull bit, the
+     * default value of logic 1 ensures that the output level on pin IRQ is 3-state
+     *
+     * Remaining bits enable passing of the corresponding ComIrqReg bits
+     * to the IRQ pin, so ComIrqReg bit masks can be used to enable them
+     */
+    RC522_PCD_IRQ_INV_BIT = BIT7,
+};
+
+enum // RC522_PCD_DIV_INT_EN_REG
+{
+    /**
+     * 1 - pin IRQ is a standard CMOS output pin
+     * 0 - pin IRQ is an open-drain output pin
+     */
+    RC522_PCD_IRQ_PUSH_PULL_BIT = BIT7,
+
+    // Allows the CRCIRq bit to be propagated to pin IRQ
+    RC522_PCD_CRC_IEN_BIT = BIT2,
+};
+
 enum // RC522_PCD_COM_INT_REQ_REG
 {
     /**
@@ -382,6 +440,21 @@ enum // RC522_PCD_BIT_FRAMING_REG
     RC522_PCD_START_SEND_BIT = BIT7,
 };
 
+enum // RC522_PCD_STATUS_1_REG
+{
+    // The CRC result is valid (data processing of the CalcCRC command is finished)
+    RC522_PCD_CRC_READY_BIT = BIT5,
+
+    // Indicates if any interrupt source requests attention with respect to the setting of the interrupt enable bits
+    RC522_PCD_IRQ_BIT = BIT4,
+
+    // The number of bytes stored in the FIFO buffer is at most WaterLevel bytes from being full
+    RC522_PCD_HI_ALERT_BIT = BIT1,
+
+    // The number of bytes stored in the FIFO buffer is at most WaterLevel
+    RC522_PCD_LO_ALERT_BIT = BIT0,
+};
+
 enum // RC522_PCD_STATUS_2_REG
 {
     /**
@@ -395,8 +468,23 @@ enum // RC522_PCD_STATUS_2_REG
     RC522_PCD_MF_CRYPTO1_ON_BIT = BIT3,
 };
 
+enum // RC522_PCD_TX_MODE_REG
+{
+    /**
+     * Enables the CRC generation during data transmission
+     * Can only be set to logic 0 at 106 kBd
+     */
+    RC522_PCD_TX_CRC_EN_BIT = BIT7,
+};
+
 enum // RC522_PCD_RX_MODE_REG
 {
+    /**
+     * Enables the CRC calculation during reception
+     * Can only be set to logic 0 at 106 kBd
+     */
+    RC522_PCD_RX_CRC_EN_BIT = BIT7,
+
     /**
      * An invalid received data stream (less than 4 bits received) will
      * be ignored and the receiver remains active
@@ -404,6 +492,17 @@ enum // RC522_PCD_RX_MODE_REG
     RC522_PCD_RX_NO_ERR_BIT = BIT3,
 };
 
+#define RC522_PCD_SPEED_SHIFT (4)
+#define RC522_PCD_SPEED_MASK  (0x70) // TxSpeed and RxSpeed bits of RC522_PCD_TX_MODE_REG and RC522_PCD_RX_MODE_REG
+
+typedef enum
+{
+    RC522_PCD_SPEED_106 = 0x00, /*<! 106 kBd, used until the PICC agrees to a higher one */
+    RC522_PCD_SPEED_212 = 0x01,
+    RC522_PCD_SPEED_424 = 0x02,
+    RC522_PCD_SPEED_848 = 0x03,
+} rc522_pcd_speed_t;
+
 typedef enum
 {
     RC522_PCD_FIRMWARE_CLONE = 0x88,       // clone
@@ -429,6 +528,25 @@ esp_err_t rc522_pcd_calculate_crc(const rc522_handle_t rc522, const rc522_bytes_
 
 esp_err_t rc522_pcd_init(const rc522_handle_t rc522);
 
+/**
+ * Sets how long the PCD waits for the PICC response, counted from the end
+ * of the transmission. Registers are written only if the value changes.
+ * Timeouts longer than 1.6 s are counted at a lower resolution, up to 37.7 s.
+ */
+esp_err_t rc522_pcd_set_timeout(const rc522_handle_t rc522, uint32_t timeout_us);
+
+/**
+ * Switches the RF field off and on again. All PICCs lose power
+ * and return into IDLE state, including the halted ones.
+ */
+esp_err_t rc522_pcd_rf_reset(const rc522_handle_t rc522);
+
+/**
+ * Sets the bit rates of both directions and the modulation width matching the transmission one.
+ * CRC bits of the mode registers are kept, registers are written only if the value changes.
+ */
+esp_err_t rc522_pcd_set_speed(const rc522_handle_t rc522, rc522_pcd_speed_t tx_speed, rc522_pcd_speed_t rx_speed);
+
 esp_err_t rc522_pcd_firmware(const rc522_handle_t rc522, rc522_pcd_firmware_t *result);
 
 char *rc522_pcd_firmware_name(rc522_pcd_firmware_t firmware);
@@ -459,8 +577,28 @@ esp_err_t rc522_pcd_read_n(const rc522_handle_t rc522, rc522_pcd_register_t addr
 
 esp_err_t rc522_pcd_read(const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t *value_ref);
 
+/**
+ * Executes multiple register writes and reads, in order, as a single bus transaction
+ */
+esp_err_t rc522_pcd_batch(const rc522_handle_t rc522, rc522_driver_op_t *ops, uint8_t count);
+
 esp_err_t rc522_pcd_set_bits(const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t bits);
 
+/**
+ * Routes given ComIrqReg and DivIrqReg interrupts to the IRQ pin and registers
+ * the calling task as the receiver. Must be called before the command is started.
+ * Does nothing if the IRQ pin is not used.
+ */
+esp_err_t rc522_pcd_irq_arm(const rc522_handle_t rc522, uint8_t com_irq_bits, uint8_t div_irq_bits);
+
+/**
+ * Blocks until the IRQ pin is asserted or the deadline is reached.
+ * Returns immediately if the IRQ pin is not used (registers are polled).
+ */
+esp_err_t rc522_pcd_irq_wait(const rc522_handle_t rc522, uint32_t deadline_ms);
+
+esp_err_t rc522_pcd_irq_disarm(const rc522_handle_t rc522);
+
 esp_err_t rc522_pcd_clear_bits(const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t bits);
 
 #ifdef __cplusplus
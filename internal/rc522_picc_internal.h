@@ -7,6 +7,26 @@
 extern "C" {
 #endif
 
+/**
+ * Response timeouts, counted by the PCD timer from the end of the transmission
+ */
+#define RC522_PICC_TIMEOUT_US_ACTIVATION (1000) // REQA, WUPA, ANTICOLLISION, SELECT and HLTA
+#define RC522_PICC_TIMEOUT_US_READ       (5000)
+#define RC522_PICC_TIMEOUT_US_WRITE      (RC522_PCD_TIMEOUT_US_DEFAULT) // Authentication and memory writes
+#define RC522_PICC_TIMEOUT_US_PROBE_HLTA (100) // HLTA of the presence check, only moves the PICC into HALT
+
+/**
+ * Software deadline is longer than the PCD timeout, to include the transmission
+ * of the frame. It is reached only if the communication with the PCD is broken.
+ */
+#define RC522_PICC_DEADLINE_MARGIN_MS (11)
+
+/**
+ * Air time of a byte with its parity bit at 106 kBd. Frames longer than the FIFO
+ * are streamed, so the deadline is extended by the time they spend on the air.
+ */
+#define RC522_PICC_BYTE_TIME_US (86)
+
 /**
  * Commands sent to the PICC
  */
@@ -56,6 +76,11 @@ typedef enum
      *
      */
     RC522_PICC_CMD_RATS = 0xE0,
+
+    /**
+     * READ of 16 bytes (4 pages) from MIFARE Ultralight and NTAG. Used by the presence check.
+     */
+    RC522_PICC_CMD_T2T_READ = 0x30,
 } rc522_picc_command_t;
 
 typedef struct
@@ -65,7 +90,10 @@ typedef struct
     uint8_t expected_interrupts;
     uint8_t rx_align;
     uint8_t valid_bits;
-    bool check_crc;
+    bool check_crc;      /*<! Verify CRC_A of the received frame in software (or using CalcCRC command) */
+    bool tx_crc;         /*<! PCD appends CRC_A to the transmitted frame */
+    bool rx_crc;         /*<! PCD verifies CRC_A of the received frame and removes it from the FIFO */
+    uint32_t timeout_us; /*<! How long to wait for the response, 0 for RC522_PCD_TIMEOUT_US_DEFAULT */
 } rc522_picc_transaction_t;
 
 typedef struct rc522_picc_transaction_context rc522_picc_transaction_context_t;
@@ -86,11 +114,32 @@ esp_err_t rc522_picc_reqa(const rc522_handle_t rc522, rc522_picc_atqa_desc_t *ou
 
 esp_err_t rc522_picc_wupa(const rc522_handle_t rc522, rc522_picc_atqa_desc_t *out_atqa);
 
-esp_err_t rc522_picc_select(
-    const rc522_handle_t rc522, rc522_picc_uid_t *out_uid, uint8_t *out_sak, bool skip_anticoll);
+esp_err_t rc522_picc_select(const rc522_handle_t rc522, const rc522_picc_atqa_desc_t *atqa, rc522_picc_uid_t *out_uid,
+    uint8_t *out_sak, bool skip_anticoll);
 
+/**
+ * Wakes up the PICC from IDLE or HALT with WUPA and SELECTs it by its known UID,
+ * without changing the state of the rc522_picc_t. WUPA is sent twice if needed,
+ * the first one may be swallowed by a PICC which has just dropped out of the ACTIVE state.
+ */
+esp_err_t rc522_picc_reselect(const rc522_handle_t rc522, const rc522_picc_t *picc);
+
+/**
+ * Sends HLTA to the active PICC, without changing the state of any rc522_picc_t
+ */
+esp_err_t rc522_picc_send_halta(const rc522_handle_t rc522);
+
+/**
+ * Sends HLTA and moves the PICC into HALT state
+ */
 esp_err_t rc522_picc_halta(const rc522_handle_t rc522, rc522_picc_t *picc);
 
+/**
+ * Checks that the active PICC is still in the field, see rc522_presence_check_mode_t
+ */
+esp_err_t rc522_picc_presence_check(
+    const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_presence_check_mode_t mode);
+
 esp_err_t rc522_picc_heartbeat(
     const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_picc_uid_t *out_uid, uint8_t *out_sak);
 
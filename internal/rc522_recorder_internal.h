@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string.h>
+#include "rc522_types_internal.h"
+#include "driver/rc522_recorder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t timestamp_us;
+    uint16_t duration_us;
+    uint8_t type; /*<! rc522_record_type_t with RC522_RECORD_FLAG_* flags */
+    uint8_t address;
+    uint8_t length;
+    const uint8_t *payload; /*<! Points into the log */
+} rc522_record_t;
+
+static inline void rc522_record_encode_header(const rc522_record_t *record, uint8_t header[RC522_RECORD_HEADER_SIZE])
+{
+    header[0] = record->timestamp_us & 0xFF;
+    header[1] = (record->timestamp_us >> 8) & 0xFF;
+    header[2] = (record->timestamp_us >> 16) & 0xFF;
+    header[3] = (record->timestamp_us >> 24) & 0xFF;
+    header[4] = record->duration_us & 0xFF;
+    header[5] = (record->duration_us >> 8) & 0xFF;
+    header[6] = record->type;
+    header[7] = record->address;
+    header[8] = record->length;
+}
+
+/**
+ * @return ESP_ERR_INVALID_SIZE if there is no complete record at the offset
+ */
+static inline esp_err_t rc522_record_decode(const uint8_t *log, size_t length, size_t offset, rc522_record_t *out)
+{
+    if (offset + RC522_RECORD_HEADER_SIZE > length) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t *header = log + offset;
+
+    out->timestamp_us = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+    out->duration_us = header[4] | (header[5] << 8);
+    out->type = header[6];
+    out->address = header[7];
+    out->length = header[8];
+    out->payload = header + RC522_RECORD_HEADER_SIZE;
+
+    if (offset + RC522_RECORD_HEADER_SIZE + out->length > length) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    return ESP_OK;
+}
+
+static inline void rc522_record_encode_error(esp_err_t err, uint8_t payload[4])
+{
+    uint32_t value = (uint32_t)err;
+
+    payload[0] = value & 0xFF;
+    payload[1] = (value >> 8) & 0xFF;
+    payload[2] = (value >> 16) & 0xFF;
+    payload[3] = (value >> 24) & 0xFF;
+}
+
+static inline esp_err_t rc522_record_decode_error(const rc522_record_t *record)
+{
+    if (record->length != 4) {
+        return ESP_FAIL;
+    }
+
+    const uint8_t *p = record->payload;
+
+    return (esp_err_t)(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+#ifdef __cplusplus
+}
+#endif
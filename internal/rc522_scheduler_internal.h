@@ -0,0 +1,28 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Scans the field as often as the floor allows while PICCs come and go.
+ * Once the field has been empty for rc522_config_t::scan_backoff_after_ms,
+ * every empty scan doubles the delay, up to the ceiling.
+ */
+void rc522_scheduler_init(const rc522_handle_t rc522);
+
+/**
+ * PICC has arrived or left
+ */
+void rc522_scheduler_on_activity(const rc522_handle_t rc522);
+
+/**
+ * No PICC has answered the scan
+ */
+void rc522_scheduler_on_empty_scan(const rc522_handle_t rc522);
+
+#ifdef __cplusplus
+}
+#endif
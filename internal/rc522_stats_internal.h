@@ -0,0 +1,34 @@
+#pragma once
+
+#include "rc522_types_internal.h"
+#include "rc522_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_RC522_STATS
+
+void rc522_stats_begin(const rc522_handle_t rc522, rc522_stats_span_t *span);
+
+void rc522_stats_end(
+    const rc522_handle_t rc522, const rc522_stats_span_t *span, rc522_stats_stage_t stage, esp_err_t ret);
+
+#define RC522_STATS_BEGIN(rc522, span)                                                                                 \
+    rc522_stats_span_t span;                                                                                           \
+    rc522_stats_begin(rc522, &span)
+
+#define RC522_STATS_END(rc522, span, stage, ret) rc522_stats_end(rc522, &span, stage, ret)
+#define RC522_STATS_BUS_OP(rc522)                ((rc522)->stats_bus_ops++)
+
+#else
+
+#define RC522_STATS_BEGIN(rc522, span)
+#define RC522_STATS_END(rc522, span, stage, ret) (void)(ret)
+#define RC522_STATS_BUS_OP(rc522)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
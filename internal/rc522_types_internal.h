@@ -5,8 +5,12 @@
 #include <esp_bit_defs.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
+#include <freertos/queue.h>
 #include "rc522_types.h"
 #include "rc522_picc.h"
+#include "rc522_stats.h"
+#include "rc522_op.h"
+#include "picc/rc522_ntag.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,10 +18,20 @@ extern "C" {
 
 #define RC522_LOG_TAG "rc522"
 
-#define RC522_POLL_INTERVAL_MS_DEFAULT (120)
-#define RC522_POLL_INTERVAL_MS_MIN     (50)
-#define RC522_TASK_STACK_SIZE_DEFAULT  (4 * 1024)
-#define RC522_TASK_PRIORITY_DEFAULT    (3)
+#define RC522_POLL_INTERVAL_MS_DEFAULT  (120)
+#define RC522_POLL_INTERVAL_MS_MIN      (50)
+#define RC522_POLL_STEP_PAUSED_DELAY_MS (100)
+#define RC522_TASK_STACK_SIZE_DEFAULT   (4 * 1024)
+#define RC522_TASK_PRIORITY_DEFAULT     (3)
+
+#define RC522_SCAN_INTERVAL_MS_FLOOR_DEFAULT   (20)
+#define RC522_SCAN_INTERVAL_MS_CEILING_DEFAULT (50)
+#define RC522_SCAN_BACKOFF_AFTER_MS_DEFAULT    (2000)
+
+#define RC522_PRESENCE_CHECK_SELECT_INTERVAL_MS_DEFAULT (50)
+#define RC522_PRESENCE_CHECK_SELECT_THRESHOLD_DEFAULT   (3)
+#define RC522_PRESENCE_CHECK_INTERVAL_MS_DEFAULT        (20) // WUPA and READ
+#define RC522_PRESENCE_CHECK_THRESHOLD_DEFAULT          (2)  // WUPA and READ
 
 #define RC522_TASK_STOPPED_BIT (BIT0)
 
@@ -31,15 +45,99 @@ typedef enum
     RC522_STATE_PAUSED,
 } rc522_state_t;
 
+/**
+ * Copy of the PCD registers which are written only by the driver,
+ * used to avoid reading them over the bus on every read-modify-write
+ */
+typedef struct
+{
+    uint64_t valid;     /*<! Bit N is set if value of the register N is known */
+    uint8_t values[64]; /*<! Register values indexed by register address */
+} rc522_pcd_shadow_t;
+
+typedef struct
+{
+    uint32_t start_us;
+    uint32_t bus_ops; /*<! Bus transactions done before the stage has started */
+} rc522_stats_span_t;
+
+#if CONFIG_RC522_NTAG_CACHE
+/**
+ * Pages of one NTAG PICC read so far, up to the end of its data area
+ */
+typedef struct
+{
+    rc522_picc_uid_t uid;                      /*<! PICC the pages belong to, length 0 if nothing is cached */
+    uint16_t page_count;                       /*<! Pages which can be cached, from the Capability Container */
+    uint32_t valid[NTAG_CACHE_PAGES_MAX / 32]; /*<! Bit N is set if the page N is known */
+    uint8_t memory[NTAG_CACHE_PAGES_MAX * NTAG_PAGE_SIZE];
+    rc522_ntag_cache_stats_t stats;
+} rc522_ntag_cache_t;
+#endif
+
+typedef struct rc522_dispatcher *rc522_dispatcher_handle_t;
+
+#if CONFIG_RC522_STATIC_ALLOCATION
+typedef struct
+{
+    int32_t event;               /*<! Event ID, or ESP_EVENT_ANY_ID */
+    esp_event_handler_t handler; /*<! NULL if the entry is free */
+    void *arg;
+} rc522_event_handler_entry_t;
+#endif
+
+typedef struct
+{
+    uint32_t interval_ms;      /*<! Current delay between scans of the empty field */
+    uint32_t last_activity_ms; /*<! When a PICC has arrived or left */
+} rc522_scheduler_t;
+
 struct rc522
 {
     rc522_config_t *config;               /*<! Configuration */
+    rc522_config_t config_buffer;         /*<! Storage of the configuration */
+    bool is_static;                       /*<! Storage is owned by the caller (see rc522_create_static()) */
     bool exit_requested;                  /*<! Indicates whether polling task exit is requested */
     TaskHandle_t task_handle;             /*<! Handle of task */
+#if CONFIG_RC522_STATIC_ALLOCATION
+    rc522_event_handler_entry_t handlers[CONFIG_RC522_EVENT_HANDLERS_MAX];
+    portMUX_TYPE handlers_lock;
+#else
     esp_event_loop_handle_t event_handle; /*<! Handle of event loop */
+#endif
     rc522_state_t state;                  /*<! Current state */
     rc522_picc_t picc;
     EventGroupHandle_t bits;
+    StaticEventGroup_t bits_buffer;
+    rc522_pcd_shadow_t shadow; /*<! Shadow copy of PCD configuration registers */
+    rc522_picc_t inventory[RC522_INVENTORY_SIZE_MAX]; /*<! PICCs found by the last inventory */
+    uint8_t inventory_count;
+    rc522_scheduler_t scheduler;
+    uint32_t last_poll_ms;                /*<! Last SELECT or inventory */
+    uint8_t presence_check_failures;      /*<! Failed presence checks in a row */
+    rc522_dispatcher_handle_t dispatcher; /*<! NULL unless rc522_config_t::dispatcher is enabled */
+    QueueHandle_t ops;                    /*<! Submitted rc522_op_t pointers */
+    StaticQueue_t ops_buffer;
+    uint8_t ops_storage[RC522_OP_QUEUE_SIZE * sizeof(rc522_op_t *)];
+    rc522_detect_result_t detect_result;  /*<! Result of the last detect plan */
+
+    /**
+     * Set to detect_result when a plan has run, attached
+     * to the following event of the PICC becoming active
+     */
+    const rc522_detect_result_t *pending_detect_result;
+#if CONFIG_RC522_NTAG_CACHE
+    rc522_ntag_cache_t ntag_cache;
+#endif
+    rc522_picc_uid_t ntag_version_uid; /*<! Last NTAG PICC asked for GET_VERSION */
+    bool ntag_fast_read;               /*<! The PICC has answered GET_VERSION, so it supports FAST_READ */
+#if CONFIG_RC522_STATS
+    uint32_t last_stats_ms; /*<! Last RC522_EVENT_STATS */
+    rc522_stats_t stats;
+    portMUX_TYPE stats_lock;
+    uint32_t stats_bus_ops;        /*<! Bus transactions since the start, used to count them per stage */
+    rc522_stats_span_t activation; /*<! Started when the PICC answers REQA or WUPA */
+#endif
 };
 
 typedef struct
@@ -0,0 +1,843 @@
+#include <string.h>
+#include "rc522_types_internal.h"
+#include "rc522_driver_internal.h"
+#include "rc522_pcd_internal.h"
+#include "rc522_emulator_internal.h"
+#include "driver/rc522_emulator.h"
+
+RC522_LOG_DEFINE_BASE();
+
+#define RC522_EMULATOR_ETU_NS_106 (9440) // Elementary time unit at 106 kBd, 128 / fc
+#define RC522_EMULATOR_FDT_NS     (86430) // Frame delay time of the PICC, 1172 / fc
+
+#define RC522_EMULATOR_LOCK(emulator)   xSemaphoreTake((emulator)->mutex, portMAX_DELAY)
+#define RC522_EMULATOR_UNLOCK(emulator) xSemaphoreGive((emulator)->mutex)
+
+enum
+{
+    RC522_EMULATOR_RCV_OFF_BIT = BIT5,       // CommandReg
+    RC522_EMULATOR_SET_2_BIT = BIT7,         // DivIrqReg
+    RC522_EMULATOR_RX_ALIGN_MASK = 0x70,     // BitFramingReg
+    RC522_EMULATOR_TX_LAST_BITS_MASK = 0x07, // BitFramingReg
+    RC522_EMULATOR_RX_LAST_BITS_MASK = 0x07, // ControlReg
+    RC522_EMULATOR_COLL_POS_MASK = 0x1F,     // CollReg
+};
+
+/**
+ * Reset values of the registers, see datasheet, section 9.3
+ */
+static const uint8_t rc522_emulator_register_reset_values[RC522_EMULATOR_REGISTERS_COUNT] = {
+    [RC522_PCD_COMMAND_REG] = RC522_EMULATOR_RCV_OFF_BIT,
+    [RC522_PCD_COM_INT_EN_REG] = 0x80,
+    [RC522_PCD_COM_INT_REQ_REG] = (RC522_PCD_IDLE_IRQ_BIT | RC522_PCD_LO_ALERT_IRQ_BIT),
+    [RC522_PCD_WATER_LEVEL_REG] = 0x08,
+    [RC522_PCD_CONTROL_REG] = 0x10,
+    [RC522_PCD_COLL_REG] = (RC522_PCD_VALUES_AFTER_COLL_BIT | RC522_PCD_COLL_POS_NOT_VALID_BIT),
+    [RC522_PCD_MODE_REG] = 0x3F,
+    [RC522_PCD_TX_MODE_REG] = RC522_PCD_TX_MODE_REG_RESET_VALUE,
+    [RC522_PCD_RX_MODE_REG] = 0x00,
+    [RC522_PCD_TX_CONTROL_REG] = 0x80,
+    [RC522_PCD_CRC_RESULT_MSB_REG] = 0xFF,
+    [RC522_PCD_CRC_RESULT_LSB_REG] = 0xFF,
+    [RC522_PCD_MOD_WIDTH_REG] = RC522_PCD_MOD_WIDTH_REG_RESET_VALUE,
+    [RC522_PCD_RF_CFG_REG] = 0x48,
+};
+
+inline static rc522_emulator_t *rc522_emulator_from_driver(const rc522_driver_handle_t driver)
+{
+    return (rc522_emulator_t *)(driver->device);
+}
+
+inline static bool rc522_emulator_field_on(const rc522_emulator_t *emulator)
+{
+    return emulator->registers[RC522_PCD_TX_CONTROL_REG] & (RC522_PCD_TX2_RF_EN_BIT | RC522_PCD_TX1_RF_EN_BIT);
+}
+
+/**
+ * CRC coprocessor. Polynomial x^16 + x^12 + x^5 + 1, LSBit first,
+ * with the preset selected by ModeReg
+ */
+static uint16_t rc522_emulator_crc(const rc522_emulator_t *emulator, const uint8_t *bytes, uint16_t length)
+{
+    static const uint16_t presets[] = { 0x0000, 0x6363, 0xA671, 0xFFFF };
+
+    uint16_t crc = presets[emulator->registers[RC522_PCD_MODE_REG] & 0x03];
+
+    for (uint16_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x0001) ? ((crc >> 1) ^ 0x8408) : (crc >> 1);
+        }
+    }
+
+    return crc;
+}
+
+static void rc522_emulator_fifo_flush(rc522_emulator_t *emulator)
+{
+    emulator->fifo_level = 0;
+    emulator->registers[RC522_PCD_ERROR_REG] &= ~RC522_PCD_BUFFER_OVFL_BIT;
+}
+
+static void rc522_emulator_fifo_push(rc522_emulator_t *emulator, uint8_t value)
+{
+    if (emulator->fifo_level >= RC522_EMULATOR_FIFO_SIZE) {
+        emulator->registers[RC522_PCD_ERROR_REG] |= RC522_PCD_BUFFER_OVFL_BIT;
+        return;
+    }
+
+    emulator->fifo[emulator->fifo_level++] = value;
+}
+
+static uint8_t rc522_emulator_fifo_pop(rc522_emulator_t *emulator)
+{
+    if (emulator->fifo_level == 0) {
+        return 0x00;
+    }
+
+    uint8_t value = emulator->fifo[0];
+    memmove(emulator->fifo, emulator->fifo + 1, --emulator->fifo_level);
+
+    return value;
+}
+
+/**
+ * Computes the level of the IRQ pin and raises the (virtual) IRQ on its rising edge
+ */
+static void rc522_emulator_update_irq(rc522_emulator_t *emulator)
+{
+    const uint8_t *regs = emulator->registers;
+
+    bool asserted = (regs[RC522_PCD_COM_INT_EN_REG] & regs[RC522_PCD_COM_INT_REQ_REG] & 0x7F)
+                    || (regs[RC522_PCD_DIV_INT_EN_REG] & regs[RC522_PCD_DIV_INT_REQ_REG] & 0x7F);
+
+    if (asserted && !emulator->irq_asserted && rc522_driver_irq_enabled(emulator->driver)) {
+        rc522_driver_raise_irq(emulator->driver);
+    }
+
+    emulator->irq_asserted = asserted;
+}
+
+/**
+ * Card loses power when the antenna is switched off
+ */
+static void rc522_emulator_field_off(rc522_emulator_t *emulator)
+{
+    for (uint8_t i = 0; i < RC522_EMULATOR_PICC_COUNT_MAX; i++) {
+        emulator->piccs[i].halted = false;
+        rc522_emulator_picc_reset(&emulator->piccs[i]);
+    }
+}
+
+static void rc522_emulator_reset_registers(rc522_emulator_t *emulator)
+{
+    memcpy(emulator->registers, rc522_emulator_register_reset_values, sizeof(emulator->registers));
+    emulator->registers[RC522_PCD_VERSION_REG] = emulator->firmware;
+    emulator->crc_ready = false;
+    emulator->transfer.state = RC522_EMULATOR_TRANSFER_IDLE;
+
+    rc522_emulator_fifo_flush(emulator);
+    rc522_emulator_field_off(emulator);
+}
+
+static void rc522_emulator_calc_crc(rc522_emulator_t *emulator)
+{
+    uint16_t crc = rc522_emulator_crc(emulator, emulator->fifo, emulator->fifo_level);
+
+    emulator->fifo_level = 0; // FIFO content is transferred to the coprocessor
+    emulator->registers[RC522_PCD_CRC_RESULT_MSB_REG] = (crc >> 8) & 0xFF;
+    emulator->registers[RC522_PCD_CRC_RESULT_LSB_REG] = crc & 0xFF;
+    emulator->registers[RC522_PCD_DIV_INT_REQ_REG] |= RC522_PCD_CRC_IRQ_BIT;
+    emulator->crc_ready = true;
+}
+
+static void rc522_emulator_authenticate(rc522_emulator_t *emulator)
+{
+    uint8_t *regs = emulator->registers;
+    bool authenticated = false;
+
+    if (emulator->fifo_level >= 12 && rc522_emulator_field_on(emulator)) {
+        for (uint8_t i = 0; i < RC522_EMULATOR_PICC_COUNT_MAX; i++) {
+            authenticated |= rc522_emulator_picc_authenticate(&emulator->piccs[i], emulator->fifo);
+        }
+    }
+
+    emulator->fifo_level = 0;
+    regs[RC522_PCD_COMMAND_REG] = (regs[RC522_PCD_COMMAND_REG] & 0xF0) | RC522_PCD_IDLE_CMD;
+
+    if (authenticated) {
+        regs[RC522_PCD_STATUS_2_REG] |= RC522_PCD_MF_CRYPTO1_ON_BIT;
+        regs[RC522_PCD_COM_INT_REQ_REG] |= RC522_PCD_IDLE_IRQ_BIT;
+    }
+    else {
+        regs[RC522_PCD_STATUS_2_REG] &= ~RC522_PCD_MF_CRYPTO1_ON_BIT;
+        regs[RC522_PCD_ERROR_REG] |= RC522_PCD_PROTOCOL_ERR_BIT;
+        regs[RC522_PCD_COM_INT_REQ_REG] |= (RC522_PCD_TIMER_IRQ_BIT | RC522_PCD_ERR_IRQ_BIT);
+    }
+}
+
+/**
+ * Air time of the frame: start and end of communication, data bits and parity bit of each full byte
+ */
+static uint64_t rc522_emulator_frame_time_ns(const rc522_emulator_frame_t *frame, uint8_t speed)
+{
+    return (uint64_t)(frame->bits + (frame->bits / 8) + 2) * (RC522_EMULATOR_ETU_NS_106 >> speed);
+}
+
+/**
+ * Timeout of the timer started by TAuto: (TReloadVal + 1) periods of (2 * TPrescaler + 1) / fc
+ */
+static uint64_t rc522_emulator_timer_time_ns(const rc522_emulator_t *emulator)
+{
+    const uint8_t *regs = emulator->registers;
+    uint32_t prescaler = ((regs[RC522_PCD_TIMER_MODE_REG] & 0x0F) << 8) | regs[RC522_PCD_TIMER_PRESCALER_REG];
+    uint32_t reload = (regs[RC522_PCD_TIMER_RELOAD_MSB_REG] << 8) | regs[RC522_PCD_TIMER_RELOAD_LSB_REG];
+
+    return ((uint64_t)(reload + 1) * (2 * prescaler + 1) * 1000000) / 13560;
+}
+
+/**
+ * Merges responses of all PICCs, as the PCD receives them. Returns
+ * the index of the first bit with collision, or -1 if there is none.
+ */
+static int16_t rc522_emulator_merge_responses(
+    const rc522_emulator_frame_t *responses, uint8_t count, rc522_emulator_frame_t *out_frame)
+{
+    int16_t collision = -1;
+
+    memcpy(out_frame, &responses[0], sizeof(rc522_emulator_frame_t));
+
+    for (uint8_t i = 1; i < count; i++) {
+        uint16_t bits = responses[i].bits < out_frame->bits ? responses[i].bits : out_frame->bits;
+        uint16_t j = 0;
+
+        while (j < bits && rc522_emulator_frame_bit(&responses[i], j) == rc522_emulator_frame_bit(out_frame, j)) {
+            j++;
+        }
+
+        if (j < bits || responses[i].bits != out_frame->bits) {
+            if (collision < 0 || j < collision) {
+                collision = j;
+            }
+        }
+    }
+
+    if (collision >= 0) {
+        // Bit with collision is received as 1 and nothing after it is valid
+        rc522_emulator_frame_set_bit(out_frame, collision, 1);
+        out_frame->bits = collision + 1;
+    }
+
+    return collision;
+}
+
+/**
+ * Transceive command is started: the frame is taken from the FIFO as it is being filled
+ */
+static void rc522_emulator_transfer_start(rc522_emulator_t *emulator)
+{
+    uint8_t *regs = emulator->registers;
+    rc522_emulator_transfer_t *transfer = &emulator->transfer;
+
+    regs[RC522_PCD_BIT_FRAMING_REG] &= ~RC522_PCD_START_SEND_BIT;
+    regs[RC522_PCD_ERROR_REG] &= ~(RC522_PCD_COLL_ERR_BIT | RC522_PCD_CRC_ERR_BIT | RC522_PCD_PROTOCOL_ERR_BIT);
+
+    transfer->state = RC522_EMULATOR_TRANSFER_TX;
+    transfer->tx_last_bits = regs[RC522_PCD_BIT_FRAMING_REG] & RC522_EMULATOR_TX_LAST_BITS_MASK;
+    transfer->rx_align = (regs[RC522_PCD_BIT_FRAMING_REG] & RC522_EMULATOR_RX_ALIGN_MASK) >> 4;
+    transfer->encrypted = regs[RC522_PCD_STATUS_2_REG] & RC522_PCD_MF_CRYPTO1_ON_BIT;
+    transfer->frame.bits = 0;
+}
+
+/**
+ * Frame is complete (with CRC_A appended) and it is delivered to the PICCs
+ */
+static void rc522_emulator_transfer_sent(rc522_emulator_t *emulator)
+{
+    uint8_t *regs = emulator->registers;
+    rc522_emulator_transfer_t *transfer = &emulator->transfer;
+    rc522_emulator_frame_t *tx_frame = &transfer->frame;
+    uint16_t tx_length = tx_frame->bits / 8;
+    uint8_t tx_speed = (regs[RC522_PCD_TX_MODE_REG] & RC522_PCD_SPEED_MASK) >> RC522_PCD_SPEED_SHIFT;
+    uint8_t rx_speed = (regs[RC522_PCD_RX_MODE_REG] & RC522_PCD_SPEED_MASK) >> RC522_PCD_SPEED_SHIFT;
+
+    if (transfer->tx_last_bits && tx_frame->bits) {
+        tx_frame->bits -= (8 - transfer->tx_last_bits);
+    }
+
+    if ((regs[RC522_PCD_TX_MODE_REG] & RC522_PCD_TX_CRC_EN_BIT) && !transfer->tx_last_bits) {
+        uint16_t crc = rc522_emulator_crc(emulator, tx_frame->bytes, tx_length);
+
+        tx_frame->bytes[tx_length] = crc & 0xFF;
+        tx_frame->bytes[tx_length + 1] = (crc >> 8) & 0xFF;
+        tx_frame->bits += 16;
+    }
+
+    emulator->air_time_ns += rc522_emulator_frame_time_ns(tx_frame, tx_speed);
+    regs[RC522_PCD_COM_INT_REQ_REG] |= RC522_PCD_TX_IRQ_BIT;
+
+    bool timer = regs[RC522_PCD_TIMER_MODE_REG] & RC522_PCD_T_AUTO_BIT;
+    uint64_t timeout_ns = timer ? rc522_emulator_timer_time_ns(emulator) : UINT64_MAX;
+    uint64_t delay_ns = 0; // Of the latest response
+    uint8_t responses_count = 0;
+
+    for (uint8_t i = 0; i < RC522_EMULATOR_PICC_COUNT_MAX && rc522_emulator_field_on(emulator); i++) {
+        rc522_emulator_picc_t *picc = &emulator->piccs[i];
+        rc522_emulator_frame_t *response = &transfer->responses[responses_count];
+        uint64_t picc_delay_ns = 0;
+
+        memset(response, 0, sizeof(rc522_emulator_frame_t));
+
+        if (picc->busy_until_ns != 0) {
+            // Frame is ignored by the busy PICC, its delayed response is received only before the timeout
+            if (picc->busy_until_ns > emulator->air_time_ns) {
+                picc_delay_ns = picc->busy_until_ns - emulator->air_time_ns;
+            }
+
+            if (picc_delay_ns > timeout_ns) {
+                continue;
+            }
+
+            memcpy(response, &picc->delayed_response, sizeof(rc522_emulator_frame_t));
+            picc->busy_until_ns = 0;
+        }
+        else {
+            bool received = rc522_emulator_picc_receive(
+                picc, tx_frame, transfer->encrypted, tx_speed, rx_speed, response);
+
+            picc_delay_ns = picc->response_delay_ns;
+            picc->response_delay_ns = 0;
+
+            if (!received) {
+                continue;
+            }
+
+            if (picc_delay_ns > timeout_ns) {
+                memcpy(&picc->delayed_response, response, sizeof(rc522_emulator_frame_t));
+                picc->busy_until_ns = emulator->air_time_ns + picc_delay_ns;
+                continue;
+            }
+        }
+
+        delay_ns = picc_delay_ns > delay_ns ? picc_delay_ns : delay_ns;
+        responses_count++;
+    }
+
+    if (responses_count == 0) {
+        // Timer started by TAuto expires, since nothing has been received
+        if (timer) {
+            emulator->air_time_ns += timeout_ns;
+            regs[RC522_PCD_COM_INT_REQ_REG] |= RC522_PCD_TIMER_IRQ_BIT;
+        }
+
+        transfer->state = RC522_EMULATOR_TRANSFER_IDLE;
+
+        return;
+    }
+
+    rc522_emulator_frame_t *rx_frame = &transfer->frame;
+    int16_t collision = rc522_emulator_merge_responses(transfer->responses, responses_count, rx_frame);
+    uint8_t error = 0;
+
+    emulator->air_time_ns += delay_ns + RC522_EMULATOR_FDT_NS + rc522_emulator_frame_time_ns(rx_frame, rx_speed);
+
+    regs[RC522_PCD_COLL_REG] &= RC522_PCD_VALUES_AFTER_COLL_BIT;
+
+    if (collision >= 0) {
+        uint16_t coll_pos = transfer->rx_align + collision + 1;
+
+        error |= RC522_PCD_COLL_ERR_BIT;
+        regs[RC522_PCD_COLL_REG] |= (coll_pos > 32) ? RC522_PCD_COLL_POS_NOT_VALID_BIT
+                                                    : (coll_pos & RC522_EMULATOR_COLL_POS_MASK);
+    }
+    else {
+        regs[RC522_PCD_COLL_REG] |= RC522_PCD_COLL_POS_NOT_VALID_BIT;
+    }
+
+    if ((regs[RC522_PCD_RX_MODE_REG] & RC522_PCD_RX_CRC_EN_BIT) && collision < 0) {
+        uint16_t length = rx_frame->bits / 8;
+        uint16_t crc = length >= 2 ? rc522_emulator_crc(emulator, rx_frame->bytes, length - 2) : 0;
+
+        if ((rx_frame->bits % 8) || length < 2 || rx_frame->bytes[length - 2] != (crc & 0xFF)
+            || rx_frame->bytes[length - 1] != ((crc >> 8) & 0xFF)) {
+            error |= RC522_PCD_CRC_ERR_BIT;
+        }
+        else {
+            rx_frame->bits -= 16; // CRC_A is not stored in the FIFO
+        }
+    }
+
+    // First received bit is stored at RxAlign position of the first byte
+    uint16_t fifo_bits = transfer->rx_align + rx_frame->bits;
+
+    memset(transfer->rx_bytes, 0, sizeof(transfer->rx_bytes));
+
+    for (uint16_t i = 0; i < rx_frame->bits; i++) {
+        uint16_t bit = transfer->rx_align + i;
+
+        transfer->rx_bytes[bit / 8] |= rc522_emulator_frame_bit(rx_frame, i) << (bit % 8);
+    }
+
+    transfer->state = RC522_EMULATOR_TRANSFER_RX;
+    transfer->rx_length = (fifo_bits + 7) / 8;
+    transfer->rx_offset = 0;
+    transfer->rx_last_bits = fifo_bits % 8;
+    transfer->rx_error = error;
+}
+
+/**
+ * Moves the frame between the FIFO and the RF interface as far as the FIFO allows
+ */
+static void rc522_emulator_transfer_step(rc522_emulator_t *emulator)
+{
+    uint8_t *regs = emulator->registers;
+    rc522_emulator_transfer_t *transfer = &emulator->transfer;
+    uint8_t water_level = regs[RC522_PCD_WATER_LEVEL_REG] & RC522_PCD_WATER_LEVEL_MASK;
+
+    if (transfer->state == RC522_EMULATOR_TRANSFER_TX) {
+        // Host is refilling the FIFO, the transmitter waits for it at the water level
+        bool streaming = regs[RC522_PCD_COM_INT_EN_REG] & RC522_PCD_LO_ALERT_IRQ_BIT;
+        uint8_t kept = streaming ? water_level : 0;
+        uint16_t length = transfer->frame.bits / 8;
+
+        // Room for CRC_A is kept, bytes above the largest frame are lost
+        while (emulator->fifo_level > kept) {
+            uint8_t value = rc522_emulator_fifo_pop(emulator);
+
+            if (length < RC522_EMULATOR_FRAME_SIZE_MAX - 2) {
+                transfer->frame.bytes[length++] = value;
+            }
+        }
+
+        transfer->frame.bits = length * 8;
+
+        if (streaming) {
+            return;
+        }
+
+        rc522_emulator_transfer_sent(emulator);
+    }
+
+    if (transfer->state == RC522_EMULATOR_TRANSFER_RX) {
+        // Host is draining the FIFO, the receiver waits for it at the water level.
+        // Otherwise the FIFO overflows when the frame does not fit into it.
+        bool streaming = regs[RC522_PCD_COM_INT_EN_REG] & RC522_PCD_HI_ALERT_IRQ_BIT;
+
+        while (transfer->rx_offset < transfer->rx_length) {
+            if (streaming && emulator->fifo_level >= RC522_EMULATOR_FIFO_SIZE - water_level) {
+                return;
+            }
+
+            rc522_emulator_fifo_push(emulator, transfer->rx_bytes[transfer->rx_offset++]);
+        }
+
+        regs[RC522_PCD_CONTROL_REG] = (regs[RC522_PCD_CONTROL_REG] & ~RC522_EMULATOR_RX_LAST_BITS_MASK)
+                                      | transfer->rx_last_bits;
+        regs[RC522_PCD_ERROR_REG] |= transfer->rx_error;
+        regs[RC522_PCD_COM_INT_REQ_REG] |= RC522_PCD_RX_IRQ_BIT | (transfer->rx_error ? RC522_PCD_ERR_IRQ_BIT : 0);
+        transfer->state = RC522_EMULATOR_TRANSFER_IDLE;
+    }
+}
+
+/**
+ * Advances the transfer after an access of the host and updates the interrupt requests
+ */
+static void rc522_emulator_update(rc522_emulator_t *emulator)
+{
+    uint8_t *regs = emulator->registers;
+    uint8_t water_level = regs[RC522_PCD_WATER_LEVEL_REG] & RC522_PCD_WATER_LEVEL_MASK;
+
+    rc522_emulator_transfer_step(emulator);
+
+    // Alert interrupts are requested as long as the alert bits of Status1Reg are set
+    if (emulator->fifo_level <= water_level) {
+        regs[RC522_PCD_COM_INT_REQ_REG] |= RC522_PCD_LO_ALERT_IRQ_BIT;
+    }
+
+    if ((RC522_EMULATOR_FIFO_SIZE - emulator->fifo_level) <= water_level) {
+        regs[RC522_PCD_COM_INT_REQ_REG] |= RC522_PCD_HI_ALERT_IRQ_BIT;
+    }
+
+    rc522_emulator_update_irq(emulator);
+}
+
+static void rc522_emulator_execute(rc522_emulator_t *emulator, uint8_t command)
+{
+    uint8_t *regs = emulator->registers;
+
+    switch (command) {
+        case RC522_PCD_SOFT_RESET_CMD:
+            rc522_emulator_reset_registers(emulator);
+            break;
+        case RC522_PCD_CALC_CRC_CMD:
+            rc522_emulator_calc_crc(emulator);
+            break;
+        case RC522_PCD_MF_AUTH_CMD:
+            rc522_emulator_authenticate(emulator);
+            break;
+        case RC522_PCD_TRANSCEIVE_CMD:
+            // Transmission is started by the StartSend bit
+            if (regs[RC522_PCD_BIT_FRAMING_REG] & RC522_PCD_START_SEND_BIT) {
+                rc522_emulator_transfer_start(emulator);
+            }
+            break;
+        case RC522_PCD_IDLE_CMD:
+        default:
+            emulator->transfer.state = RC522_EMULATOR_TRANSFER_IDLE; // Transceive is cancelled
+            // Other commands (Mem, GenerateRandomID, ...) are completed immediately
+            regs[RC522_PCD_COMMAND_REG] = (regs[RC522_PCD_COMMAND_REG] & 0xF0) | RC522_PCD_IDLE_CMD;
+            break;
+    }
+}
+
+static void rc522_emulator_write_register(rc522_emulator_t *emulator, uint8_t address, uint8_t value)
+{
+    uint8_t *regs = emulator->registers;
+
+    switch (address) {
+        case RC522_PCD_COMMAND_REG:
+            regs[address] = value & (RC522_EMULATOR_RCV_OFF_BIT | RC522_PCD_POWER_DOWN_BIT | 0x0F);
+
+            // Commands are not executed in the Soft power-down mode
+            if (!(value & RC522_PCD_POWER_DOWN_BIT)) {
+                rc522_emulator_execute(emulator, value & 0x0F);
+            }
+            break;
+        case RC522_PCD_COM_INT_REQ_REG:
+            // Set1 defines whether the marked bits are set or cleared
+            if (value & RC522_PCD_SET_1_BIT) {
+                regs[address] |= (value & 0x7F);
+            }
+            else {
+                regs[address] &= ~(value & 0x7F);
+            }
+            break;
+        case RC522_PCD_DIV_INT_REQ_REG:
+            if (value & RC522_EMULATOR_SET_2_BIT) {
+                regs[address] |= (value & 0x7F);
+            }
+            else {
+                regs[address] &= ~(value & 0x7F);
+            }
+            break;
+        case RC522_PCD_FIFO_DATA_REG:
+            rc522_emulator_fifo_push(emulator, value);
+            break;
+        case RC522_PCD_FIFO_LEVEL_REG:
+            if (value & RC522_PCD_FLUSH_BUFFER_BIT) {
+                rc522_emulator_fifo_flush(emulator);
+            }
+            break;
+        case RC522_PCD_BIT_FRAMING_REG:
+            regs[address] = value;
+
+            if ((value & RC522_PCD_START_SEND_BIT) && (regs[RC522_PCD_COMMAND_REG] & 0x0F) == RC522_PCD_TRANSCEIVE_CMD) {
+                rc522_emulator_transfer_start(emulator);
+            }
+            break;
+        case RC522_PCD_STATUS_2_REG:
+            // Crypto1On can only be cleared by software, ModemState is read-only
+            regs[address] = (value & 0xC0) | (regs[address] & value & RC522_PCD_MF_CRYPTO1_ON_BIT);
+            break;
+        case RC522_PCD_COLL_REG:
+            regs[address] = (value & RC522_PCD_VALUES_AFTER_COLL_BIT) | (regs[address] & 0x7F);
+            break;
+        case RC522_PCD_TX_CONTROL_REG: {
+            bool field_was_on = rc522_emulator_field_on(emulator);
+            regs[address] = value;
+
+            if (field_was_on && !rc522_emulator_field_on(emulator)) {
+                rc522_emulator_field_off(emulator);
+            }
+            break;
+        }
+        case RC522_PCD_CONTROL_REG:
+            // Only TStopNow and TStartNow are writable, and they read as 0
+            break;
+        case RC522_PCD_ERROR_REG:
+        case RC522_PCD_STATUS_1_REG:
+        case RC522_PCD_CRC_RESULT_MSB_REG:
+        case RC522_PCD_CRC_RESULT_LSB_REG:
+        case RC522_PCD_VERSION_REG:
+            break; // Read-only
+        default:
+            regs[address] = value;
+            break;
+    }
+
+    rc522_emulator_update_irq(emulator);
+}
+
+static uint8_t rc522_emulator_read_register(rc522_emulator_t *emulator, uint8_t address)
+{
+    switch (address) {
+        case RC522_PCD_FIFO_DATA_REG:
+            return rc522_emulator_fifo_pop(emulator);
+        case RC522_PCD_FIFO_LEVEL_REG:
+            return emulator->fifo_level;
+        case RC522_PCD_STATUS_1_REG: {
+            uint8_t water_level = emulator->registers[RC522_PCD_WATER_LEVEL_REG] & RC522_PCD_WATER_LEVEL_MASK;
+
+            return (emulator->crc_ready ? RC522_PCD_CRC_READY_BIT : 0)
+                   | (emulator->irq_asserted ? RC522_PCD_IRQ_BIT : 0)
+                   | ((RC522_EMULATOR_FIFO_SIZE - emulator->fifo_level) <= water_level ? RC522_PCD_HI_ALERT_BIT : 0)
+                   | (emulator->fifo_level <= water_level ? RC522_PCD_LO_ALERT_BIT : 0);
+        }
+        default:
+            return emulator->registers[address];
+    }
+}
+
+static esp_err_t rc522_emulator_install(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->config == NULL);
+
+    rc522_emulator_config_t *conf = (rc522_emulator_config_t *)(driver->config);
+
+    driver->irq_enabled = conf->irq;
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_emulator_send(const rc522_driver_handle_t driver, uint8_t address, const rc522_bytes_t *bytes)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK_BYTES(bytes);
+    RC522_CHECK(address >= RC522_EMULATOR_REGISTERS_COUNT);
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+
+    RC522_EMULATOR_LOCK(emulator);
+
+    for (uint8_t i = 0; i < bytes->length; i++) {
+        rc522_emulator_write_register(emulator, address, bytes->ptr[i]);
+    }
+
+    rc522_emulator_update(emulator);
+    RC522_EMULATOR_UNLOCK(emulator);
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_emulator_receive(const rc522_driver_handle_t driver, uint8_t address, rc522_bytes_t *bytes)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK_BYTES(bytes);
+    RC522_CHECK(address >= RC522_EMULATOR_REGISTERS_COUNT);
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+
+    RC522_EMULATOR_LOCK(emulator);
+
+    for (uint8_t i = 0; i < bytes->length; i++) {
+        bytes->ptr[i] = rc522_emulator_read_register(emulator, address);
+    }
+
+    rc522_emulator_update(emulator);
+    RC522_EMULATOR_UNLOCK(emulator);
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_emulator_reset(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+
+    RC522_EMULATOR_LOCK(emulator);
+    rc522_emulator_reset_registers(emulator);
+    rc522_emulator_update(emulator);
+    RC522_EMULATOR_UNLOCK(emulator);
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_emulator_uninstall(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+
+    RC522_RETURN_ON_ERROR(rc522_driver_deinit_irq_pin(driver));
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+
+    for (uint8_t i = 0; i < RC522_EMULATOR_PICC_COUNT_MAX; i++) {
+        rc522_emulator_picc_deinit(&emulator->piccs[i]);
+    }
+
+    vSemaphoreDelete(emulator->mutex);
+    free(emulator);
+    driver->device = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_emulator_create(const rc522_emulator_config_t *config, rc522_driver_handle_t *driver)
+{
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(driver == NULL);
+
+    esp_err_t ret = ESP_OK;
+
+    rc522_emulator_t *emulator = calloc(1, sizeof(rc522_emulator_t));
+    ESP_RETURN_ON_FALSE(emulator != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
+
+    emulator->mutex = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(emulator->mutex != NULL, ESP_ERR_NO_MEM, error, TAG, "nomem");
+
+    ESP_GOTO_ON_ERROR(rc522_driver_create(config, sizeof(rc522_emulator_config_t), driver), error, TAG, "nomem");
+
+    emulator->driver = *driver;
+    emulator->firmware = config->firmware ? config->firmware : RC522_PCD_FIRMWARE_20;
+    rc522_emulator_reset_registers(emulator);
+
+    (*driver)->device = emulator;
+    (*driver)->install = rc522_emulator_install;
+    (*driver)->send = rc522_emulator_send;
+    (*driver)->receive = rc522_emulator_receive;
+    (*driver)->reset = rc522_emulator_reset;
+    (*driver)->uninstall = rc522_emulator_uninstall;
+
+    return ESP_OK;
+error:
+    if (emulator->mutex) {
+        vSemaphoreDelete(emulator->mutex);
+    }
+
+    free(emulator);
+
+    return ret;
+}
+
+/**
+ * Returns the PICC in the slot, or NULL if the slot is not taken
+ */
+static rc522_emulator_picc_t *rc522_emulator_picc(const rc522_driver_handle_t driver, uint8_t index)
+{
+    if (driver == NULL || driver->device == NULL || index >= RC522_EMULATOR_PICC_COUNT_MAX) {
+        return NULL;
+    }
+
+    rc522_emulator_picc_t *picc = &rc522_emulator_from_driver(driver)->piccs[index];
+
+    return picc->used ? picc : NULL;
+}
+
+esp_err_t rc522_emulator_picc_add(
+    rc522_driver_handle_t driver, const rc522_emulator_picc_config_t *config, uint8_t *out_index)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(out_index == NULL);
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+    esp_err_t ret = ESP_ERR_NO_MEM; // No free slot
+
+    RC522_EMULATOR_LOCK(emulator);
+
+    for (uint8_t i = 0; i < RC522_EMULATOR_PICC_COUNT_MAX; i++) {
+        if (emulator->piccs[i].used) {
+            continue;
+        }
+
+        if ((ret = rc522_emulator_picc_init(&emulator->piccs[i], config)) == ESP_OK) {
+            *out_index = i;
+        }
+
+        break;
+    }
+
+    RC522_EMULATOR_UNLOCK(emulator);
+
+    return ret;
+}
+
+esp_err_t rc522_emulator_picc_remove(rc522_driver_handle_t driver, uint8_t index)
+{
+    rc522_emulator_picc_t *picc = rc522_emulator_picc(driver, index);
+    RC522_CHECK(picc == NULL);
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+
+    RC522_EMULATOR_LOCK(emulator);
+    rc522_emulator_picc_deinit(picc);
+    RC522_EMULATOR_UNLOCK(emulator);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_emulator_picc_set_in_field(rc522_driver_handle_t driver, uint8_t index, bool in_field)
+{
+    rc522_emulator_picc_t *picc = rc522_emulator_picc(driver, index);
+    RC522_CHECK(picc == NULL);
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+
+    RC522_EMULATOR_LOCK(emulator);
+
+    if (picc->in_field != in_field) {
+        picc->in_field = in_field;
+        picc->halted = false;
+        rc522_emulator_picc_reset(picc);
+    }
+
+    RC522_EMULATOR_UNLOCK(emulator);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_emulator_picc_read_memory(
+    rc522_driver_handle_t driver, uint8_t index, uint16_t offset, uint8_t *buffer, uint16_t length)
+{
+    rc522_emulator_picc_t *picc = rc522_emulator_picc(driver, index);
+    RC522_CHECK(picc == NULL);
+    RC522_CHECK(buffer == NULL);
+    RC522_CHECK((offset + length) > picc->memory_size);
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+
+    RC522_EMULATOR_LOCK(emulator);
+    memcpy(buffer, picc->memory + offset, length);
+    RC522_EMULATOR_UNLOCK(emulator);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_emulator_picc_write_memory(
+    rc522_driver_handle_t driver, uint8_t index, uint16_t offset, const uint8_t *buffer, uint16_t length)
+{
+    rc522_emulator_picc_t *picc = rc522_emulator_picc(driver, index);
+    RC522_CHECK(picc == NULL);
+    RC522_CHECK(buffer == NULL);
+    RC522_CHECK((offset + length) > picc->memory_size);
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+
+    RC522_EMULATOR_LOCK(emulator);
+    memcpy(picc->memory + offset, buffer, length);
+    RC522_EMULATOR_UNLOCK(emulator);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_emulator_get_air_time(rc522_driver_handle_t driver, uint32_t *out_us)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK(out_us == NULL);
+
+    rc522_emulator_t *emulator = rc522_emulator_from_driver(driver);
+
+    RC522_EMULATOR_LOCK(emulator);
+    *out_us = (uint32_t)(emulator->air_time_ns / 1000);
+    RC522_EMULATOR_UNLOCK(emulator);
+
+    return ESP_OK;
+}
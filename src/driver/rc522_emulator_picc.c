@@ -0,0 +1,934 @@
+#include <string.h>
+#include "rc522_types_internal.h"
+#include "rc522_crc_internal.h"
+#include "rc522_picc_internal.h"
+#include "rc522_emulator_internal.h"
+#include "rc522_isodep_internal.h"
+#include "picc/rc522_mifare.h"
+#include "picc/rc522_ntag.h"
+
+RC522_LOG_DEFINE_BASE();
+
+#define RC522_EMULATOR_PICC_NAK_INVALID_ARG (0x00) // Invalid argument or invalid operation
+#define RC522_EMULATOR_PICC_NAK_WRITE_ERROR (0x05) // EEPROM write error (NTAG), CRC error (MIFARE Classic)
+#define RC522_EMULATOR_PICC_SAK_CASCADE_BIT (0x04) // UID not complete
+#define RC522_EMULATOR_PICC_WTXM_DEFAULT    (2)    // Waiting time extension asked for by UPDATE BINARY
+#define RC522_EMULATOR_PICC_FWI             (8)    // FWI of the ATS
+
+/**
+ * Status words of the response APDUs (ISO/IEC 7816-4, section 5.1.3)
+ */
+#define RC522_EMULATOR_PICC_SW_OK                (0x9000)
+#define RC522_EMULATOR_PICC_SW_WRONG_LENGTH      (0x6700)
+#define RC522_EMULATOR_PICC_SW_WRONG_OFFSET      (0x6B00)
+#define RC522_EMULATOR_PICC_SW_INS_NOT_SUPPORTED (0x6D00)
+#define RC522_EMULATOR_PICC_SW_CLA_NOT_SUPPORTED (0x6E00)
+
+/**
+ * Commands handled by the virtual PICCs in ACTIVE state
+ */
+enum
+{
+    RC522_EMULATOR_PICC_READ_CMD = 0x30,
+    RC522_EMULATOR_PICC_MIFARE_WRITE_CMD = 0xA0,
+    RC522_EMULATOR_PICC_NTAG_WRITE_CMD = 0xA2,
+    RC522_EMULATOR_PICC_NTAG_GET_VERSION_CMD = 0x60,
+    RC522_EMULATOR_PICC_NTAG_FAST_READ_CMD = 0x3A,
+    RC522_EMULATOR_PICC_MIFARE_AUTH_KEY_A_CMD = 0x60,
+    RC522_EMULATOR_PICC_MIFARE_AUTH_KEY_B_CMD = 0x61,
+};
+
+/**
+ * Instructions of the APDUs handled by the ISO/IEC 14443-4 PICC
+ */
+enum
+{
+    RC522_EMULATOR_PICC_SELECT_INS = 0xA4,
+    RC522_EMULATOR_PICC_READ_BINARY_INS = 0xB0,
+    RC522_EMULATOR_PICC_UPDATE_BINARY_INS = 0xD6,
+};
+
+typedef struct
+{
+    uint8_t atqa[2];
+    uint8_t sak;
+    uint16_t memory_size;
+    uint8_t ntag_capacity; /*<! Capability Container byte 2 (data area size / 8), 0 for MIFARE Classic */
+    uint8_t ntag_storage;  /*<! Storage size byte of GET_VERSION response, 0 if not supported */
+    bool isodep;           /*<! PICC answers RATS and speaks ISO/IEC 14443-4 after it */
+} rc522_emulator_picc_desc_t;
+
+static const rc522_emulator_picc_desc_t rc522_emulator_picc_descs[] = {
+    [RC522_EMULATOR_PICC_MIFARE_1K] = { .atqa = { 0x04, 0x00 }, .sak = 0x08, .memory_size = 1024 },
+    [RC522_EMULATOR_PICC_MIFARE_4K] = { .atqa = { 0x02, 0x00 }, .sak = 0x18, .memory_size = 4096 },
+    [RC522_EMULATOR_PICC_MIFARE_UL] = { .atqa = { 0x44, 0x00 }, .sak = 0x00, .memory_size = 16 * 4, .ntag_capacity = 0x06 },
+    [RC522_EMULATOR_PICC_NTAG213] = { .atqa = { 0x44, 0x00 }, .sak = 0x00, .memory_size = 45 * 4, .ntag_capacity = 0x12, .ntag_storage = 0x0F },
+    [RC522_EMULATOR_PICC_NTAG215] = { .atqa = { 0x44, 0x00 }, .sak = 0x00, .memory_size = 135 * 4, .ntag_capacity = 0x3E, .ntag_storage = 0x11 },
+    [RC522_EMULATOR_PICC_NTAG216] = { .atqa = { 0x44, 0x00 }, .sak = 0x00, .memory_size = 231 * 4, .ntag_capacity = 0x6D, .ntag_storage = 0x13 },
+    [RC522_EMULATOR_PICC_ISO_14443_4] = { .atqa = { 0x04, 0x00 }, .sak = 0x20, .memory_size = 2048, .isodep = true },
+};
+
+/**
+ * FSC of 256 bytes, FWI 8 (77 ms), SFGI 0, CID supported, bit rates up to 848 kbit/s
+ * in both directions (not necessarily the same), and a single historical byte (category indicator)
+ */
+static const uint8_t rc522_emulator_picc_ats[] = { 0x06, 0x78, 0x77, 0x80, 0x02, 0x80 };
+
+inline static bool rc522_emulator_picc_is_mifare_classic(const rc522_emulator_picc_t *picc)
+{
+    return picc->type == RC522_EMULATOR_PICC_MIFARE_1K || picc->type == RC522_EMULATOR_PICC_MIFARE_4K;
+}
+
+inline static bool rc522_emulator_picc_is_isodep(const rc522_emulator_picc_t *picc)
+{
+    return rc522_emulator_picc_descs[picc->type].isodep;
+}
+
+inline static uint8_t rc522_emulator_picc_cascade_levels(const rc522_emulator_picc_t *picc)
+{
+    return picc->uid_length == 4 ? 1 : (picc->uid_length == 7 ? 2 : 3);
+}
+
+/**
+ * UID CLn of the cascade level (ISO/IEC 14443-3, section 6.5.4): 3 or 4 bytes
+ * of the UID, preceded by the Cascade Tag if the UID is not complete, and BCC
+ */
+static void rc522_emulator_picc_cascade_level_data(const rc522_emulator_picc_t *picc, uint8_t level, uint8_t out_data[5])
+{
+    bool last_level = (level + 1) == rc522_emulator_picc_cascade_levels(picc);
+
+    if (last_level) {
+        memcpy(out_data, picc->uid + (level * 3), 4);
+    }
+    else {
+        out_data[0] = RC522_PICC_CMD_CT;
+        memcpy(out_data + 1, picc->uid + (level * 3), 3);
+    }
+
+    out_data[4] = out_data[0] ^ out_data[1] ^ out_data[2] ^ out_data[3];
+}
+
+static uint8_t rc522_emulator_picc_sector_of_block(uint8_t block_address)
+{
+    return block_address < 128 ? (block_address / 4) : (32 + ((block_address - 128) / 16));
+}
+
+static uint8_t rc522_emulator_picc_sector_trailer(uint8_t sector)
+{
+    return sector < 32 ? (sector * 4 + 3) : (128 + (sector - 32) * 16 + 15);
+}
+
+static void rc522_emulator_picc_set_bytes(rc522_emulator_frame_t *frame, const uint8_t *bytes, uint8_t length)
+{
+    memcpy(frame->bytes, bytes, length);
+    frame->bits = length * 8;
+}
+
+static rc522_pcd_crc_t rc522_emulator_picc_crc(const uint8_t *bytes, uint8_t length)
+{
+    uint8_t buffer[RC522_EMULATOR_FRAME_SIZE_MAX];
+    rc522_pcd_crc_t crc = { 0 };
+
+    memcpy(buffer, bytes, length);
+    rc522_crc_a(&(rc522_bytes_t) { .ptr = buffer, .length = length }, &crc);
+
+    return crc;
+}
+
+static void rc522_emulator_picc_set_bytes_with_crc(rc522_emulator_frame_t *frame, const uint8_t *bytes, uint8_t length)
+{
+    rc522_pcd_crc_t crc = rc522_emulator_picc_crc(bytes, length);
+
+    memmove(frame->bytes, bytes, length);
+    frame->bytes[length] = crc.lsb;
+    frame->bytes[length + 1] = crc.msb;
+    frame->bits = (length + 2) * 8;
+}
+
+static void rc522_emulator_picc_set_ack_nak(rc522_emulator_frame_t *frame, uint8_t value)
+{
+    frame->bytes[0] = value & 0x0F;
+    frame->bits = 4;
+}
+
+/**
+ * Checks that the frame consists of whole bytes and ends with valid CRC_A
+ */
+static bool rc522_emulator_picc_frame_crc_valid(const rc522_emulator_frame_t *frame, uint8_t expected_length)
+{
+    if ((frame->bits % 8) != 0 || (frame->bits / 8) != (expected_length + 2)) {
+        return false;
+    }
+
+    rc522_pcd_crc_t crc = rc522_emulator_picc_crc(frame->bytes, expected_length);
+
+    return frame->bytes[expected_length] == crc.lsb && frame->bytes[expected_length + 1] == crc.msb;
+}
+
+static void rc522_emulator_picc_init_mifare_classic(rc522_emulator_picc_t *picc)
+{
+    const rc522_emulator_picc_desc_t *desc = &rc522_emulator_picc_descs[picc->type];
+    uint8_t *block_0 = picc->memory;
+
+    // Manufacturer block
+    memcpy(block_0, picc->uid, picc->uid_length);
+
+    if (picc->uid_length == 4) {
+        block_0[4] = picc->uid[0] ^ picc->uid[1] ^ picc->uid[2] ^ picc->uid[3];
+        block_0[5] = desc->sak;
+        block_0[6] = desc->atqa[1];
+        block_0[7] = desc->atqa[0];
+    }
+    else {
+        block_0[7] = desc->sak;
+        block_0[8] = desc->atqa[1];
+        block_0[9] = desc->atqa[0];
+    }
+
+    // Transport configuration: default keys, access bits FF 07 80 and GPB 69
+    const uint8_t trailer[RC522_MIFARE_BLOCK_SIZE] = {
+        RC522_MIFARE_KEY_VALUE_DEFAULT,
+        0xFF,
+        0x07,
+        0x80,
+        0x69,
+        RC522_MIFARE_KEY_VALUE_DEFAULT,
+    };
+
+    uint16_t blocks = picc->memory_size / RC522_MIFARE_BLOCK_SIZE;
+
+    for (uint16_t sector = 0; sector <= rc522_emulator_picc_sector_of_block(blocks - 1); sector++) {
+        memcpy(picc->memory + rc522_emulator_picc_sector_trailer(sector) * RC522_MIFARE_BLOCK_SIZE,
+            trailer,
+            sizeof(trailer));
+    }
+}
+
+static void rc522_emulator_picc_init_ntag(rc522_emulator_picc_t *picc)
+{
+    const rc522_emulator_picc_desc_t *desc = &rc522_emulator_picc_descs[picc->type];
+    const uint8_t *uid = picc->uid;
+    uint8_t *memory = picc->memory;
+
+    // Serial number and check bytes (pages 0-2), Capability Container (page 3)
+    // and empty NDEF message followed by the Terminator TLV (page 4)
+    const uint8_t pages[] = {
+        uid[0], uid[1], uid[2], (RC522_PICC_CMD_CT ^ uid[0] ^ uid[1] ^ uid[2]),
+        uid[3], uid[4], uid[5], uid[6],
+        (uid[3] ^ uid[4] ^ uid[5] ^ uid[6]), 0x48, 0x00, 0x00,
+        0xE1, 0x10, desc->ntag_capacity, 0x00,
+        0x03, 0x00, 0xFE, 0x00,
+    };
+
+    memcpy(memory, pages, sizeof(pages));
+}
+
+esp_err_t rc522_emulator_picc_init(rc522_emulator_picc_t *picc, const rc522_emulator_picc_config_t *config)
+{
+    RC522_CHECK(picc == NULL);
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(config->type > RC522_EMULATOR_PICC_ISO_14443_4);
+    RC522_CHECK(config->uid_length != 4 && config->uid_length != 7 && config->uid_length != 10);
+    RC522_CHECK(config->type >= RC522_EMULATOR_PICC_MIFARE_UL && config->type <= RC522_EMULATOR_PICC_NTAG216
+                && config->uid_length != 7);
+    RC522_CHECK(config->wtxm > RC522_ISODEP_WTXM_MAX);
+
+    memset(picc, 0, sizeof(rc522_emulator_picc_t));
+
+    picc->memory_size = rc522_emulator_picc_descs[config->type].memory_size;
+    picc->memory = calloc(1, picc->memory_size);
+    ESP_RETURN_ON_FALSE(picc->memory != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
+
+    picc->used = true;
+    picc->in_field = true;
+    picc->type = config->type;
+    picc->uid_length = config->uid_length;
+    memcpy(picc->uid, config->uid, config->uid_length);
+    picc->wtxm = config->wtxm != 0 ? config->wtxm : RC522_EMULATOR_PICC_WTXM_DEFAULT;
+
+    // 106 kbit/s is always supported
+    for (uint16_t kbps = 212; picc->speed_limit < 3; kbps *= 2) {
+        if (config->max_bitrate_kbps != 0 && config->max_bitrate_kbps < kbps) {
+            break;
+        }
+
+        picc->speed_limit++;
+    }
+
+    if (rc522_emulator_picc_is_mifare_classic(picc)) {
+        rc522_emulator_picc_init_mifare_classic(picc);
+    }
+    else if (!rc522_emulator_picc_is_isodep(picc)) {
+        rc522_emulator_picc_init_ntag(picc);
+    }
+
+    rc522_emulator_picc_reset(picc);
+
+    return ESP_OK;
+}
+
+void rc522_emulator_picc_deinit(rc522_emulator_picc_t *picc)
+{
+    if (picc->memory) {
+        free(picc->memory);
+    }
+
+    memset(picc, 0, sizeof(rc522_emulator_picc_t));
+    rc522_emulator_picc_reset(picc);
+}
+
+void rc522_emulator_picc_reset(rc522_emulator_picc_t *picc)
+{
+    picc->state = picc->halted ? RC522_EMULATOR_PICC_STATE_HALT : RC522_EMULATOR_PICC_STATE_IDLE;
+    picc->cascade_level = 0;
+    picc->auth_sector = -1;
+    picc->pending_write = -1;
+    picc->response_delay_ns = 0;
+    picc->busy_until_ns = 0;
+    memset(&picc->isodep, 0, sizeof(rc522_emulator_isodep_t));
+}
+
+/**
+ * REQA and WUPA (ISO/IEC 14443-3, section 6.3)
+ */
+static bool rc522_emulator_picc_request(
+    rc522_emulator_picc_t *picc, uint8_t command, rc522_emulator_frame_t *out_response)
+{
+    bool wakes_up = picc->state == RC522_EMULATOR_PICC_STATE_IDLE
+                    || (command == RC522_PICC_CMD_WUPA && picc->state == RC522_EMULATOR_PICC_STATE_HALT);
+
+    if (!wakes_up) {
+        if (picc->state != RC522_EMULATOR_PICC_STATE_HALT) {
+            rc522_emulator_picc_reset(picc);
+        }
+
+        return false;
+    }
+
+    picc->state = RC522_EMULATOR_PICC_STATE_READY;
+    picc->cascade_level = 0;
+
+    const rc522_emulator_picc_desc_t *desc = &rc522_emulator_picc_descs[picc->type];
+
+    // Bits 8-7 of ATQA code the UID size
+    uint8_t uid_size = rc522_emulator_picc_cascade_levels(picc) - 1;
+    uint8_t atqa[2] = { (uint8_t)((desc->atqa[0] & 0x3F) | (uid_size << 6)), desc->atqa[1] };
+
+    rc522_emulator_picc_set_bytes(out_response, atqa, sizeof(atqa));
+
+    return true;
+}
+
+/**
+ * ANTICOLLISION and SELECT of the current cascade level (ISO/IEC 14443-3, section 6.4.3)
+ */
+static bool rc522_emulator_picc_anticollision_or_select(
+    rc522_emulator_picc_t *picc, const rc522_emulator_frame_t *frame, rc522_emulator_frame_t *out_response)
+{
+    uint8_t sel = frame->bytes[0];
+    uint8_t nvb = frame->bytes[1];
+    uint8_t nvb_bytes = nvb >> 4;
+    uint8_t nvb_bits = nvb & 0x0F;
+
+    if (frame->bits < 16 || sel != (RC522_PICC_CMD_SEL_CL1 + 2 * picc->cascade_level)) {
+        rc522_emulator_picc_reset(picc);
+        return false;
+    }
+
+    uint8_t data[5];
+    rc522_emulator_picc_cascade_level_data(picc, picc->cascade_level, data);
+
+    if (nvb == 0x70) {
+        if (!rc522_emulator_picc_frame_crc_valid(frame, 7) || memcmp(frame->bytes + 2, data, sizeof(data)) != 0) {
+            return false; // Not selected, stays in READY
+        }
+
+        const rc522_emulator_picc_desc_t *desc = &rc522_emulator_picc_descs[picc->type];
+        uint8_t sak = RC522_EMULATOR_PICC_SAK_CASCADE_BIT;
+
+        if ((picc->cascade_level + 1) < rc522_emulator_picc_cascade_levels(picc)) {
+            picc->cascade_level++;
+        }
+        else {
+            sak = desc->sak;
+            picc->state = RC522_EMULATOR_PICC_STATE_ACTIVE;
+        }
+
+        rc522_emulator_picc_set_bytes_with_crc(out_response, &sak, 1);
+
+        return true;
+    }
+
+    uint16_t known_bits = ((nvb_bytes - 2) * 8) + nvb_bits;
+
+    if (nvb_bytes < 2 || nvb_bits > 7 || known_bits >= (8 * sizeof(data)) || frame->bits != (16 + known_bits)) {
+        rc522_emulator_picc_reset(picc);
+        return false;
+    }
+
+    rc522_emulator_frame_t uid_cln = { .bits = 8 * sizeof(data) };
+    memcpy(uid_cln.bytes, data, sizeof(data));
+
+    // Only PICCs with matching UID bits respond
+    for (uint16_t i = 0; i < known_bits; i++) {
+        if (rc522_emulator_frame_bit(frame, 16 + i) != rc522_emulator_frame_bit(&uid_cln, i)) {
+            return false;
+        }
+    }
+
+    // The rest of the UID CLn, starting with the first unknown bit
+    memset(out_response, 0, sizeof(rc522_emulator_frame_t));
+    out_response->bits = uid_cln.bits - known_bits;
+
+    for (uint16_t i = 0; i < out_response->bits; i++) {
+        rc522_emulator_frame_set_bit(out_response, i, rc522_emulator_frame_bit(&uid_cln, known_bits + i));
+    }
+
+    return true;
+}
+
+static bool rc522_emulator_picc_mifare_classic_receive(
+    rc522_emulator_picc_t *picc, const rc522_emulator_frame_t *frame, rc522_emulator_frame_t *out_response)
+{
+    uint16_t blocks = picc->memory_size / RC522_MIFARE_BLOCK_SIZE;
+
+    if (picc->pending_write >= 0) {
+        uint8_t block_address = picc->pending_write;
+        picc->pending_write = -1;
+
+        if (!rc522_emulator_picc_frame_crc_valid(frame, RC522_MIFARE_BLOCK_SIZE)) {
+            rc522_emulator_picc_set_ack_nak(out_response, RC522_EMULATOR_PICC_NAK_WRITE_ERROR);
+            return true;
+        }
+
+        memcpy(picc->memory + block_address * RC522_MIFARE_BLOCK_SIZE, frame->bytes, RC522_MIFARE_BLOCK_SIZE);
+        rc522_emulator_picc_set_ack_nak(out_response, RC522_MIFARE_ACK);
+
+        return true;
+    }
+
+    if (!rc522_emulator_picc_frame_crc_valid(frame, 2)) {
+        rc522_emulator_picc_reset(picc);
+        return false;
+    }
+
+    uint8_t command = frame->bytes[0];
+    uint8_t block_address = frame->bytes[1];
+
+    if (block_address >= blocks || rc522_emulator_picc_sector_of_block(block_address) != picc->auth_sector) {
+        rc522_emulator_picc_set_ack_nak(out_response, RC522_EMULATOR_PICC_NAK_INVALID_ARG);
+        return true;
+    }
+
+    uint8_t *block = picc->memory + block_address * RC522_MIFARE_BLOCK_SIZE;
+
+    switch (command) {
+        case RC522_EMULATOR_PICC_READ_CMD: {
+            uint8_t buffer[RC522_MIFARE_BLOCK_SIZE];
+            memcpy(buffer, block, sizeof(buffer));
+
+            // Key A of the sector trailer is never readable
+            if (block_address == rc522_emulator_picc_sector_trailer(picc->auth_sector)) {
+                memset(buffer, 0x00, RC522_MIFARE_KEY_SIZE);
+            }
+
+            rc522_emulator_picc_set_bytes_with_crc(out_response, buffer, sizeof(buffer));
+            return true;
+        }
+        case RC522_EMULATOR_PICC_MIFARE_WRITE_CMD:
+            if (block_address == 0) { // Manufacturer block
+                rc522_emulator_picc_set_ack_nak(out_response, RC522_EMULATOR_PICC_NAK_INVALID_ARG);
+                return true;
+            }
+
+            picc->pending_write = block_address;
+            rc522_emulator_picc_set_ack_nak(out_response, RC522_MIFARE_ACK);
+            return true;
+        default:
+            rc522_emulator_picc_set_ack_nak(out_response, RC522_EMULATOR_PICC_NAK_INVALID_ARG);
+            return true;
+    }
+}
+
+static bool rc522_emulator_picc_ntag_receive(
+    rc522_emulator_picc_t *picc, const rc522_emulator_frame_t *frame, rc522_emulator_frame_t *out_response)
+{
+    const rc522_emulator_picc_desc_t *desc = &rc522_emulator_picc_descs[picc->type];
+    uint16_t pages = picc->memory_size / NTAG_PAGE_SIZE;
+    uint8_t command = frame->bits >= 8 ? frame->bytes[0] : 0x00;
+
+    if (command == RC522_EMULATOR_PICC_READ_CMD && rc522_emulator_picc_frame_crc_valid(frame, 2)) {
+        uint8_t page = frame->bytes[1];
+
+        if (page >= pages) {
+            rc522_emulator_picc_set_ack_nak(out_response, RC522_EMULATOR_PICC_NAK_INVALID_ARG);
+            return true;
+        }
+
+        // Four pages, rolling over to the page 0 at the end of the memory
+        uint8_t buffer[NTAG_PAGE_READ_SIZE];
+
+        for (uint8_t i = 0; i < (NTAG_PAGE_READ_SIZE / NTAG_PAGE_SIZE); i++) {
+            memcpy(buffer + i * NTAG_PAGE_SIZE,
+                picc->memory + ((page + i) % pages) * NTAG_PAGE_SIZE,
+                NTAG_PAGE_SIZE);
+        }
+
+        rc522_emulator_picc_set_bytes_with_crc(out_response, buffer, sizeof(buffer));
+        return true;
+    }
+
+    // Supported by the PICCs with GET_VERSION only (NTAG21x), not by the original MIFARE Ultralight
+    if (command == RC522_EMULATOR_PICC_NTAG_FAST_READ_CMD && desc->ntag_storage != 0
+        && rc522_emulator_picc_frame_crc_valid(frame, 3)) {
+        uint8_t start_page = frame->bytes[1];
+        uint8_t end_page = frame->bytes[2];
+        uint16_t length = (end_page - start_page + 1) * NTAG_PAGE_SIZE;
+
+        // Longer responses do not fit into the frame of the emulator
+        if (start_page > end_page || end_page >= pages || length > RC522_EMULATOR_FRAME_SIZE_MAX - 2) {
+            rc522_emulator_picc_set_ack_nak(out_response, RC522_EMULATOR_PICC_NAK_INVALID_ARG);
+            return true;
+        }
+
+        rc522_emulator_picc_set_bytes_with_crc(out_response, picc->memory + start_page * NTAG_PAGE_SIZE, length);
+        return true;
+    }
+
+    if (command == RC522_EMULATOR_PICC_NTAG_WRITE_CMD && rc522_emulator_picc_frame_crc_valid(frame, 2 + NTAG_PAGE_SIZE)) {
+        uint8_t page = frame->bytes[1];
+        uint8_t *memory = picc->memory + page * NTAG_PAGE_SIZE;
+
+        // Serial number pages are read-only
+        if (page < 2 || page >= pages) {
+            rc522_emulator_picc_set_ack_nak(out_response, RC522_EMULATOR_PICC_NAK_INVALID_ARG);
+            return true;
+        }
+
+        for (uint8_t i = 0; i < NTAG_PAGE_SIZE; i++) {
+            // Lock bytes and Capability Container are one-time programmable
+            memory[i] = (page == 2 || page == 3) ? (memory[i] | frame->bytes[2 + i]) : frame->bytes[2 + i];
+        }
+
+        rc522_emulator_picc_set_ack_nak(out_response, RC522_MIFARE_ACK);
+        return true;
+    }
+
+    if (command == RC522_EMULATOR_PICC_NTAG_GET_VERSION_CMD && desc->ntag_storage != 0
+        && rc522_emulator_picc_frame_crc_valid(frame, 1)) {
+        const uint8_t version[] = { 0x00, 0x04, 0x04, 0x02, 0x01, 0x00, desc->ntag_storage, 0x03 };
+
+        rc522_emulator_picc_set_bytes_with_crc(out_response, version, sizeof(version));
+        return true;
+    }
+
+    rc522_emulator_picc_reset(picc);
+
+    return false;
+}
+
+/**
+ * Sends the block and keeps it, so that it can be sent again
+ */
+static bool rc522_emulator_picc_isodep_send(
+    rc522_emulator_picc_t *picc, const uint8_t *block, uint8_t length, rc522_emulator_frame_t *out_response)
+{
+    memcpy(picc->isodep.last_block, block, length);
+    picc->isodep.last_block_length = length;
+
+    rc522_emulator_picc_set_bytes_with_crc(out_response, block, length);
+
+    return true;
+}
+
+static bool rc522_emulator_picc_isodep_send_last(rc522_emulator_picc_t *picc, rc522_emulator_frame_t *out_response)
+{
+    if (picc->isodep.last_block_length == 0) {
+        return false;
+    }
+
+    rc522_emulator_picc_set_bytes_with_crc(out_response, picc->isodep.last_block, picc->isodep.last_block_length);
+
+    return true;
+}
+
+/**
+ * Sends the next part of the response APDU, chained if it does not fit into one block
+ */
+static bool rc522_emulator_picc_isodep_send_response(rc522_emulator_picc_t *picc, rc522_emulator_frame_t *out_response)
+{
+    rc522_emulator_isodep_t *isodep = &picc->isodep;
+    uint8_t block[RC522_EMULATOR_FRAME_SIZE_MAX];
+    uint16_t inf_size = isodep->fsd - 3; // PCB and CRC_A
+    uint16_t remaining = isodep->response_length - isodep->response_offset;
+    uint16_t chunk = remaining < inf_size ? remaining : inf_size;
+
+    block[0] = RC522_ISODEP_PCB_I_BLOCK | isodep->block_number;
+    block[0] |= chunk < remaining ? RC522_ISODEP_PCB_CHAINING_BIT : 0;
+    memcpy(block + 1, isodep->response + isodep->response_offset, chunk);
+    isodep->response_offset += chunk;
+
+    return rc522_emulator_picc_isodep_send(picc, block, chunk + 1, out_response);
+}
+
+/**
+ * Executes the command APDU of the transparent file
+ *
+ * @return true if the execution takes long, so the PICC asks for a waiting time extension first
+ */
+static bool rc522_emulator_picc_isodep_execute(rc522_emulator_picc_t *picc)
+{
+    rc522_emulator_isodep_t *isodep = &picc->isodep;
+    const uint8_t *apdu = isodep->command;
+    uint16_t length = isodep->command_length;
+    uint16_t offset = length >= 4 ? (((apdu[2] & 0x7F) << 8) | apdu[3]) : 0;
+    uint16_t data_length = 0;
+    uint16_t sw = RC522_EMULATOR_PICC_SW_OK;
+    bool wtx = false;
+
+    if (length < 4) {
+        sw = RC522_EMULATOR_PICC_SW_WRONG_LENGTH;
+    }
+    else if (apdu[0] != 0x00) {
+        sw = RC522_EMULATOR_PICC_SW_CLA_NOT_SUPPORTED;
+    }
+    else {
+        switch (apdu[1]) {
+            case RC522_EMULATOR_PICC_SELECT_INS:
+                break;
+            case RC522_EMULATOR_PICC_READ_BINARY_INS: {
+                uint16_t le = (length == 5 && apdu[4] != 0) ? apdu[4] : 256;
+
+                if (length != 5) {
+                    sw = RC522_EMULATOR_PICC_SW_WRONG_LENGTH;
+                }
+                else if (offset >= picc->memory_size) {
+                    sw = RC522_EMULATOR_PICC_SW_WRONG_OFFSET;
+                }
+                else {
+                    data_length = (picc->memory_size - offset) < le ? (picc->memory_size - offset) : le;
+                    memcpy(isodep->response, picc->memory + offset, data_length);
+                }
+                break;
+            }
+            case RC522_EMULATOR_PICC_UPDATE_BINARY_INS: {
+                uint8_t lc = length >= 5 ? apdu[4] : 0;
+
+                if (lc == 0 || length != (5 + lc)) {
+                    sw = RC522_EMULATOR_PICC_SW_WRONG_LENGTH;
+                }
+                else if ((offset + lc) > picc->memory_size) {
+                    sw = RC522_EMULATOR_PICC_SW_WRONG_OFFSET;
+                }
+                else {
+                    memcpy(picc->memory + offset, apdu + 5, lc);
+                    wtx = true; // EEPROM write
+                }
+                break;
+            }
+            default:
+                sw = RC522_EMULATOR_PICC_SW_INS_NOT_SUPPORTED;
+                break;
+        }
+    }
+
+    isodep->response[data_length] = (sw >> 8) & 0xFF;
+    isodep->response[data_length + 1] = sw & 0xFF;
+    isodep->response_length = data_length + 2;
+    isodep->response_offset = 0;
+    isodep->command_length = 0;
+
+    return wtx;
+}
+
+/**
+ * RATS (ISO/IEC 14443-4, section 5.1), which moves the PICC into the ISO-DEP protocol
+ */
+static bool rc522_emulator_picc_isodep_rats(
+    rc522_emulator_picc_t *picc, const rc522_emulator_frame_t *frame, rc522_emulator_frame_t *out_response)
+{
+    rc522_emulator_isodep_t *isodep = &picc->isodep;
+    uint8_t param = frame->bytes[1];
+    uint16_t fsd = rc522_isodep_frame_size(param >> 4);
+
+    memset(isodep, 0, sizeof(rc522_emulator_isodep_t));
+
+    isodep->active = true;
+    isodep->pps_allowed = true;
+    isodep->cid = param & 0x0F;
+    isodep->block_number = 1; // Rule C
+    isodep->fsd = fsd < RC522_EMULATOR_FRAME_SIZE_MAX ? fsd : RC522_EMULATOR_FRAME_SIZE_MAX;
+
+    rc522_emulator_picc_set_bytes_with_crc(out_response, rc522_emulator_picc_ats, sizeof(rc522_emulator_picc_ats));
+
+    return true;
+}
+
+/**
+ * PPS (ISO/IEC 14443-4, section 5.3). New bit rates apply from the next frame,
+ * the response is still sent at the current one.
+ */
+static bool rc522_emulator_picc_isodep_pps(
+    rc522_emulator_picc_t *picc, const uint8_t *pps, uint8_t length, rc522_emulator_frame_t *out_response)
+{
+    bool pps1 = length >= 2 && (pps[1] & 0x10);
+
+    if (length < 2 || (pps[0] & 0x0F) != picc->isodep.cid || length != (pps1 ? 3 : 2) || (pps1 && (pps[2] & 0xF0))) {
+        return false;
+    }
+
+    rc522_emulator_picc_set_bytes_with_crc(out_response, pps, 1);
+
+    if (pps1) {
+        picc->isodep.dsi = (pps[2] >> 2) & 0x03;
+        picc->isodep.dri = pps[2] & 0x03;
+    }
+
+    return true;
+}
+
+/**
+ * Block received in the ISO-DEP protocol (ISO/IEC 14443-4, section 7). Invalid blocks are ignored.
+ */
+static bool rc522_emulator_picc_isodep_receive(
+    rc522_emulator_picc_t *picc, const rc522_emulator_frame_t *frame, rc522_emulator_frame_t *out_response)
+{
+    rc522_emulator_isodep_t *isodep = &picc->isodep;
+    uint16_t length = frame->bits / 8;
+
+    if (length < 3 || !rc522_emulator_picc_frame_crc_valid(frame, length - 2)) {
+        return false;
+    }
+
+    length -= 2;
+
+    const uint8_t *bytes = frame->bytes;
+    uint8_t pcb = bytes[0];
+    uint8_t inf = 1;
+    bool pps_allowed = isodep->pps_allowed;
+
+    isodep->pps_allowed = false;
+
+    if (pps_allowed && (pcb & 0xF0) == RC522_ISODEP_PPSS) {
+        return rc522_emulator_picc_isodep_pps(picc, bytes, length, out_response);
+    }
+
+    if (pcb & RC522_ISODEP_PCB_CID_BIT) {
+        if (length < 2 || (bytes[1] & 0x0F) != isodep->cid) {
+            return false;
+        }
+
+        inf++;
+    }
+
+    // I-block
+    if ((pcb & 0xE2) == RC522_ISODEP_PCB_I_BLOCK) {
+        inf += (pcb & RC522_ISODEP_PCB_NAD_BIT) ? 1 : 0;
+
+        if (length < inf || (isodep->command_length + length - inf) > RC522_EMULATOR_APDU_SIZE_MAX) {
+            return false;
+        }
+
+        // Rule D, the block number follows the one of the PCD
+        isodep->block_number = pcb & RC522_ISODEP_PCB_BLOCK_NUMBER_BIT;
+        memcpy(isodep->command + isodep->command_length, bytes + inf, length - inf);
+        isodep->command_length += length - inf;
+
+        if (pcb & RC522_ISODEP_PCB_CHAINING_BIT) {
+            uint8_t ack = RC522_ISODEP_PCB_R_BLOCK | isodep->block_number;
+
+            return rc522_emulator_picc_isodep_send(picc, &ack, 1, out_response);
+        }
+
+        if (rc522_emulator_picc_isodep_execute(picc)) {
+            const uint8_t wtx[] = { RC522_ISODEP_PCB_S_WTX, picc->wtxm };
+
+            isodep->wtx_pending = true;
+
+            return rc522_emulator_picc_isodep_send(picc, wtx, sizeof(wtx), out_response);
+        }
+
+        return rc522_emulator_picc_isodep_send_response(picc, out_response);
+    }
+
+    // R-block
+    if ((pcb & 0xE6) == RC522_ISODEP_PCB_R_BLOCK) {
+        // Rule 11, the block has been lost
+        if ((pcb & RC522_ISODEP_PCB_BLOCK_NUMBER_BIT) == isodep->block_number) {
+            return rc522_emulator_picc_isodep_send_last(picc, out_response);
+        }
+
+        // Rule 12, R(NAK) of a block which has not been received
+        if (pcb & RC522_ISODEP_PCB_NAK_BIT) {
+            uint8_t ack = RC522_ISODEP_PCB_R_BLOCK | isodep->block_number;
+
+            return rc522_emulator_picc_isodep_send(picc, &ack, 1, out_response);
+        }
+
+        // Rule E and 13, R(ACK) of the chained block
+        if (isodep->response_offset < isodep->response_length) {
+            isodep->block_number ^= RC522_ISODEP_PCB_BLOCK_NUMBER_BIT;
+
+            return rc522_emulator_picc_isodep_send_response(picc, out_response);
+        }
+
+        return false;
+    }
+
+    if ((pcb & RC522_ISODEP_PCB_S_MASK) == RC522_ISODEP_PCB_S_DESELECT && length == inf) {
+        rc522_emulator_picc_set_bytes_with_crc(out_response, bytes, length);
+
+        picc->halted = true;
+        rc522_emulator_picc_reset(picc);
+
+        return true;
+    }
+
+    if ((pcb & RC522_ISODEP_PCB_S_MASK) == RC522_ISODEP_PCB_S_WTX && length > inf && isodep->wtx_pending) {
+        isodep->wtx_pending = false;
+
+        // EEPROM write takes all but one FWT of the extended waiting time
+        picc->response_delay_ns = (uint64_t)(picc->wtxm - 1) * rc522_isodep_time_us(RC522_EMULATOR_PICC_FWI) * 1000;
+
+        return rc522_emulator_picc_isodep_send_response(picc, out_response);
+    }
+
+    return false;
+}
+
+/**
+ * Frame that has been received at the bit rate of the PICC
+ */
+static bool rc522_emulator_picc_receive_at_speed(rc522_emulator_picc_t *picc, const rc522_emulator_frame_t *frame,
+    bool encrypted, rc522_emulator_frame_t *out_response)
+{
+    // Crypto1 session exists on both sides or on none,
+    // otherwise the PICC receives garbage
+    if (encrypted != (picc->auth_sector >= 0)) {
+        if (picc->state != RC522_EMULATOR_PICC_STATE_HALT) {
+            rc522_emulator_picc_reset(picc);
+        }
+
+        return false;
+    }
+
+    // Short frame, ignored in the ISO-DEP protocol
+    if (frame->bits == 7) {
+        if (picc->isodep.active) {
+            return false;
+        }
+
+        uint8_t command = frame->bytes[0] & 0x7F;
+
+        if (command == RC522_PICC_CMD_REQA || command == RC522_PICC_CMD_WUPA) {
+            return rc522_emulator_picc_request(picc, command, out_response);
+        }
+
+        return false;
+    }
+
+    switch (picc->state) {
+        case RC522_EMULATOR_PICC_STATE_READY:
+            return rc522_emulator_picc_anticollision_or_select(picc, frame, out_response);
+
+        case RC522_EMULATOR_PICC_STATE_ACTIVE:
+            if (picc->isodep.active) {
+                return rc522_emulator_picc_isodep_receive(picc, frame, out_response);
+            }
+
+            if (picc->pending_write < 0 && frame->bytes[0] == RC522_PICC_CMD_HLTA
+                && rc522_emulator_picc_frame_crc_valid(frame, 2) && frame->bytes[1] == 0x00) {
+                picc->halted = true;
+                rc522_emulator_picc_reset(picc);
+
+                return false; // HLTA is never acknowledged
+            }
+
+            if (rc522_emulator_picc_is_isodep(picc)) {
+                if (frame->bytes[0] == RC522_PICC_CMD_RATS && rc522_emulator_picc_frame_crc_valid(frame, 2)) {
+                    return rc522_emulator_picc_isodep_rats(picc, frame, out_response);
+                }
+
+                rc522_emulator_picc_reset(picc);
+                return false;
+            }
+
+            if (rc522_emulator_picc_is_mifare_classic(picc)) {
+                if (picc->auth_sector < 0) {
+                    rc522_emulator_picc_reset(picc);
+                    return false;
+                }
+
+                return rc522_emulator_picc_mifare_classic_receive(picc, frame, out_response);
+            }
+
+            return rc522_emulator_picc_ntag_receive(picc, frame, out_response);
+
+        case RC522_EMULATOR_PICC_STATE_IDLE:
+        case RC522_EMULATOR_PICC_STATE_HALT:
+        default:
+            return false;
+    }
+}
+
+bool rc522_emulator_picc_receive(rc522_emulator_picc_t *picc, const rc522_emulator_frame_t *frame, bool encrypted,
+    uint8_t tx_speed, uint8_t rx_speed, rc522_emulator_frame_t *out_response)
+{
+    if (!picc->used || !picc->in_field) {
+        return false;
+    }
+
+    // Frame sent at other bit rate is noise for the PICC, and so is any frame above its limit
+    if (tx_speed != picc->isodep.dri || tx_speed > picc->speed_limit) {
+        return false;
+    }
+
+    // Response to PPS is sent at the bit rate in effect before it
+    uint8_t dsi = picc->isodep.dsi;
+
+    if (!rc522_emulator_picc_receive_at_speed(picc, frame, encrypted, out_response)) {
+        return false;
+    }
+
+    return rx_speed == dsi && dsi <= picc->speed_limit;
+}
+
+bool rc522_emulator_picc_authenticate(rc522_emulator_picc_t *picc, const uint8_t data[12])
+{
+    if (!picc->used || !picc->in_field || picc->state != RC522_EMULATOR_PICC_STATE_ACTIVE) {
+        return false;
+    }
+
+    uint16_t blocks = picc->memory_size / RC522_MIFARE_BLOCK_SIZE;
+    uint8_t command = data[0];
+    uint8_t block_address = data[1];
+    const uint8_t *key = data + 2;
+    const uint8_t *uid = data + 2 + RC522_MIFARE_KEY_SIZE;
+
+    bool valid = rc522_emulator_picc_is_mifare_classic(picc)
+                 && (command == RC522_EMULATOR_PICC_MIFARE_AUTH_KEY_A_CMD
+                     || command == RC522_EMULATOR_PICC_MIFARE_AUTH_KEY_B_CMD)
+                 && block_address < blocks;
+
+    if (valid) {
+        uint8_t sector = rc522_emulator_picc_sector_of_block(block_address);
+        const uint8_t *trailer = picc->memory + rc522_emulator_picc_sector_trailer(sector) * RC522_MIFARE_BLOCK_SIZE;
+        const uint8_t *expected_key = (command == RC522_EMULATOR_PICC_MIFARE_AUTH_KEY_A_CMD) ? trailer : (trailer + 10);
+
+        // Crypto1 is initialized with the last four bytes of the UID
+        valid = memcmp(key, expected_key, RC522_MIFARE_KEY_SIZE) == 0
+                && memcmp(uid, picc->uid + picc->uid_length - 4, 4) == 0;
+
+        if (valid) {
+            picc->auth_sector = sector;
+            picc->pending_write = -1;
+
+            return true;
+        }
+    }
+
+    // PICC does not respond anymore, until it is woken up again
+    rc522_emulator_picc_reset(picc);
+
+    return false;
+}
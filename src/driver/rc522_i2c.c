@@ -19,10 +19,20 @@ static esp_err_t rc522_i2c_install(const rc522_driver_handle_t driver)
 
     RC522_RETURN_ON_ERROR(i2c_driver_install(conf->port, conf->config.mode, 0, 0, 0x00));
 
+    // Buffer for the command link of batched transactions, unless it is provided by rc522_i2c_create_static()
+    if (driver->device == NULL) {
+        driver->device = calloc(1, RC522_I2C_BATCH_LINK_SIZE);
+        ESP_RETURN_ON_FALSE(driver->device != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
+    }
+
     if (conf->rst_io_num > GPIO_NUM_NC) {
         RC522_RETURN_ON_ERROR(rc522_driver_init_rst_pin(conf->rst_io_num));
     }
 
+    if (conf->irq_enabled) {
+        RC522_RETURN_ON_ERROR(rc522_driver_init_irq_pin(driver, conf->irq_io_num));
+    }
+
     return ESP_OK;
 }
 
@@ -69,6 +79,67 @@ static esp_err_t rc522_i2c_receive(const rc522_driver_handle_t driver, uint8_t a
     return ESP_OK;
 }
 
+static esp_err_t rc522_i2c_append_op(i2c_cmd_handle_t cmd, uint8_t device_address, rc522_driver_op_t *op)
+{
+    RC522_RETURN_ON_ERROR(i2c_master_start(cmd));
+    RC522_RETURN_ON_ERROR(i2c_master_write_byte(cmd, (device_address << 1) | I2C_MASTER_WRITE, true));
+    RC522_RETURN_ON_ERROR(i2c_master_write_byte(cmd, op->address, true));
+
+    if (op->type == RC522_DRIVER_OP_WRITE) {
+        RC522_RETURN_ON_ERROR(i2c_master_write(cmd, op->bytes.ptr, op->bytes.length, true));
+
+        return ESP_OK;
+    }
+
+    // Repeated start condition
+    RC522_RETURN_ON_ERROR(i2c_master_start(cmd));
+    RC522_RETURN_ON_ERROR(i2c_master_write_byte(cmd, (device_address << 1) | I2C_MASTER_READ, true));
+    RC522_RETURN_ON_ERROR(i2c_master_read(cmd, op->bytes.ptr, op->bytes.length, I2C_MASTER_LAST_NACK));
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_i2c_batch(const rc522_driver_handle_t driver, rc522_driver_op_t *ops, uint8_t count)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK(driver->config == NULL);
+    RC522_CHECK(ops == NULL);
+
+    for (uint8_t i = 0; i < count; i++) {
+        RC522_CHECK_BYTES(&ops[i].bytes);
+    }
+
+    rc522_i2c_config_t *conf = (rc522_i2c_config_t *)(driver->config);
+
+    // Ops are chained with repeated start conditions
+    // and sent to the device in a single command link
+    for (uint16_t i = 0; i < count; i += RC522_I2C_BATCH_OPS_MAX) {
+        i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(driver->device, RC522_I2C_BATCH_LINK_SIZE);
+        RC522_RETURN_ON_FALSE(cmd != NULL, ESP_ERR_NO_MEM);
+
+        esp_err_t ret = ESP_OK;
+
+        for (uint8_t j = i; j < count && j < (i + RC522_I2C_BATCH_OPS_MAX) && ret == ESP_OK; j++) {
+            ret = rc522_i2c_append_op(cmd, conf->device_address, &ops[j]);
+        }
+
+        if (ret == ESP_OK) {
+            ret = i2c_master_stop(cmd);
+        }
+
+        if (ret == ESP_OK) {
+            ret = i2c_master_cmd_begin(conf->port, cmd, pdMS_TO_TICKS(conf->rw_timeout_ms));
+        }
+
+        i2c_cmd_link_delete_static(cmd);
+
+        RC522_RETURN_ON_ERROR(ret);
+    }
+
+    return ESP_OK;
+}
+
 static esp_err_t rc522_i2c_reset(const rc522_driver_handle_t driver)
 {
     RC522_CHECK(driver == NULL);
@@ -95,11 +166,28 @@ static esp_err_t rc522_i2c_uninstall(const rc522_driver_handle_t driver)
 
     rc522_i2c_config_t *conf = (rc522_i2c_config_t *)(driver->config);
 
+    RC522_RETURN_ON_ERROR(rc522_driver_deinit_irq_pin(driver));
+
     RC522_RETURN_ON_ERROR(i2c_driver_delete(conf->port));
 
+    if (driver->device && !driver->is_static) {
+        free(driver->device);
+        driver->device = NULL;
+    }
+
     return ESP_OK;
 }
 
+static void rc522_i2c_set_handlers(rc522_driver_handle_t driver)
+{
+    driver->install = rc522_i2c_install;
+    driver->send = rc522_i2c_send;
+    driver->receive = rc522_i2c_receive;
+    driver->batch = rc522_i2c_batch;
+    driver->reset = rc522_i2c_reset;
+    driver->uninstall = rc522_i2c_uninstall;
+}
+
 esp_err_t rc522_i2c_create(const rc522_i2c_config_t *config, rc522_driver_handle_t *driver)
 {
     RC522_CHECK(config == NULL);
@@ -107,11 +195,23 @@ esp_err_t rc522_i2c_create(const rc522_i2c_config_t *config, rc522_driver_handle
 
     RC522_RETURN_ON_ERROR(rc522_driver_create(config, sizeof(rc522_i2c_config_t), driver));
 
-    (*driver)->install = rc522_i2c_install;
-    (*driver)->send = rc522_i2c_send;
-    (*driver)->receive = rc522_i2c_receive;
-    (*driver)->reset = rc522_i2c_reset;
-    (*driver)->uninstall = rc522_i2c_uninstall;
+    rc522_i2c_set_handlers(*driver);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_i2c_create_static(
+    const rc522_i2c_config_t *config, rc522_i2c_static_t *buffers, rc522_driver_handle_t *driver)
+{
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(buffers == NULL);
+    RC522_CHECK(driver == NULL);
+
+    RC522_RETURN_ON_ERROR(
+        rc522_driver_create_static(config, sizeof(rc522_i2c_config_t), &buffers->driver, &buffers->config, driver));
+
+    (*driver)->device = buffers->batch_link;
+    rc522_i2c_set_handlers(*driver);
 
     return ESP_OK;
 }
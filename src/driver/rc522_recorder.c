@@ -0,0 +1,331 @@
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "rc522_types_internal.h"
+#include "rc522_driver_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_recorder_internal.h"
+#include "driver/rc522_recorder.h"
+
+RC522_LOG_DEFINE_BASE();
+
+#define RC522_RECORDER_LOCK(recorder)   xSemaphoreTake((recorder)->mutex, portMAX_DELAY)
+#define RC522_RECORDER_UNLOCK(recorder) xSemaphoreGive((recorder)->mutex)
+
+typedef struct
+{
+    rc522_driver_handle_t inner;
+    SemaphoreHandle_t mutex;
+    uint8_t *buffer; /*<! Ring buffer, NULL if recording into the file only */
+    size_t buffer_size;
+    size_t tail; /*<! Offset of the oldest record */
+    size_t used;
+    FILE *file;
+    uint32_t start_us;
+} rc522_recorder_t;
+
+static inline rc522_recorder_t *rc522_recorder_from_driver(const rc522_driver_handle_t driver)
+{
+    return (rc522_recorder_t *)(driver->device);
+}
+
+static void rc522_recorder_ring_write(rc522_recorder_t *recorder, const uint8_t *bytes, size_t length)
+{
+    size_t head = (recorder->tail + recorder->used) % recorder->buffer_size;
+
+    for (size_t i = 0; i < length; i++) {
+        recorder->buffer[(head + i) % recorder->buffer_size] = bytes[i];
+    }
+
+    recorder->used += length;
+}
+
+static void rc522_recorder_ring_drop_oldest(rc522_recorder_t *recorder)
+{
+    uint8_t payload_length = recorder->buffer[(recorder->tail + RC522_RECORD_HEADER_SIZE - 1) % recorder->buffer_size];
+    size_t record_length = RC522_RECORD_HEADER_SIZE + payload_length;
+
+    recorder->tail = (recorder->tail + record_length) % recorder->buffer_size;
+    recorder->used -= record_length;
+}
+
+/**
+ * Appends the record to the ring buffer and to the file.
+ * Must be called with the mutex taken.
+ */
+static void rc522_recorder_append(rc522_recorder_t *recorder, const rc522_record_t *record)
+{
+    uint8_t header[RC522_RECORD_HEADER_SIZE];
+    rc522_record_encode_header(record, header);
+
+    size_t record_length = RC522_RECORD_HEADER_SIZE + record->length;
+
+    if (recorder->buffer && record_length <= recorder->buffer_size) {
+        while (recorder->used + record_length > recorder->buffer_size) {
+            rc522_recorder_ring_drop_oldest(recorder);
+        }
+
+        rc522_recorder_ring_write(recorder, header, sizeof(header));
+        rc522_recorder_ring_write(recorder, record->payload, record->length);
+    }
+
+    if (recorder->file) {
+        if (fwrite(header, 1, sizeof(header), recorder->file) != sizeof(header)
+            || fwrite(record->payload, 1, record->length, recorder->file) != record->length) {
+            RC522_LOGW("failed to write record into the file");
+        }
+    }
+}
+
+static void rc522_recorder_log(rc522_recorder_t *recorder, uint8_t type, uint8_t address, const uint8_t *payload,
+    uint8_t length, esp_err_t err, uint32_t start_us, uint32_t end_us)
+{
+    uint8_t err_payload[4];
+    uint32_t duration_us = end_us - start_us;
+
+    rc522_record_t record = {
+        .timestamp_us = start_us - recorder->start_us,
+        .duration_us = duration_us > UINT16_MAX ? UINT16_MAX : duration_us,
+        .type = type,
+        .address = address,
+        .length = length,
+        .payload = payload,
+    };
+
+    if (err != ESP_OK) {
+        rc522_record_encode_error(err, err_payload);
+
+        record.type |= RC522_RECORD_FLAG_ERROR;
+        record.length = sizeof(err_payload);
+        record.payload = err_payload;
+    }
+
+    rc522_recorder_append(recorder, &record);
+}
+
+static esp_err_t rc522_recorder_install(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+
+    rc522_recorder_t *recorder = rc522_recorder_from_driver(driver);
+
+    RC522_RETURN_ON_ERROR(rc522_driver_install(recorder->inner));
+
+    driver->irq_owner = recorder->inner;
+    recorder->start_us = rc522_micros();
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_recorder_send(const rc522_driver_handle_t driver, uint8_t address, const rc522_bytes_t *bytes)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK_BYTES(bytes);
+
+    rc522_recorder_t *recorder = rc522_recorder_from_driver(driver);
+
+    RC522_RECORDER_LOCK(recorder);
+
+    uint32_t start_us = rc522_micros();
+    esp_err_t ret = rc522_driver_send(recorder->inner, address, bytes);
+    uint32_t end_us = rc522_micros();
+
+    rc522_recorder_log(recorder, RC522_RECORD_WRITE, address, bytes->ptr, bytes->length, ret, start_us, end_us);
+
+    RC522_RECORDER_UNLOCK(recorder);
+
+    return ret;
+}
+
+static esp_err_t rc522_recorder_receive(const rc522_driver_handle_t driver, uint8_t address, rc522_bytes_t *bytes)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK_BYTES(bytes);
+
+    rc522_recorder_t *recorder = rc522_recorder_from_driver(driver);
+
+    RC522_RECORDER_LOCK(recorder);
+
+    uint32_t start_us = rc522_micros();
+    esp_err_t ret = rc522_driver_receive(recorder->inner, address, bytes);
+    uint32_t end_us = rc522_micros();
+
+    rc522_recorder_log(recorder, RC522_RECORD_READ, address, bytes->ptr, bytes->length, ret, start_us, end_us);
+
+    RC522_RECORDER_UNLOCK(recorder);
+
+    return ret;
+}
+
+/**
+ * Batch is recorded as one record per op. The first record holds the duration
+ * of the whole batch, the rest is flagged with RC522_RECORD_FLAG_BATCH.
+ * Failed batch is recorded as a single error record.
+ */
+static esp_err_t rc522_recorder_batch(const rc522_driver_handle_t driver, rc522_driver_op_t *ops, uint8_t count)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK(ops == NULL);
+    RC522_CHECK(count < 1);
+
+    rc522_recorder_t *recorder = rc522_recorder_from_driver(driver);
+
+    RC522_RECORDER_LOCK(recorder);
+
+    uint32_t start_us = rc522_micros();
+    esp_err_t ret = rc522_driver_batch(recorder->inner, ops, count);
+    uint32_t end_us = rc522_micros();
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t type = ops[i].type == RC522_DRIVER_OP_WRITE ? RC522_RECORD_WRITE : RC522_RECORD_READ;
+
+        if (i == 0) {
+            rc522_recorder_log(
+                recorder, type, ops[i].address, ops[i].bytes.ptr, ops[i].bytes.length, ret, start_us, end_us);
+        }
+        else if (ret == ESP_OK) {
+            type |= RC522_RECORD_FLAG_BATCH;
+            rc522_recorder_log(
+                recorder, type, ops[i].address, ops[i].bytes.ptr, ops[i].bytes.length, ESP_OK, end_us, end_us);
+        }
+    }
+
+    RC522_RECORDER_UNLOCK(recorder);
+
+    return ret;
+}
+
+static esp_err_t rc522_recorder_reset(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+
+    rc522_recorder_t *recorder = rc522_recorder_from_driver(driver);
+
+    RC522_RECORDER_LOCK(recorder);
+
+    uint32_t start_us = rc522_micros();
+    esp_err_t ret = rc522_driver_reset(recorder->inner);
+    uint32_t end_us = rc522_micros();
+
+    rc522_recorder_log(recorder, RC522_RECORD_RESET, 0x00, NULL, 0, ret, start_us, end_us);
+
+    RC522_RECORDER_UNLOCK(recorder);
+
+    return ret;
+}
+
+static esp_err_t rc522_recorder_uninstall(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+
+    rc522_recorder_t *recorder = rc522_recorder_from_driver(driver);
+
+    RC522_RETURN_ON_ERROR(rc522_driver_uninstall(recorder->inner));
+
+    driver->irq_owner = NULL;
+
+    vSemaphoreDelete(recorder->mutex);
+    free(recorder->buffer);
+    free(recorder);
+    driver->device = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_recorder_create(const rc522_recorder_config_t *config, rc522_driver_handle_t *driver)
+{
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(config->driver == NULL);
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(config->buffer_size == 0 && config->file == NULL);
+
+    esp_err_t ret = ESP_OK;
+
+    rc522_recorder_t *recorder = calloc(1, sizeof(rc522_recorder_t));
+    ESP_RETURN_ON_FALSE(recorder != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
+
+    recorder->mutex = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(recorder->mutex != NULL, ESP_ERR_NO_MEM, error, TAG, "nomem");
+
+    if (config->buffer_size > 0) {
+        recorder->buffer = malloc(config->buffer_size);
+        ESP_GOTO_ON_FALSE(recorder->buffer != NULL, ESP_ERR_NO_MEM, error, TAG, "nomem");
+    }
+
+    ESP_GOTO_ON_ERROR(rc522_driver_create(config, sizeof(rc522_recorder_config_t), driver), error, TAG, "nomem");
+
+    recorder->inner = config->driver;
+    recorder->buffer_size = config->buffer_size;
+    recorder->file = config->file;
+
+    (*driver)->device = recorder;
+    (*driver)->install = rc522_recorder_install;
+    (*driver)->send = rc522_recorder_send;
+    (*driver)->receive = rc522_recorder_receive;
+    (*driver)->batch = rc522_recorder_batch;
+    (*driver)->reset = rc522_recorder_reset;
+    (*driver)->uninstall = rc522_recorder_uninstall;
+
+    return ESP_OK;
+error:
+    if (recorder->mutex) {
+        vSemaphoreDelete(recorder->mutex);
+    }
+
+    free(recorder->buffer);
+    free(recorder);
+
+    return ret;
+}
+
+esp_err_t rc522_recorder_read(rc522_driver_handle_t driver, uint8_t *buffer, size_t size, size_t *out_length)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK(buffer == NULL);
+    RC522_CHECK(out_length == NULL);
+
+    rc522_recorder_t *recorder = rc522_recorder_from_driver(driver);
+    esp_err_t ret = ESP_OK;
+
+    RC522_RECORDER_LOCK(recorder);
+
+    if (recorder->used > size) {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+    else {
+        for (size_t i = 0; i < recorder->used; i++) {
+            buffer[i] = recorder->buffer[(recorder->tail + i) % recorder->buffer_size];
+        }
+
+        *out_length = recorder->used;
+    }
+
+    RC522_RECORDER_UNLOCK(recorder);
+
+    return ret;
+}
+
+esp_err_t rc522_recorder_clear(rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+
+    rc522_recorder_t *recorder = rc522_recorder_from_driver(driver);
+
+    RC522_RECORDER_LOCK(recorder);
+
+    recorder->tail = 0;
+    recorder->used = 0;
+    recorder->start_us = rc522_micros();
+
+    RC522_RECORDER_UNLOCK(recorder);
+
+    return ESP_OK;
+}
@@ -0,0 +1,191 @@
+#include <string.h>
+#include "rc522_types_internal.h"
+#include "rc522_driver_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_recorder_internal.h"
+#include "driver/rc522_replay.h"
+
+RC522_LOG_DEFINE_BASE();
+
+typedef struct
+{
+    size_t offset; /*<! Offset of the next record */
+    uint32_t start_us;
+} rc522_replay_t;
+
+static inline rc522_replay_t *rc522_replay_from_driver(const rc522_driver_handle_t driver)
+{
+    return (rc522_replay_t *)(driver->device);
+}
+
+/**
+ * Takes the next record from the log and checks that it is the expected transaction
+ */
+static esp_err_t rc522_replay_next(
+    const rc522_driver_handle_t driver, rc522_record_type_t type, uint8_t address, rc522_record_t *out_record)
+{
+    rc522_replay_config_t *conf = (rc522_replay_config_t *)(driver->config);
+    rc522_replay_t *replay = rc522_replay_from_driver(driver);
+
+    if (rc522_record_decode(conf->log, conf->length, replay->offset, out_record) != ESP_OK) {
+        RC522_LOGW("end of log at offset %u, expected type=%d address=0x%02" RC522_X,
+            (unsigned)replay->offset,
+            type,
+            address);
+
+        return RC522_ERR_REPLAY_MISMATCH;
+    }
+
+    uint8_t recorded_type = out_record->type & RC522_RECORD_TYPE_MASK;
+
+    if (recorded_type != type || out_record->address != address) {
+        RC522_LOGW("mismatch at offset %u: recorded type=%d address=0x%02" RC522_X
+                   ", expected type=%d address=0x%02" RC522_X,
+            (unsigned)replay->offset,
+            recorded_type,
+            out_record->address,
+            type,
+            address);
+
+        return RC522_ERR_REPLAY_MISMATCH;
+    }
+
+    replay->offset += RC522_RECORD_HEADER_SIZE + out_record->length;
+
+    if (conf->paced) {
+        uint32_t end_us = out_record->timestamp_us + out_record->duration_us;
+        uint32_t elapsed_us = rc522_micros() - replay->start_us;
+
+        if (end_us > elapsed_us) {
+            rc522_delay_ms((end_us - elapsed_us + 999) / 1000);
+        }
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_replay_install(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+
+    rc522_replay_t *replay = rc522_replay_from_driver(driver);
+
+    replay->offset = 0;
+    replay->start_us = rc522_micros();
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_replay_send(const rc522_driver_handle_t driver, uint8_t address, const rc522_bytes_t *bytes)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK_BYTES(bytes);
+
+    rc522_record_t record;
+    RC522_RETURN_ON_ERROR_SILENTLY(rc522_replay_next(driver, RC522_RECORD_WRITE, address, &record));
+
+    if (record.type & RC522_RECORD_FLAG_ERROR) {
+        return rc522_record_decode_error(&record);
+    }
+
+    if (record.length != bytes->length || memcmp(record.payload, bytes->ptr, bytes->length) != 0) {
+        RC522_LOGW("written bytes do not match the record (address=0x%02" RC522_X ")", address);
+
+        return RC522_ERR_REPLAY_MISMATCH;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_replay_receive(const rc522_driver_handle_t driver, uint8_t address, rc522_bytes_t *bytes)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK_BYTES(bytes);
+
+    rc522_record_t record;
+    RC522_RETURN_ON_ERROR_SILENTLY(rc522_replay_next(driver, RC522_RECORD_READ, address, &record));
+
+    if (record.type & RC522_RECORD_FLAG_ERROR) {
+        return rc522_record_decode_error(&record);
+    }
+
+    if (record.length != bytes->length) {
+        RC522_LOGW("read of %d bytes, recorded %d (address=0x%02" RC522_X ")", bytes->length, record.length, address);
+
+        return RC522_ERR_REPLAY_MISMATCH;
+    }
+
+    memcpy(bytes->ptr, record.payload, record.length);
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_replay_reset(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+
+    rc522_record_t record;
+    RC522_RETURN_ON_ERROR_SILENTLY(rc522_replay_next(driver, RC522_RECORD_RESET, 0x00, &record));
+
+    if (record.type & RC522_RECORD_FLAG_ERROR) {
+        return rc522_record_decode_error(&record);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_replay_uninstall(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+
+    free(driver->device);
+    driver->device = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_replay_create(const rc522_replay_config_t *config, rc522_driver_handle_t *driver)
+{
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(config->log == NULL && config->length > 0);
+    RC522_CHECK(driver == NULL);
+
+    esp_err_t ret = ESP_OK;
+
+    rc522_replay_t *replay = calloc(1, sizeof(rc522_replay_t));
+    ESP_RETURN_ON_FALSE(replay != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
+
+    ESP_GOTO_ON_ERROR(rc522_driver_create(config, sizeof(rc522_replay_config_t), driver), error, TAG, "nomem");
+
+    (*driver)->device = replay;
+    (*driver)->install = rc522_replay_install;
+    (*driver)->send = rc522_replay_send;
+    (*driver)->receive = rc522_replay_receive;
+    (*driver)->reset = rc522_replay_reset;
+    (*driver)->uninstall = rc522_replay_uninstall;
+
+    return ESP_OK;
+error:
+    free(replay);
+
+    return ret;
+}
+
+esp_err_t rc522_replay_finished(rc522_driver_handle_t driver, bool *out_finished)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK(out_finished == NULL);
+
+    rc522_replay_config_t *conf = (rc522_replay_config_t *)(driver->config);
+    rc522_replay_t *replay = rc522_replay_from_driver(driver);
+
+    *out_finished = replay->offset >= conf->length;
+
+    return ESP_OK;
+}
@@ -6,6 +6,11 @@
 
 RC522_LOG_DEFINE_BASE();
 
+#define RC522_SPI_BURST_LENGTH_MAX (64) // Size of the FIFO, longer reads are split into multiple bursts
+#define RC522_SPI_BATCH_FRAMES_MAX (8)  // Frames of the batch queued at once, limited by queue_size of the device
+
+#define RC522_SPI_ADDRESS_BYTE(rw, address) ((uint8_t)(((rw) << 7) | (((address) & 0x3F) << 1)))
+
 static esp_err_t rc522_spi_install(const rc522_driver_handle_t driver)
 {
     RC522_CHECK(driver == NULL);
@@ -35,13 +40,12 @@ static esp_err_t rc522_spi_install(const rc522_driver_handle_t driver)
         conf->dev_config.queue_size = 7;
     }
 
-    if (conf->dev_config.flags == 0) {
-        conf->dev_config.flags = SPI_DEVICE_HALFDUPLEX;
-    }
-
+    // Address byte is [rw:1][address:6][0:1]. The trailing zero is sent as
+    // the lowest address bit instead of a dummy bit, since dummy phase
+    // cannot be used in full-duplex mode (required for burst reads).
     conf->dev_config.command_bits = 1;
-    conf->dev_config.address_bits = 6;
-    conf->dev_config.dummy_bits = 1;
+    conf->dev_config.address_bits = 7;
+    conf->dev_config.dummy_bits = 0;
     // }}
 
     RC522_RETURN_ON_ERROR(
@@ -51,6 +55,10 @@ static esp_err_t rc522_spi_install(const rc522_driver_handle_t driver)
         RC522_RETURN_ON_ERROR(rc522_driver_init_rst_pin(conf->rst_io_num));
     }
 
+    if (conf->irq_enabled) {
+        RC522_RETURN_ON_ERROR(rc522_driver_init_irq_pin(driver, conf->irq_io_num));
+    }
+
     return ESP_OK;
 }
 
@@ -63,7 +71,7 @@ static esp_err_t rc522_spi_send(const rc522_driver_handle_t driver, uint8_t addr
     esp_err_t ret = spi_device_polling_transmit((spi_device_handle_t)(driver->device),
         &(spi_transaction_t) {
             .cmd = RC522_SPI_WRITE,
-            .addr = address,
+            .addr = (address << 1),
             .length = 8 * bytes->length,
             .tx_buffer = bytes->ptr,
         });
@@ -71,30 +79,217 @@ static esp_err_t rc522_spi_send(const rc522_driver_handle_t driver, uint8_t addr
     return ret;
 }
 
+static esp_err_t rc522_spi_read_sequence(
+    spi_device_handle_t device, const uint8_t *addresses, uint8_t *buffer, uint8_t length)
+{
+    uint8_t tx_buffer[RC522_SPI_BURST_LENGTH_MAX];
+
+    // While the PCD is clocking out the value of one register, it is clocking in
+    // the address of the next register to read. The sequence is terminated
+    // with 0x00 (datasheet, section 8.1.2.1)
+    for (uint8_t i = 1; i < length; i++) {
+        tx_buffer[i - 1] = RC522_SPI_ADDRESS_BYTE(RC522_SPI_READ, addresses[i]);
+    }
+
+    tx_buffer[length - 1] = 0x00;
+
+    return spi_device_polling_transmit(device,
+        &(spi_transaction_t) {
+            .cmd = RC522_SPI_READ,
+            .addr = (addresses[0] << 1),
+            .length = 8 * length,
+            .tx_buffer = tx_buffer,
+            .rxlength = 8 * length,
+            .rx_buffer = buffer,
+        });
+}
+
 static esp_err_t rc522_spi_receive(const rc522_driver_handle_t driver, uint8_t address, rc522_bytes_t *bytes)
 {
     RC522_CHECK(driver == NULL);
     RC522_CHECK(driver->device == NULL);
+    RC522_CHECK(driver->config == NULL);
     RC522_CHECK_BYTES(bytes);
 
-    // TODO: Do transactions on higher level
-    // RC522_RETURN_ON_ERROR(spi_device_acquire_bus((spi_device_handle_t)(driver->device), portMAX_DELAY));
+    rc522_spi_config_t *conf = (rc522_spi_config_t *)(driver->config);
+    spi_device_handle_t device = (spi_device_handle_t)(driver->device);
 
+    if (!(conf->dev_config.flags & SPI_DEVICE_HALFDUPLEX)) {
+        uint8_t addresses[RC522_SPI_BURST_LENGTH_MAX];
+        memset(addresses, address, sizeof(addresses));
+
+        // Read the same register repeatedly (e.g. drain the FIFO) in bursts
+        for (uint16_t i = 0; i < bytes->length; i += RC522_SPI_BURST_LENGTH_MAX) {
+            uint8_t length = bytes->length - i;
+
+            if (length > RC522_SPI_BURST_LENGTH_MAX) {
+                length = RC522_SPI_BURST_LENGTH_MAX;
+            }
+
+            RC522_RETURN_ON_ERROR(rc522_spi_read_sequence(device, addresses, bytes->ptr + i, length));
+        }
+
+        return ESP_OK;
+    }
+
+    // In half-duplex mode addresses cannot be sent while receiving,
+    // so each byte has to be read in its own transaction
     for (uint8_t i = 0; i < bytes->length; i++) {
-        RC522_RETURN_ON_ERROR(spi_device_polling_transmit((spi_device_handle_t)(driver->device),
+        RC522_RETURN_ON_ERROR(spi_device_polling_transmit(device,
             &(spi_transaction_t) {
                 .cmd = RC522_SPI_READ,
-                .addr = address,
+                .addr = (address << 1),
                 .rxlength = 8,
                 .rx_buffer = (bytes->ptr + i),
             }));
     }
 
-    // spi_device_release_bus((spi_device_handle_t)(driver->device));
+    return ESP_OK;
+}
+
+/**
+ * Queues the frames all at once, so the SPI driver runs them back to back (over DMA if the bus has
+ * a DMA channel), and waits for them. Values of the reads are then copied into the ops they belong to.
+ */
+static esp_err_t rc522_spi_run_frames(spi_device_handle_t device, spi_transaction_t *frames, uint8_t count)
+{
+    esp_err_t ret = ESP_OK;
+    uint8_t queued = 0;
+
+    while (queued < count && (ret = spi_device_queue_trans(device, &frames[queued], portMAX_DELAY)) == ESP_OK) {
+        queued++;
+    }
+
+    // Frames that made it into the queue are collected even if queueing of others has failed
+    for (uint8_t i = 0; i < queued; i++) {
+        spi_transaction_t *frame = NULL;
+        esp_err_t result = spi_device_get_trans_result(device, &frame, portMAX_DELAY);
+
+        ret = (ret == ESP_OK) ? result : ret;
+    }
+
+    RC522_RETURN_ON_ERROR(ret);
+
+    for (uint8_t i = 0; i < count; i++) {
+        rc522_driver_op_t *op = (rc522_driver_op_t *)(frames[i].user);
+
+        for (uint8_t offset = 0; op != NULL && offset < (frames[i].rxlength / 8); op++) {
+            memcpy(op->bytes.ptr, frames[i].rx_data + offset, op->bytes.length);
+            offset += op->bytes.length;
+        }
+    }
 
     return ESP_OK;
 }
 
+static esp_err_t rc522_spi_batch(const rc522_driver_handle_t driver, rc522_driver_op_t *ops, uint8_t count)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(driver->device == NULL);
+    RC522_CHECK(driver->config == NULL);
+    RC522_CHECK(ops == NULL);
+
+    for (uint8_t i = 0; i < count; i++) {
+        RC522_CHECK_BYTES(&ops[i].bytes);
+    }
+
+    rc522_spi_config_t *conf = (rc522_spi_config_t *)(driver->config);
+    spi_device_handle_t device = (spi_device_handle_t)(driver->device);
+    bool full_duplex = !(conf->dev_config.flags & SPI_DEVICE_HALFDUPLEX);
+    uint8_t frames_max = conf->dev_config.queue_size < RC522_SPI_BATCH_FRAMES_MAX ? conf->dev_config.queue_size
+                                                                                   : RC522_SPI_BATCH_FRAMES_MAX;
+
+    // Hold the bus for the whole batch, so it is acquired only once
+    // and transactions of other devices cannot get in between
+    RC522_RETURN_ON_ERROR(spi_device_acquire_bus(device, portMAX_DELAY));
+
+    spi_transaction_t frames[RC522_SPI_BATCH_FRAMES_MAX];
+    uint8_t frames_count = 0;
+    esp_err_t ret = ESP_OK;
+    uint8_t i = 0;
+
+    while (i < count && ret == ESP_OK) {
+        spi_transaction_t *frame = &frames[frames_count];
+
+        memset(frame, 0, sizeof(spi_transaction_t));
+        frame->addr = (ops[i].address << 1);
+
+        if (ops[i].type == RC522_DRIVER_OP_WRITE) {
+            // Each write needs its own frame, since all bytes
+            // after the address byte are written to the same register
+            frame->cmd = RC522_SPI_WRITE;
+            frame->length = 8 * ops[i].bytes.length;
+
+            if (ops[i].bytes.length <= sizeof(frame->tx_data)) {
+                frame->flags = SPI_TRANS_USE_TXDATA;
+                memcpy(frame->tx_data, ops[i].bytes.ptr, ops[i].bytes.length);
+            }
+            else {
+                frame->tx_buffer = ops[i].bytes.ptr;
+            }
+
+            i++;
+        }
+        else {
+            // Consecutive reads are merged into a single frame, as long as their values fit into it
+            uint8_t addresses[sizeof(frame->rx_data)];
+            uint8_t length = 0;
+            uint8_t end = i;
+
+            while (end < count && ops[end].type == RC522_DRIVER_OP_READ
+                   && (length + ops[end].bytes.length) <= sizeof(frame->rx_data)
+                   && (full_duplex || (end == i && ops[end].bytes.length == 1))) {
+                memset(addresses + length, ops[end].address, ops[end].bytes.length);
+                length += ops[end].bytes.length;
+                end++;
+            }
+
+            // Longer reads (e.g. FIFO) are split into bursts by rc522_spi_receive()
+            if (end == i) {
+                if (frames_count > 0) {
+                    ret = rc522_spi_run_frames(device, frames, frames_count);
+                    frames_count = 0;
+                }
+
+                ret = (ret == ESP_OK) ? rc522_spi_receive(driver, ops[i].address, &ops[i].bytes) : ret;
+                i++;
+                continue;
+            }
+
+            frame->cmd = RC522_SPI_READ;
+            frame->flags = SPI_TRANS_USE_RXDATA;
+            frame->rxlength = 8 * length;
+            frame->user = &ops[i];
+
+            if (full_duplex) {
+                // Same sequence of addresses as in rc522_spi_read_sequence()
+                for (uint8_t j = 1; j < length; j++) {
+                    frame->tx_data[j - 1] = RC522_SPI_ADDRESS_BYTE(RC522_SPI_READ, addresses[j]);
+                }
+
+                frame->tx_data[length - 1] = 0x00;
+                frame->flags |= SPI_TRANS_USE_TXDATA;
+                frame->length = 8 * length;
+            }
+
+            i = end;
+        }
+
+        if (++frames_count == frames_max) {
+            ret = rc522_spi_run_frames(device, frames, frames_count);
+            frames_count = 0;
+        }
+    }
+
+    if (ret == ESP_OK && frames_count > 0) {
+        ret = rc522_spi_run_frames(device, frames, frames_count);
+    }
+
+    spi_device_release_bus(device);
+
+    return ret;
+}
+
 static esp_err_t rc522_spi_reset(const rc522_driver_handle_t driver)
 {
     RC522_CHECK(driver == NULL);
@@ -120,6 +315,8 @@ static esp_err_t rc522_spi_uninstall(const rc522_driver_handle_t driver)
     RC522_CHECK(driver->device == NULL);
     RC522_CHECK(driver->config == NULL);
 
+    RC522_RETURN_ON_ERROR(rc522_driver_deinit_irq_pin(driver));
+
     RC522_RETURN_ON_ERROR(spi_bus_remove_device((spi_device_handle_t)(driver->device)));
     driver->device = NULL;
 
@@ -132,6 +329,16 @@ static esp_err_t rc522_spi_uninstall(const rc522_driver_handle_t driver)
     return ESP_OK;
 }
 
+static void rc522_spi_set_handlers(rc522_driver_handle_t driver)
+{
+    driver->install = rc522_spi_install;
+    driver->send = rc522_spi_send;
+    driver->receive = rc522_spi_receive;
+    driver->batch = rc522_spi_batch;
+    driver->reset = rc522_spi_reset;
+    driver->uninstall = rc522_spi_uninstall;
+}
+
 esp_err_t rc522_spi_create(const rc522_spi_config_t *config, rc522_driver_handle_t *driver)
 {
     RC522_CHECK(config == NULL);
@@ -139,11 +346,22 @@ esp_err_t rc522_spi_create(const rc522_spi_config_t *config, rc522_driver_handle
 
     RC522_RETURN_ON_ERROR(rc522_driver_create(config, sizeof(rc522_spi_config_t), driver));
 
-    (*driver)->install = rc522_spi_install;
-    (*driver)->send = rc522_spi_send;
-    (*driver)->receive = rc522_spi_receive;
-    (*driver)->reset = rc522_spi_reset;
-    (*driver)->uninstall = rc522_spi_uninstall;
+    rc522_spi_set_handlers(*driver);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_spi_create_static(
+    const rc522_spi_config_t *config, rc522_spi_static_t *buffers, rc522_driver_handle_t *driver)
+{
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(buffers == NULL);
+    RC522_CHECK(driver == NULL);
+
+    RC522_RETURN_ON_ERROR(
+        rc522_driver_create_static(config, sizeof(rc522_spi_config_t), &buffers->driver, &buffers->config, driver));
+
+    rc522_spi_set_handlers(*driver);
 
     return ESP_OK;
 }
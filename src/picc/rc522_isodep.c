@@ -0,0 +1,528 @@
+#include <string.h>
+#include "rc522_types_internal.h"
+#include "rc522_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_pcd_internal.h"
+#include "rc522_picc_internal.h"
+#include "rc522_stats_internal.h"
+#include "rc522_isodep_internal.h"
+
+RC522_LOG_DEFINE_BASE();
+
+#define RC522_ISODEP_TIMEOUT_US_ACTIVATION (5000) // FWT of RATS, 65536 / fc
+#define RC522_ISODEP_FWT_DELTA_US          (3625) // Added to every FWT, 49152 / fc
+#define RC522_ISODEP_RETRANSMISSIONS_MAX   (2)    // Per block, before the exchange is given up
+#define RC522_ISODEP_SAK_COMPLIANT_BIT     (0x20)
+
+/**
+ * Errors after which the block is considered lost and is recovered with an R-block
+ */
+static inline bool rc522_isodep_is_transmission_error(esp_err_t ret)
+{
+    return ret == RC522_ERR_RX_TIMER_TIMEOUT || ret == RC522_ERR_CRC_WRONG || ret == RC522_ERR_PCD_PARITY_CHECK_FAILED
+           || ret == RC522_ERR_PCD_PROTOCOL_ERROR || ret == RC522_ERR_PCD_FIFO_EMPTY || ret == RC522_ERR_COLLISION;
+}
+
+static inline bool rc522_isodep_is_i_block(uint8_t pcb)
+{
+    return (pcb & RC522_ISODEP_PCB_TYPE_MASK) == 0x00;
+}
+
+static inline bool rc522_isodep_is_r_ack(uint8_t pcb)
+{
+    return (pcb & RC522_ISODEP_PCB_TYPE_MASK) == RC522_ISODEP_PCB_R_BLOCK_TYPE && !(pcb & RC522_ISODEP_PCB_NAK_BIT);
+}
+
+static inline bool rc522_isodep_is_s_wtx(uint8_t pcb)
+{
+    return (pcb & RC522_ISODEP_PCB_S_MASK) == RC522_ISODEP_PCB_S_WTX;
+}
+
+static esp_err_t rc522_isodep_transceive_frame(const rc522_handle_t rc522, const uint8_t *frame, uint8_t length,
+    uint32_t timeout_us, uint8_t response[RC522_ISODEP_FRAME_SIZE_MAX], uint8_t *out_length)
+{
+    // CRC_A is appended and verified by the PCD
+    rc522_picc_transaction_t transaction = {
+        .bytes = { .ptr = (uint8_t *)(uintptr_t)frame, .length = length },
+        .tx_crc = true,
+        .rx_crc = true,
+        .timeout_us = timeout_us,
+    };
+
+    rc522_picc_transaction_result_t result = {
+        .bytes = { .ptr = response, .length = RC522_ISODEP_FRAME_SIZE_MAX - 2 }, // Without CRC_A
+    };
+
+    RC522_RETURN_ON_ERROR_SILENTLY(rc522_picc_transceive(rc522, &transaction, &result));
+
+    *out_length = result.bytes.length;
+
+    return ESP_OK;
+}
+
+/**
+ * Sends the block and returns the response of the PICC to it (ISO/IEC 14443-4, section 7.5.4).
+ * S(WTX) is answered in place, lost blocks are recovered with R(NAK) (or R(ACK) that is repeated),
+ * and the block is sent again if the PICC acknowledges the previous one.
+ */
+static esp_err_t rc522_isodep_exchange_block(const rc522_handle_t rc522, rc522_isodep_t *isodep, const uint8_t *block,
+    uint8_t length, uint8_t response[RC522_ISODEP_FRAME_SIZE_MAX], uint8_t *out_length)
+{
+    const uint8_t *frame = block;
+    uint8_t frame_length = length;
+    uint8_t control[2]; // R-block or S(WTX) response
+    uint32_t timeout_us = isodep->fwt_us;
+    uint8_t retransmissions = 0;
+
+    while (true) {
+        esp_err_t ret = rc522_isodep_transceive_frame(rc522, frame, frame_length, timeout_us, response, out_length);
+
+        // Extended waiting time applies to the next response only
+        timeout_us = isodep->fwt_us;
+
+        if (ret == ESP_OK && rc522_isodep_is_s_wtx(response[0])) {
+            uint8_t inf = (response[0] & RC522_ISODEP_PCB_CID_BIT) ? 2 : 1;
+            RC522_CHECK_AND_RETURN(*out_length <= inf, RC522_ERR_ISODEP_PROTOCOL_ERROR);
+
+            uint8_t wtxm = response[inf] & RC522_ISODEP_WTXM_MASK;
+            RC522_CHECK_AND_RETURN(wtxm == 0 || wtxm > RC522_ISODEP_WTXM_MAX, RC522_ERR_ISODEP_PROTOCOL_ERROR);
+
+            RC522_LOGD("waiting time extension (wtxm=%d)", wtxm);
+
+            control[0] = RC522_ISODEP_PCB_S_WTX;
+            control[1] = wtxm;
+            frame = control;
+            frame_length = 2;
+            timeout_us = (isodep->fwt_us - RC522_ISODEP_FWT_DELTA_US) * wtxm;
+
+            // Extended FWT is limited to the one of the largest FWI (ISO/IEC 14443-4, section 7.3)
+            if (timeout_us > rc522_isodep_time_us(RC522_ISODEP_TIME_INTEGER_MAX)) {
+                timeout_us = rc522_isodep_time_us(RC522_ISODEP_TIME_INTEGER_MAX);
+            }
+
+            timeout_us += RC522_ISODEP_FWT_DELTA_US;
+            continue;
+        }
+
+        // R(ACK) of the previous block means that this one has not been received
+        bool block_lost = ret == ESP_OK && rc522_isodep_is_r_ack(response[0])
+                          && (response[0] & RC522_ISODEP_PCB_BLOCK_NUMBER_BIT) != isodep->block_number;
+
+        if (ret == ESP_OK && !block_lost) {
+            return ESP_OK;
+        }
+
+        if (ret != ESP_OK && !rc522_isodep_is_transmission_error(ret)) {
+            return ret;
+        }
+
+        if (++retransmissions > RC522_ISODEP_RETRANSMISSIONS_MAX) {
+            RC522_LOGD("block not exchanged (err=%04" RC522_X ")", ret);
+
+            return ret == ESP_OK ? RC522_ERR_ISODEP_PROTOCOL_ERROR : ret;
+        }
+
+        if (block_lost || rc522_isodep_is_r_ack(block[0])) {
+            frame = block;
+            frame_length = length;
+        }
+        else {
+            control[0] = RC522_ISODEP_PCB_R_BLOCK | RC522_ISODEP_PCB_NAK_BIT | isodep->block_number;
+            frame = control;
+            frame_length = 1;
+        }
+    }
+}
+
+bool rc522_isodep_is_compliant(const rc522_picc_t *picc)
+{
+    return picc != NULL && (picc->sak & RC522_ISODEP_SAK_COMPLIANT_BIT);
+}
+
+static esp_err_t rc522_isodep_parse_ats(const uint8_t *ats, uint8_t length, rc522_isodep_ats_t *out_ats)
+{
+    RC522_CHECK_AND_RETURN(length < 1 || ats[0] != length, RC522_ERR_ISODEP_INVALID_ATS);
+
+    uint8_t t0 = length > 1 ? ats[1] : 0x00;
+    uint8_t fsci = length > 1 ? (t0 & RC522_ISODEP_T0_FSCI_MASK) : RC522_ISODEP_FSCI_DEFAULT;
+    uint8_t tb = (RC522_ISODEP_FWI_DEFAULT << 4) | RC522_ISODEP_SFGI_DEFAULT;
+    uint8_t tc = RC522_ISODEP_TC_DEFAULT;
+    uint8_t index = 2;
+
+    memset(out_ats, 0, sizeof(rc522_isodep_ats_t));
+
+    if (t0 & RC522_ISODEP_T0_TA_BIT) {
+        out_ats->ta = index < length ? ats[index] : 0x00;
+        index++;
+    }
+
+    if (t0 & RC522_ISODEP_T0_TB_BIT) {
+        tb = index < length ? ats[index] : tb;
+        index++;
+    }
+
+    if (t0 & RC522_ISODEP_T0_TC_BIT) {
+        tc = index < length ? ats[index] : tc;
+        index++;
+    }
+
+    RC522_CHECK_AND_RETURN(length > 1 && index > length, RC522_ERR_ISODEP_INVALID_ATS);
+
+    out_ats->fsc = rc522_isodep_frame_size(fsci);
+    out_ats->fwi = tb >> 4;
+    out_ats->sfgi = tb & 0x0F;
+    out_ats->cid_supported = tc & RC522_ISODEP_TC_CID_BIT;
+    out_ats->nad_supported = tc & RC522_ISODEP_TC_NAD_BIT;
+
+    // RFU values
+    if (out_ats->fwi > RC522_ISODEP_TIME_INTEGER_MAX) {
+        out_ats->fwi = RC522_ISODEP_FWI_DEFAULT;
+    }
+
+    if (out_ats->sfgi > RC522_ISODEP_TIME_INTEGER_MAX) {
+        out_ats->sfgi = RC522_ISODEP_SFGI_DEFAULT;
+    }
+
+    if (length > index) {
+        out_ats->historical_bytes_length = length - index;
+        memcpy(out_ats->historical_bytes, ats + index, out_ats->historical_bytes_length);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_isodep_rats(const rc522_handle_t rc522, rc522_isodep_t *out_isodep)
+{
+    const uint8_t rats[] = { RC522_PICC_CMD_RATS, (RC522_ISODEP_FSDI << 4) }; // CID 0
+    uint8_t ats[RC522_ISODEP_FRAME_SIZE_MAX];
+    uint8_t ats_length = 0;
+
+    RC522_RETURN_ON_ERROR_SILENTLY(
+        rc522_isodep_transceive_frame(rc522, rats, sizeof(rats), RC522_ISODEP_TIMEOUT_US_ACTIVATION, ats, &ats_length));
+
+    RC522_RETURN_ON_ERROR(rc522_isodep_parse_ats(ats, ats_length, &out_isodep->ats));
+
+    const rc522_isodep_ats_t *parsed = &out_isodep->ats;
+
+    RC522_LOGD("ATS (fsc=%d, fwi=%d, sfgi=%d, ta=0x%02" RC522_X ")",
+        parsed->fsc,
+        parsed->fwi,
+        parsed->sfgi,
+        parsed->ta);
+
+    out_isodep->fwt_us = rc522_isodep_time_us(parsed->fwi) + RC522_ISODEP_FWT_DELTA_US;
+    out_isodep->frame_size = parsed->fsc < RC522_ISODEP_FRAME_SIZE_MAX ? parsed->fsc : RC522_ISODEP_FRAME_SIZE_MAX;
+    out_isodep->block_number = 0;
+    out_isodep->dsi = RC522_ISODEP_BITRATE_106;
+    out_isodep->dri = RC522_ISODEP_BITRATE_106;
+
+    // PICC does not listen until its start-up frame guard time has passed
+    if (parsed->sfgi > 0) {
+        rc522_delay_ms((rc522_isodep_time_us(parsed->sfgi) + 999) / 1000);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_isodep_activate(const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_isodep_t *out_isodep)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(picc == NULL);
+    RC522_CHECK(out_isodep == NULL);
+    RC522_CHECK_AND_RETURN(!rc522_isodep_is_compliant(picc), ESP_ERR_NOT_SUPPORTED);
+
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_isodep_rats(rc522, out_isodep);
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_ISODEP, ret);
+
+    return ret;
+}
+
+/**
+ * TA(1) bit of the bit rate. DS (PICC to PCD) is coded by bits 7-5, DR (PCD to PICC) by bits 3-1.
+ */
+static inline uint8_t rc522_isodep_ta_bit(rc522_isodep_bitrate_t bitrate, bool ds)
+{
+    return bitrate == RC522_ISODEP_BITRATE_106 ? 0x00 : (0x01 << ((bitrate - 1) + (ds ? 4 : 0)));
+}
+
+static inline bool rc522_isodep_bitrates_supported(uint8_t ta, rc522_isodep_bitrate_t dsi, rc522_isodep_bitrate_t dri)
+{
+    uint8_t required = rc522_isodep_ta_bit(dsi, true) | rc522_isodep_ta_bit(dri, false);
+
+    return (ta & required) == required && (!(ta & RC522_ISODEP_TA_SAME_BITRATE_BIT) || dsi == dri);
+}
+
+esp_err_t rc522_isodep_pps(
+    const rc522_handle_t rc522, rc522_isodep_t *isodep, rc522_isodep_bitrate_t dsi, rc522_isodep_bitrate_t dri)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(isodep == NULL);
+    RC522_CHECK(dsi > RC522_ISODEP_BITRATE_848);
+    RC522_CHECK(dri > RC522_ISODEP_BITRATE_848);
+    RC522_CHECK_AND_RETURN(
+        !rc522_isodep_bitrates_supported(isodep->ats.ta, dsi, dri), RC522_ERR_ISODEP_BITRATE_UNSUPPORTED);
+
+    const uint8_t pps[] = { RC522_ISODEP_PPSS, RC522_ISODEP_PPS0_PPS1, (uint8_t)((dsi << 2) | dri) };
+    uint8_t response[RC522_ISODEP_FRAME_SIZE_MAX];
+    uint8_t response_length = 0;
+
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_isodep_transceive_frame(rc522, pps, sizeof(pps), isodep->fwt_us, response, &response_length);
+
+    if (ret == ESP_OK && (response_length != 1 || response[0] != RC522_ISODEP_PPSS)) {
+        ret = RC522_ERR_ISODEP_PROTOCOL_ERROR;
+    }
+
+    // PPS response is sent at the old bit rates, the new ones apply from the next frame.
+    // TxSpeed is what the PICC receives (DR), RxSpeed is what it sends (DS).
+    if (ret == ESP_OK) {
+        ret = rc522_pcd_set_speed(rc522, (rc522_pcd_speed_t)dri, (rc522_pcd_speed_t)dsi);
+    }
+
+    if (ret == ESP_OK) {
+        isodep->dsi = dsi;
+        isodep->dri = dri;
+    }
+
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_ISODEP, ret);
+
+    return ret;
+}
+
+/**
+ * Highest bit rates of both directions supported by the PICC, none of them above the limit
+ */
+static void rc522_isodep_highest_bitrates(
+    uint8_t ta, rc522_isodep_bitrate_t limit, rc522_isodep_bitrate_t *out_dsi, rc522_isodep_bitrate_t *out_dri)
+{
+    rc522_isodep_bitrate_t dsi = limit;
+    rc522_isodep_bitrate_t dri = limit;
+
+    while (dsi > RC522_ISODEP_BITRATE_106 && !(ta & rc522_isodep_ta_bit(dsi, true))) {
+        dsi--;
+    }
+
+    while (dri > RC522_ISODEP_BITRATE_106 && !(ta & rc522_isodep_ta_bit(dri, false))) {
+        dri--;
+    }
+
+    // Same bit rate in both directions, supported by both of them
+    if (ta & RC522_ISODEP_TA_SAME_BITRATE_BIT) {
+        dsi = dri = (dsi < dri ? dsi : dri);
+
+        while (dsi > RC522_ISODEP_BITRATE_106 && !rc522_isodep_bitrates_supported(ta, dsi, dsi)) {
+            dsi--;
+            dri--;
+        }
+    }
+
+    *out_dsi = dsi;
+    *out_dri = dri;
+}
+
+/**
+ * R(NAK) is answered by R(ACK) without any change of the protocol state
+ * (ISO/IEC 14443-4, section 7.5.6.2), so it checks that frames get through in both directions.
+ */
+static esp_err_t rc522_isodep_probe(const rc522_handle_t rc522, rc522_isodep_t *isodep)
+{
+    const uint8_t nak = RC522_ISODEP_PCB_R_BLOCK | RC522_ISODEP_PCB_NAK_BIT | isodep->block_number;
+    uint8_t response[RC522_ISODEP_FRAME_SIZE_MAX];
+    uint8_t response_length = 0;
+
+    RC522_RETURN_ON_ERROR_SILENTLY(
+        rc522_isodep_transceive_frame(rc522, &nak, 1, isodep->fwt_us, response, &response_length));
+
+    RC522_CHECK_AND_RETURN(response_length < 1 || !rc522_isodep_is_r_ack(response[0]), RC522_ERR_ISODEP_PROTOCOL_ERROR);
+
+    return ESP_OK;
+}
+
+/**
+ * PICC may be stuck at the bit rates that do not work, and it cannot be told otherwise at them.
+ * The RF field is reset, so it returns to 106 kbit/s and it is activated again.
+ */
+static esp_err_t rc522_isodep_reactivate(const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_isodep_t *isodep)
+{
+    RC522_RETURN_ON_ERROR(rc522_pcd_set_speed(rc522, RC522_PCD_SPEED_106, RC522_PCD_SPEED_106));
+    RC522_RETURN_ON_ERROR(rc522_pcd_rf_reset(rc522));
+    RC522_RETURN_ON_ERROR_SILENTLY(rc522_picc_reselect(rc522, picc));
+
+    return rc522_isodep_activate(rc522, picc, isodep);
+}
+
+esp_err_t rc522_isodep_negotiate_bitrate(const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_isodep_t *isodep,
+    rc522_isodep_bitrate_t max_bitrate)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(picc == NULL);
+    RC522_CHECK(isodep == NULL);
+    RC522_CHECK(max_bitrate > RC522_ISODEP_BITRATE_848);
+
+    rc522_isodep_bitrate_t dsi;
+    rc522_isodep_bitrate_t dri;
+
+    rc522_isodep_highest_bitrates(isodep->ats.ta, max_bitrate, &dsi, &dri);
+
+    while (dsi != RC522_ISODEP_BITRATE_106 || dri != RC522_ISODEP_BITRATE_106) {
+        esp_err_t ret = rc522_isodep_pps(rc522, isodep, dsi, dri);
+
+        if (ret == ESP_OK) {
+            RC522_STATS_BEGIN(rc522, span);
+            ret = rc522_isodep_probe(rc522, isodep);
+            RC522_STATS_END(rc522, span, RC522_STATS_STAGE_ISODEP, ret);
+        }
+
+        if (ret == ESP_OK) {
+            RC522_LOGD("bit rates raised (dsi=%d, dri=%d)", dsi, dri);
+
+            return ESP_OK;
+        }
+
+        if (!rc522_isodep_is_transmission_error(ret) && ret != RC522_ERR_ISODEP_PROTOCOL_ERROR) {
+            return ret;
+        }
+
+        RC522_LOGD("bit rates not usable (dsi=%d, dri=%d, err=%04" RC522_X ")", dsi, dri, ret);
+
+        // PPS is accepted only as the first block, so the PICC has to be activated again anyway
+        RC522_RETURN_ON_ERROR_SILENTLY(rc522_isodep_reactivate(rc522, picc, isodep));
+
+        rc522_isodep_highest_bitrates(isodep->ats.ta, (dsi > dri ? dsi : dri) - 1, &dsi, &dri);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_isodep_exchange_apdu(const rc522_handle_t rc522, rc522_isodep_t *isodep, const uint8_t *apdu,
+    size_t apdu_length, uint8_t *out_buffer, size_t buffer_size, size_t *out_length)
+{
+    uint8_t block[RC522_ISODEP_FRAME_SIZE_MAX];
+    uint8_t response[RC522_ISODEP_FRAME_SIZE_MAX];
+    uint8_t response_length = 0;
+    size_t inf_size = isodep->frame_size - 3; // PCB and CRC_A
+    size_t sent = 0;
+
+    // {{ Command, chained by the PCD if it does not fit into one block
+    while (true) {
+        size_t chunk = (apdu_length - sent) < inf_size ? (apdu_length - sent) : inf_size;
+        bool chaining = (sent + chunk) < apdu_length;
+
+        block[0] = RC522_ISODEP_PCB_I_BLOCK | isodep->block_number | (chaining ? RC522_ISODEP_PCB_CHAINING_BIT : 0);
+        memcpy(block + 1, apdu + sent, chunk);
+
+        RC522_RETURN_ON_ERROR_SILENTLY(
+            rc522_isodep_exchange_block(rc522, isodep, block, chunk + 1, response, &response_length));
+
+        if (!chaining) {
+            break;
+        }
+
+        // Each chained block is acknowledged by R(ACK)
+        RC522_CHECK_AND_RETURN(!rc522_isodep_is_r_ack(response[0]), RC522_ERR_ISODEP_PROTOCOL_ERROR);
+
+        isodep->block_number ^= RC522_ISODEP_PCB_BLOCK_NUMBER_BIT;
+        sent += chunk;
+    }
+    // }}
+
+    // {{ Response, chained by the PICC if it does not fit into one block
+    size_t received = 0;
+    bool overflow = false;
+
+    while (true) {
+        uint8_t pcb = response[0];
+        uint8_t inf = 1 + ((pcb & RC522_ISODEP_PCB_CID_BIT) ? 1 : 0) + ((pcb & RC522_ISODEP_PCB_NAD_BIT) ? 1 : 0);
+
+        RC522_CHECK_AND_RETURN(!rc522_isodep_is_i_block(pcb) || response_length < inf
+                                   || (pcb & RC522_ISODEP_PCB_BLOCK_NUMBER_BIT) != isodep->block_number,
+            RC522_ERR_ISODEP_PROTOCOL_ERROR);
+
+        isodep->block_number ^= RC522_ISODEP_PCB_BLOCK_NUMBER_BIT;
+
+        size_t chunk = response_length - inf;
+
+        if (overflow || (received + chunk) > buffer_size) {
+            overflow = true;
+        }
+        else {
+            memcpy(out_buffer + received, response + inf, chunk);
+            received += chunk;
+        }
+
+        if (!(pcb & RC522_ISODEP_PCB_CHAINING_BIT)) {
+            break;
+        }
+
+        block[0] = RC522_ISODEP_PCB_R_BLOCK | isodep->block_number;
+
+        RC522_RETURN_ON_ERROR_SILENTLY(
+            rc522_isodep_exchange_block(rc522, isodep, block, 1, response, &response_length));
+    }
+    // }}
+
+    *out_length = received;
+
+    return overflow ? RC522_ERR_ISODEP_RESPONSE_TOO_LONG : ESP_OK;
+}
+
+esp_err_t rc522_isodep_transceive_apdu(const rc522_handle_t rc522, rc522_isodep_t *isodep, const uint8_t *apdu,
+    size_t apdu_length, uint8_t *out_buffer, size_t buffer_size, size_t *out_length)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(isodep == NULL);
+    RC522_CHECK(isodep->frame_size < 4);
+    RC522_CHECK(apdu == NULL);
+    RC522_CHECK(apdu_length == 0);
+    RC522_CHECK(out_buffer == NULL);
+    RC522_CHECK(out_length == NULL);
+
+    *out_length = 0;
+
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret
+        = rc522_isodep_exchange_apdu(rc522, isodep, apdu, apdu_length, out_buffer, buffer_size, out_length);
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_ISODEP, ret);
+
+    return ret;
+}
+
+esp_err_t rc522_isodep_deselect(const rc522_handle_t rc522, rc522_isodep_t *isodep)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(isodep == NULL);
+
+    const uint8_t deselect = RC522_ISODEP_PCB_S_DESELECT;
+    uint8_t response[RC522_ISODEP_FRAME_SIZE_MAX];
+    uint8_t response_length = 0;
+    esp_err_t ret = ESP_OK;
+
+    RC522_STATS_BEGIN(rc522, span);
+
+    // S(DESELECT) is sent again if its response is lost
+    for (uint8_t attempt = 0; attempt <= RC522_ISODEP_RETRANSMISSIONS_MAX; attempt++) {
+        ret = rc522_isodep_transceive_frame(rc522, &deselect, 1, isodep->fwt_us, response, &response_length);
+
+        if (ret == ESP_OK || !rc522_isodep_is_transmission_error(ret)) {
+            break;
+        }
+    }
+
+    if (ret == ESP_OK && (response[0] & RC522_ISODEP_PCB_S_MASK) != RC522_ISODEP_PCB_S_DESELECT) {
+        ret = RC522_ERR_ISODEP_PROTOCOL_ERROR;
+    }
+
+    // Next PICC is activated at 106 kbit/s
+    if (isodep->dsi != RC522_ISODEP_BITRATE_106 || isodep->dri != RC522_ISODEP_BITRATE_106) {
+        esp_err_t speed_ret = rc522_pcd_set_speed(rc522, RC522_PCD_SPEED_106, RC522_PCD_SPEED_106);
+        ret = ret == ESP_OK ? speed_ret : ret;
+
+        isodep->dsi = RC522_ISODEP_BITRATE_106;
+        isodep->dri = RC522_ISODEP_BITRATE_106;
+    }
+
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_ISODEP, ret);
+
+    return ret;
+}
@@ -49,6 +49,7 @@
 #include "rc522_helpers_internal.h"
 #include "rc522_pcd_internal.h"
 #include "rc522_picc_internal.h"
+#include "rc522_stats_internal.h"
 #include "picc/rc522_mifare.h"
 
 RC522_LOG_DEFINE_BASE();
@@ -158,8 +159,10 @@ esp_err_t rc522_mifare_auth(
         .pcd_command = RC522_PCD_MF_AUTH_CMD,
         .expected_interrupts = RC522_PCD_IDLE_IRQ_BIT,
         .bytes = { .ptr = send_data, .length = sizeof(send_data) },
+        .timeout_us = RC522_PICC_TIMEOUT_US_WRITE,
     };
 
+    RC522_STATS_BEGIN(rc522, span);
     esp_err_t ret = rc522_picc_send(rc522, &transaction, NULL);
 
     // 10.3.1.9
@@ -171,11 +174,17 @@ esp_err_t rc522_mifare_auth(
     // Timer interrupt fires before ProtocolErr bit is set to 1
     // so we will only check for Crypto1On bit (even if ret == ESP_OK)
     uint8_t status2;
-    RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, RC522_PCD_STATUS_2_REG, &status2));
+    esp_err_t status_ret = rc522_pcd_read(rc522, RC522_PCD_STATUS_2_REG, &status2);
 
-    if (!(status2 & RC522_PCD_MF_CRYPTO1_ON_BIT)) {
-        return RC522_ERR_MIFARE_AUTHENTICATION_FAILED;
+    if (status_ret != ESP_OK) {
+        ret = status_ret;
     }
+    else if (!(status2 & RC522_PCD_MF_CRYPTO1_ON_BIT)) {
+        ret = RC522_ERR_MIFARE_AUTHENTICATION_FAILED;
+    }
+
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_MIFARE_AUTH, ret);
+    RC522_RETURN_ON_ERROR(status_ret);
 
     return ret;
 }
@@ -189,34 +198,29 @@ esp_err_t rc522_mifare_read(const rc522_handle_t rc522, const rc522_picc_t *picc
 
     RC522_LOGD("MIFARE READ (block_address=%02" RC522_X ")", block_address);
 
-    uint8_t cmd_buffer[4] = { 0 };
-
-    // Build command buffer
-    cmd_buffer[0] = RC522_MIFARE_READ_CMD;
-    cmd_buffer[1] = block_address;
-
-    // Calculate CRC_A
-    rc522_pcd_crc_t crc = { 0 };
-    RC522_RETURN_ON_ERROR(rc522_pcd_calculate_crc(rc522, &(rc522_bytes_t) { .ptr = cmd_buffer, .length = 2 }, &crc));
-
-    cmd_buffer[2] = crc.lsb;
-    cmd_buffer[3] = crc.msb;
-
-    uint8_t block_buffer[RC522_MIFARE_BLOCK_SIZE + 2] = { 0 }; // +2 for CRC_A
+    uint8_t cmd_buffer[2] = { RC522_MIFARE_READ_CMD, block_address };
+    uint8_t block_buffer[RC522_MIFARE_BLOCK_SIZE] = { 0 };
 
+    // CRC_A is appended and verified by the PCD
     rc522_picc_transaction_t transaction = {
         .bytes = { .ptr = cmd_buffer, .length = sizeof(cmd_buffer) },
-        .check_crc = true,
+        .tx_crc = true,
+        .rx_crc = true,
+        .timeout_us = RC522_PICC_TIMEOUT_US_READ,
     };
 
     rc522_picc_transaction_result_t result = {
         .bytes = { .ptr = block_buffer, .length = sizeof(block_buffer) },
     };
 
-    RC522_RETURN_ON_ERROR(rc522_picc_transceive(rc522, &transaction, &result));
-    RC522_CHECK_AND_RETURN((result.bytes.length - 2) != RC522_MIFARE_BLOCK_SIZE, ESP_FAIL);
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_picc_transceive(rc522, &transaction, &result);
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_READ, ret);
+
+    RC522_RETURN_ON_ERROR(ret);
+    RC522_CHECK_AND_RETURN(result.bytes.length != RC522_MIFARE_BLOCK_SIZE, ESP_FAIL);
 
-    memcpy(out_buffer, block_buffer, sizeof(block_buffer) - 2); // -2 cuz of CRC_A
+    memcpy(out_buffer, block_buffer, sizeof(block_buffer));
 
     return ESP_OK;
 }
@@ -226,25 +230,15 @@ static esp_err_t rc522_mifare_send(const rc522_handle_t rc522, const uint8_t *se
     RC522_CHECK(send_data == NULL);
     RC522_CHECK(send_length > RC522_MIFARE_BLOCK_SIZE);
 
-#pragma GCC diagnostic ignored "-Wcast-qual"
-    uint8_t *sdata = (uint8_t *)send_data;
-#pragma GCC diagnostic pop
-
-    rc522_pcd_crc_t crc = { 0 };
-    RC522_RETURN_ON_ERROR(
-        rc522_pcd_calculate_crc(rc522, &(rc522_bytes_t) { .ptr = sdata, .length = send_length }, &crc));
-
-    uint8_t buffer[RC522_MIFARE_BLOCK_SIZE + 2]; // +2 for CRC_A
+    uint8_t buffer[RC522_MIFARE_BLOCK_SIZE];
 
     memcpy(buffer, send_data, send_length);
 
-    buffer[send_length] = crc.lsb;
-    buffer[send_length + 1] = crc.msb;
-
-    send_length += 2;
-
+    // CRC_A is appended by the PCD. The response is a 4 bit ACK/NAK without CRC_A
     rc522_picc_transaction_t transaction = {
         .bytes = { .ptr = buffer, .length = send_length },
+        .tx_crc = true,
+        .timeout_us = RC522_PICC_TIMEOUT_US_WRITE,
     };
 
     rc522_picc_transaction_result_t result = {
@@ -412,8 +406,15 @@ esp_err_t rc522_mifare_write(const rc522_handle_t rc522, const rc522_picc_t *pic
 
     uint8_t cmd_buffer[] = { RC522_MIFARE_WRITE_CMD, block_address };
 
-    RC522_RETURN_ON_ERROR(rc522_mifare_send(rc522, cmd_buffer, sizeof(cmd_buffer)));
-    RC522_RETURN_ON_ERROR(rc522_mifare_send(rc522, buffer, RC522_MIFARE_BLOCK_SIZE));
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_mifare_send(rc522, cmd_buffer, sizeof(cmd_buffer));
+
+    if (ret == ESP_OK) {
+        ret = rc522_mifare_send(rc522, buffer, RC522_MIFARE_BLOCK_SIZE);
+    }
+
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_WRITE, ret);
+    RC522_RETURN_ON_ERROR(ret);
 
     return ESP_OK;
 }
@@ -4,7 +4,9 @@
 #include "rc522_helpers_internal.h"
 #include "rc522_pcd_internal.h"
 #include "rc522_picc_internal.h"
-#include "picc/rc522_ntag.h"
+#include "rc522_stats_internal.h"
+#include "rc522_ntag_internal.h"
+#include "picc/rc522_mifare.h"
 
 #define TAG "NTAG"
 
@@ -19,9 +21,54 @@ enum
      * Writes one 16 byte block to the authenticated sector of the PICC
      */
     RC522_NTAG_WRITE_CMD = 0xA0,
+
+    /**
+     * Writes one page
+     */
+    RC522_NTAG_WRITE_PAGE_CMD = 0xA2,
+
+    /**
+     * Reads all pages from the start address to the end address
+     */
+    RC522_NTAG_FAST_READ_CMD = 0x3A,
+
+    /**
+     * Returns the product version (NTAG21x, Ultralight EV1)
+     */
+    RC522_NTAG_GET_VERSION_CMD = 0x60,
 };
 
 
+/**
+ * READ of the four pages from the page address, rolled over to page 0 at the end of the memory
+ */
+static esp_err_t rc522_ntag_read_block(const rc522_handle_t rc522, uint8_t page_address,
+    uint8_t out_buffer[NTAG_PAGE_READ_SIZE])
+{
+    uint8_t cmd_buffer[2] = { RC522_NTAG_READ_CMD, page_address };
+
+    // CRC_A is appended and verified by the PCD
+    rc522_picc_transaction_t transaction = {
+        .bytes = { .ptr = cmd_buffer, .length = sizeof(cmd_buffer) },
+        .tx_crc = true,
+        .rx_crc = true,
+        .timeout_us = RC522_PICC_TIMEOUT_US_READ,
+    };
+
+    rc522_picc_transaction_result_t result = {
+        .bytes = { .ptr = out_buffer, .length = NTAG_PAGE_READ_SIZE },
+    };
+
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_picc_transceive(rc522, &transaction, &result);
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_READ, ret);
+
+    RC522_RETURN_ON_ERROR(ret);
+    RC522_CHECK_AND_RETURN(result.bytes.length != NTAG_PAGE_READ_SIZE, ESP_FAIL);
+
+    return ESP_OK;
+}
+
 esp_err_t rc522_ntag_read(const rc522_handle_t rc522, const rc522_picc_t *picc, uint8_t page_address,
     uint8_t out_buffer[NTAG_PAGE_SIZE])
 {
@@ -31,59 +78,394 @@ esp_err_t rc522_ntag_read(const rc522_handle_t rc522, const rc522_picc_t *picc,
 
     RC522_LOGD("NTAG READ (page_address=%02" RC522_X ")", page_address);
 
-    uint8_t cmd_buffer[4] = { 0 };
+    uint8_t block_buffer[NTAG_PAGE_READ_SIZE] = { 0 };
 
-    // Build command buffer
-    cmd_buffer[0] = RC522_NTAG_READ_CMD;
-    cmd_buffer[1] = page_address;
+    RC522_RETURN_ON_ERROR(rc522_ntag_read_block(rc522, page_address, block_buffer));
 
-    // Calculate CRC_A
-    rc522_pcd_crc_t crc = { 0 };
-    RC522_RETURN_ON_ERROR(rc522_pcd_calculate_crc(rc522, &(rc522_bytes_t) { .ptr = cmd_buffer, .length = 2 }, &crc));
+    memcpy(out_buffer, block_buffer, NTAG_PAGE_SIZE); // Only the first page is used
 
-    cmd_buffer[2] = crc.lsb;
-    cmd_buffer[3] = crc.msb;
+    return ESP_OK;
+}
 
-    uint8_t block_buffer[NTAG_PAGE_READ_SIZE + 2] = { 0 }; // +2 for CRC_A
+/**
+ * FAST_READ of the pages which fit into one frame
+ */
+static esp_err_t rc522_ntag_fast_read_frame(
+    const rc522_handle_t rc522, uint8_t start_page, uint8_t end_page, uint8_t *out_buffer)
+{
+    uint8_t cmd_buffer[3] = { RC522_NTAG_FAST_READ_CMD, start_page, end_page };
+    uint8_t length = (end_page - start_page + 1) * NTAG_PAGE_SIZE;
 
+    // CRC_A is appended and verified by the PCD
     rc522_picc_transaction_t transaction = {
         .bytes = { .ptr = cmd_buffer, .length = sizeof(cmd_buffer) },
-        .check_crc = true,
+        .tx_crc = true,
+        .rx_crc = true,
+        .timeout_us = RC522_PICC_TIMEOUT_US_READ,
     };
 
     rc522_picc_transaction_result_t result = {
-        .bytes = { .ptr = block_buffer, .length = sizeof(block_buffer) },
+        .bytes = { .ptr = out_buffer, .length = length },
     };
 
-    RC522_RETURN_ON_ERROR(rc522_picc_transceive(rc522, &transaction, &result));
-    RC522_CHECK_AND_RETURN((result.bytes.length - 2) != NTAG_PAGE_READ_SIZE, ESP_FAIL);
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_picc_transceive(rc522, &transaction, &result);
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_READ, ret);
+
+    RC522_RETURN_ON_ERROR(ret);
+    RC522_CHECK_AND_RETURN(result.bytes.length != length, ESP_FAIL);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_ntag_fast_read(const rc522_handle_t rc522, const rc522_picc_t *picc, uint8_t start_page,
+    uint8_t end_page, uint8_t *out_buffer)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(picc == NULL);
+    RC522_CHECK(out_buffer == NULL);
+    RC522_CHECK(end_page < start_page);
+
+    RC522_LOGD("NTAG FAST_READ (start_page=%02" RC522_X ", end_page=%02" RC522_X ")", start_page, end_page);
 
-    memcpy(out_buffer, block_buffer, NTAG_PAGE_SIZE); // -2 cuz of CRC_A
+    for (uint16_t page = start_page; page <= end_page; page += NTAG_FAST_READ_PAGES_MAX) {
+        uint16_t last_page = page + NTAG_FAST_READ_PAGES_MAX - 1;
+
+        RC522_RETURN_ON_ERROR(rc522_ntag_fast_read_frame(rc522,
+            page,
+            last_page < end_page ? last_page : end_page,
+            out_buffer + (page - start_page) * NTAG_PAGE_SIZE));
+    }
 
     return ESP_OK;
 }
 
+/**
+ * FAST_READ is supported by the PICCs which answer GET_VERSION. The original MIFARE Ultralight,
+ * Ultralight C and NTAG203 do not answer it and fall back to IDLE, so they are selected again.
+ * The answer is kept for the last PICC asked.
+ */
+static esp_err_t rc522_ntag_supports_fast_read(const rc522_handle_t rc522, const rc522_picc_t *picc, bool *out_result)
+{
+    if (rc522->ntag_version_uid.length == picc->uid.length
+        && memcmp(rc522->ntag_version_uid.value, picc->uid.value, picc->uid.length) == 0) {
+        *out_result = rc522->ntag_fast_read;
+        return ESP_OK;
+    }
+
+    RC522_LOGD("NTAG GET_VERSION");
+
+    uint8_t cmd_buffer[1] = { RC522_NTAG_GET_VERSION_CMD };
+    uint8_t version[RC522_NTAG_VERSION_SIZE];
+
+    // CRC_A is appended and verified by the PCD
+    rc522_picc_transaction_t transaction = {
+        .bytes = { .ptr = cmd_buffer, .length = sizeof(cmd_buffer) },
+        .tx_crc = true,
+        .rx_crc = true,
+        .timeout_us = RC522_PICC_TIMEOUT_US_READ,
+    };
+
+    rc522_picc_transaction_result_t result = {
+        .bytes = { .ptr = version, .length = sizeof(version) },
+    };
+
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_picc_transceive(rc522, &transaction, &result);
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_READ, ret);
+
+    bool supported = (ret == ESP_OK && result.bytes.length == sizeof(version));
+
+    if (!supported) {
+        RC522_RETURN_ON_ERROR(rc522_picc_reselect(rc522, picc));
+    }
+
+    memcpy(&rc522->ntag_version_uid, &picc->uid, sizeof(rc522_picc_uid_t));
+    rc522->ntag_fast_read = supported;
+    *out_result = supported;
+
+    return ESP_OK;
+}
+
+#if CONFIG_RC522_NTAG_CACHE
+static inline bool rc522_ntag_cache_page_is_valid(const rc522_ntag_cache_t *cache, uint16_t page)
+{
+    return (cache->valid[page / 32] >> (page % 32)) & 1;
+}
+
+static inline bool rc522_ntag_cache_belongs_to(const rc522_ntag_cache_t *cache, const rc522_picc_t *picc)
+{
+    return cache->uid.length != 0 && cache->uid.length == picc->uid.length
+        && memcmp(cache->uid.value, picc->uid.value, picc->uid.length) == 0;
+}
+
+static void rc522_ntag_cache_store(rc522_ntag_cache_t *cache, uint16_t page, const uint8_t *pages, uint16_t count)
+{
+    for (uint16_t i = page; i < page + count && i < cache->page_count; i++) {
+        memcpy(cache->memory + i * NTAG_PAGE_SIZE, pages + (i - page) * NTAG_PAGE_SIZE, NTAG_PAGE_SIZE);
+        cache->valid[i / 32] |= 1UL << (i % 32);
+    }
+}
+
+static void rc522_ntag_cache_drop_page(rc522_ntag_cache_t *cache, const rc522_picc_t *picc, uint8_t page)
+{
+    if (!rc522_ntag_cache_belongs_to(cache, picc)) {
+        return;
+    }
+
+    if (page == RC522_NTAG_CC_PAGE) {
+        cache->uid.length = 0; // Size of the data area may change
+    }
+    else if (page < cache->page_count) {
+        cache->valid[page / 32] &= ~(1UL << (page % 32));
+    }
+}
+#endif
+
+esp_err_t rc522_ntag_write(const rc522_handle_t rc522, const rc522_picc_t *picc, uint8_t page_address,
+    const uint8_t buffer[NTAG_PAGE_SIZE])
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(picc == NULL);
+    RC522_CHECK(buffer == NULL);
+
+    RC522_LOGD("NTAG WRITE (page_address=%02" RC522_X ")", page_address);
+
+    uint8_t cmd_buffer[2 + NTAG_PAGE_SIZE] = { RC522_NTAG_WRITE_PAGE_CMD, page_address };
+    memcpy(cmd_buffer + 2, buffer, NTAG_PAGE_SIZE);
+
+    uint8_t ack = 0;
+
+    // CRC_A is appended by the PCD. The response is a 4 bit ACK/NAK without CRC_A
+    rc522_picc_transaction_t transaction = {
+        .bytes = { .ptr = cmd_buffer, .length = sizeof(cmd_buffer) },
+        .tx_crc = true,
+        .timeout_us = RC522_PICC_TIMEOUT_US_WRITE,
+    };
+
+    rc522_picc_transaction_result_t result = {
+        .bytes = { .ptr = &ack, .length = sizeof(ack) },
+    };
+
+#if CONFIG_RC522_NTAG_CACHE
+    // Content of the page is unknown even if the write fails
+    rc522_ntag_cache_drop_page(&rc522->ntag_cache, picc, page_address);
+#endif
+
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_picc_transceive(rc522, &transaction, &result);
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_WRITE, ret);
+
+    RC522_RETURN_ON_ERROR(ret);
+    RC522_CHECK_AND_RETURN(result.bytes.length != 1 || result.valid_bits != 4, ESP_FAIL);
+    RC522_CHECK_AND_RETURN(ack != RC522_MIFARE_ACK, RC522_ERR_MIFARE_NACK);
+
+    return ESP_OK;
+}
+
+#if CONFIG_RC522_NTAG_CACHE
+/**
+ * Starts the cache over if it belongs to another PICC. Pages 0 to 3 are read with one READ,
+ * the Capability Container (page 3) limits the cached pages to the end of the data area.
+ */
+static esp_err_t rc522_ntag_cache_attach(const rc522_handle_t rc522, const rc522_picc_t *picc)
+{
+    rc522_ntag_cache_t *cache = &rc522->ntag_cache;
+
+    if (rc522_ntag_cache_belongs_to(cache, picc)) {
+        return ESP_OK;
+    }
+
+    uint8_t block[NTAG_PAGE_READ_SIZE];
+
+    cache->uid.length = 0;
+    memset(cache->valid, 0, sizeof(cache->valid));
+
+    RC522_RETURN_ON_ERROR(rc522_ntag_read_block(rc522, 0, block));
+
+    const uint8_t *cc = block + RC522_NTAG_CC_PAGE * NTAG_PAGE_SIZE;
+    uint16_t page_count = RC522_NTAG_CC_PAGE + 1;
+
+    if (cc[0] == RC522_NTAG_CC_MAGIC) {
+        page_count += cc[2] * 8 / NTAG_PAGE_SIZE; // Byte 2 is the size of the data area divided by 8
+    }
+
+    cache->page_count = page_count < NTAG_CACHE_PAGES_MAX ? page_count : NTAG_CACHE_PAGES_MAX;
+    rc522_ntag_cache_store(cache, 0, block, NTAG_PAGE_READ_SIZE / NTAG_PAGE_SIZE);
+    memcpy(&cache->uid, &picc->uid, sizeof(rc522_picc_uid_t));
+
+    return ESP_OK;
+}
+
+/**
+ * Reads the missing pages from the start page to the end page (excluded). Gaps of up to four pages
+ * are read with READ, longer ones with FAST_READ rounded up to four pages (READ if the PICC does not
+ * support it), both ahead of the end page.
+ */
+static esp_err_t rc522_ntag_cache_fill(
+    const rc522_handle_t rc522, const rc522_picc_t *picc, uint16_t start_page, uint16_t end_page)
+{
+    rc522_ntag_cache_t *cache = &rc522->ntag_cache;
+    const uint16_t block_pages = NTAG_PAGE_READ_SIZE / NTAG_PAGE_SIZE;
+    uint16_t page = start_page;
+
+    while (page < end_page) {
+        if (rc522_ntag_cache_page_is_valid(cache, page)) {
+            page++;
+            continue;
+        }
+
+        uint16_t gap_end = page + 1;
+
+        while (gap_end < end_page && !rc522_ntag_cache_page_is_valid(cache, gap_end)) {
+            gap_end++;
+        }
+
+        bool fast_read = false;
+
+        if (gap_end - page > block_pages) {
+            RC522_RETURN_ON_ERROR(rc522_ntag_supports_fast_read(rc522, picc, &fast_read));
+        }
+
+        if (!fast_read) {
+            uint8_t block[NTAG_PAGE_READ_SIZE];
+
+            RC522_RETURN_ON_ERROR(rc522_ntag_read_block(rc522, page, block));
+            rc522_ntag_cache_store(cache, page, block, block_pages);
+            page += block_pages;
+            continue;
+        }
+
+        uint16_t last_page = page + (gap_end - page + block_pages - 1) / block_pages * block_pages - 1;
+
+        if (last_page >= cache->page_count) {
+            last_page = cache->page_count - 1;
+        }
+
+        // Page count is limited to NTAG_CACHE_PAGES_MAX, so the pages are read right into the cache
+        RC522_RETURN_ON_ERROR(
+            rc522_ntag_fast_read(rc522, picc, page, last_page, cache->memory + page * NTAG_PAGE_SIZE));
+
+        for (; page <= last_page; page++) {
+            cache->valid[page / 32] |= 1UL << (page % 32);
+        }
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @return ESP_ERR_NOT_FOUND if the range is not within the cached pages
+ */
+static esp_err_t rc522_ntag_cache_read(
+    const rc522_handle_t rc522, const rc522_picc_t *picc, uint16_t address, uint8_t *out_buffer, int len)
+{
+    rc522_ntag_cache_t *cache = &rc522->ntag_cache;
+    uint16_t start_page = address / NTAG_PAGE_SIZE;
+    uint16_t end_page = (address + len + NTAG_PAGE_SIZE - 1) / NTAG_PAGE_SIZE;
+    bool hit = rc522_ntag_cache_belongs_to(cache, picc);
+
+    RC522_RETURN_ON_ERROR(rc522_ntag_cache_attach(rc522, picc));
+
+    if (end_page > cache->page_count) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    for (uint16_t page = start_page; page < end_page && hit; page++) {
+        hit = rc522_ntag_cache_page_is_valid(cache, page);
+    }
+
+    if (hit) {
+        cache->stats.hits++;
+    }
+    else {
+        cache->stats.misses++;
+        RC522_RETURN_ON_ERROR(rc522_ntag_cache_fill(rc522, picc, start_page, end_page));
+    }
+
+    memcpy(out_buffer, cache->memory + address, len);
+
+    return ESP_OK;
+}
+
+void rc522_ntag_cache_forget(const rc522_handle_t rc522, const rc522_picc_t *picc)
+{
+    rc522_ntag_cache_t *cache = &rc522->ntag_cache;
+
+    if (rc522_ntag_cache_belongs_to(cache, picc)) {
+        cache->uid.length = 0;
+    }
+}
+
+esp_err_t rc522_ntag_cache_invalidate(const rc522_handle_t rc522)
+{
+    RC522_CHECK(rc522 == NULL);
+
+    rc522->ntag_cache.uid.length = 0;
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_ntag_get_cache_stats(const rc522_handle_t rc522, rc522_ntag_cache_stats_t *out_stats)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(out_stats == NULL);
+
+    memcpy(out_stats, &rc522->ntag_cache.stats, sizeof(rc522_ntag_cache_stats_t));
+
+    return ESP_OK;
+}
+#endif
+
 // Function to read NTAG across multiple pages
 esp_err_t rc522_ntag_readn(const rc522_handle_t rc522, const rc522_picc_t *picc, uint16_t address, uint8_t *out_buffer, int len) {
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(picc == NULL);
+    RC522_CHECK(out_buffer == NULL);
+    RC522_CHECK(len < 0);
+    RC522_CHECK((address + len) > (UINT8_MAX + 1) * NTAG_PAGE_SIZE);
+
+#if CONFIG_RC522_NTAG_CACHE
+    esp_err_t ret = rc522_ntag_cache_read(rc522, picc, address, out_buffer, len);
+
+    // Ranges beyond the data area, e.g. the configuration pages, are not cached
+    if (ret != ESP_ERR_NOT_FOUND) {
+        return ret;
+    }
+#endif
+
     int bytes_read = 0;
+    bool fast_read = false;
+
+    if (address % NTAG_PAGE_SIZE + len > NTAG_PAGE_READ_SIZE) {
+        RC522_RETURN_ON_ERROR(rc522_ntag_supports_fast_read(rc522, picc, &fast_read));
+    }
 
+    // Whole pages are read by FAST_READ (or READ if not supported), one frame at a time
     while (bytes_read < len) {
-        uint8_t read_buffer[NTAG_PAGE_SIZE];
+        uint8_t read_buffer[NTAG_FAST_READ_PAGES_MAX * NTAG_PAGE_SIZE];
 
         // Convert byte address to page address
-        uint8_t page_address = address / NTAG_PAGE_SIZE;
+        uint8_t start_page = address / NTAG_PAGE_SIZE;
         int page_offset = address % NTAG_PAGE_SIZE;
+        int remaining_bytes = len - bytes_read;
+        int pages = (page_offset + remaining_bytes + NTAG_PAGE_SIZE - 1) / NTAG_PAGE_SIZE;
+
+        int pages_max = fast_read ? NTAG_FAST_READ_PAGES_MAX : NTAG_PAGE_READ_SIZE / NTAG_PAGE_SIZE;
 
-        // Read the current page
-        esp_err_t err = rc522_ntag_read(rc522, picc, page_address, read_buffer);
+        if (pages > pages_max) {
+            pages = pages_max;
+        }
+
+        esp_err_t err = fast_read ? rc522_ntag_fast_read(rc522, picc, start_page, start_page + pages - 1, read_buffer)
+                                  : rc522_ntag_read_block(rc522, start_page, read_buffer);
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to read page at address %d", page_address);
+            ESP_LOGE(TAG, "Failed to read pages at address %d", start_page);
             return err;
         }
 
-        // Calculate the number of bytes to copy from the current page
-        int remaining_bytes = len - bytes_read;
-        int bytes_to_copy = (remaining_bytes > (NTAG_PAGE_SIZE - page_offset)) ? (NTAG_PAGE_SIZE - page_offset) : remaining_bytes;
+        // Calculate the number of bytes to copy from the pages read
+        int bytes_to_copy = (remaining_bytes > (pages * NTAG_PAGE_SIZE - page_offset)) ? (pages * NTAG_PAGE_SIZE - page_offset) : remaining_bytes;
 
         // Copy the required data into the output buffer
         memcpy(out_buffer + bytes_read, read_buffer + page_offset, bytes_to_copy);
@@ -143,6 +525,7 @@ NDEFHeader parse_header(uint8_t byte) {
     return header;
 }
 
+#if !CONFIG_RC522_STATIC_ALLOCATION // NDEF records are allocated on the heap
 // Function to create a new NDEF record node
 ndef_record *create_ndef_record(NDEFHeader header, uint32_t payload_length, uint8_t type_length, uint8_t id_length, uint8_t lang_code_length, uint8_t *lang_code, uint8_t *type, uint8_t *id, uint8_t *payload) {
     ndef_record *record = (ndef_record *)malloc(sizeof(ndef_record));
@@ -231,6 +614,8 @@ ndef_record *parse_ndef_records(uint8_t *data, size_t length) {
 
     return head;
 }
+#endif
+
 // Function to print the parsed NDEF records
 void print_ndef_records(ndef_record *head) {
     ndef_record *current = head;
@@ -261,6 +646,7 @@ void print_ndef_records(ndef_record *head) {
     }
 }
 
+#if !CONFIG_RC522_STATIC_ALLOCATION // NDEF records are allocated on the heap
 // Function to free the linked list of NDEF records
 void free_ndef_records(ndef_record *head) {
     ndef_record *current = head;
@@ -283,7 +669,7 @@ void free_ndef_records(ndef_record *head) {
  */
 esp_err_t ntag_read_ndef(const rc522_handle_t rc522, const rc522_picc_t *picc, uint8_t **dataptr, ndef_record **records) {
     ntag_tvl_info_t ntag_tvl_info;
-    ntag_get_tlv_info(rc522, picc, &ntag_tvl_info);
+    ESP_RETURN_ON_ERROR(ntag_get_tlv_info(rc522, picc, &ntag_tvl_info), TAG, "Get TLV info failed");
 
     if (ntag_tvl_info.blocklen <= 0) {
         return ESP_ERR_INVALID_SIZE;
@@ -294,11 +680,18 @@ esp_err_t ntag_read_ndef(const rc522_handle_t rc522, const rc522_picc_t *picc, u
         return ESP_ERR_NO_MEM;
     }
 
-    ESP_RETURN_ON_ERROR(rc522_ntag_readn(rc522, picc, ntag_tvl_info.start_addr, *dataptr, ntag_tvl_info.blocklen), TAG, "Read NTAG failed");
+    esp_err_t ret = rc522_ntag_readn(rc522, picc, ntag_tvl_info.start_addr, *dataptr, ntag_tvl_info.blocklen);
+    if (ret != ESP_OK) {
+        free(*dataptr);
+        *dataptr = NULL;
+        ESP_LOGE(TAG, "Read NTAG failed");
+        return ret;
+    }
 
     *records = parse_ndef_records(*dataptr, ntag_tvl_info.blocklen);
 
     print_ndef_records(*records);
 
     return ESP_OK;
-}
\ No newline at end of file
+}
+#endif
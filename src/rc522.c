@@ -6,12 +6,20 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
+#include <freertos/queue.h>
 
 #include "rc522_pcd_internal.h"
 #include "rc522_picc_internal.h"
 #include "rc522_helpers_internal.h"
 #include "rc522_types_internal.h"
 #include "rc522_internal.h"
+#include "rc522_stats_internal.h"
+#include "rc522_scheduler_internal.h"
+#include "rc522_group_internal.h"
+#include "rc522_arbiter_internal.h"
+#include "rc522_dispatcher_internal.h"
+#include "rc522_op_internal.h"
+#include "rc522_detect_internal.h"
 
 RC522_LOG_DEFINE_BASE();
 
@@ -22,11 +30,8 @@ inline static bool rc522_is_able_to_start(const rc522_handle_t rc522)
     return rc522->state >= RC522_STATE_CREATED && rc522->state != RC522_STATE_POLLING;
 }
 
-static esp_err_t rc522_clone_config(const rc522_config_t *config, rc522_config_t **result)
+static esp_err_t rc522_clone_config(const rc522_config_t *config, rc522_config_t *config_clone)
 {
-    rc522_config_t *config_clone = calloc(1, sizeof(rc522_config_t));
-    RC522_CHECK_AND_RETURN(config_clone == NULL, ESP_ERR_NO_MEM);
-
     memcpy(config_clone, config, sizeof(rc522_config_t));
 
     // defaults
@@ -41,13 +46,100 @@ static esp_err_t rc522_clone_config(const rc522_config_t *config, rc522_config_t
     if (config_clone->task_priority == 0) {
         config_clone->task_priority = RC522_TASK_PRIORITY_DEFAULT;
     }
-    // ~defaults
 
-    *result = config_clone;
+    if (config_clone->dispatcher.task_stack_size == 0) {
+        config_clone->dispatcher.task_stack_size = RC522_TASK_STACK_SIZE_DEFAULT;
+    }
+
+    if (config_clone->dispatcher.task_priority == 0) {
+        config_clone->dispatcher.task_priority = RC522_TASK_PRIORITY_DEFAULT;
+    }
+
+    if (config_clone->scan_interval_floor_ms == 0) {
+        config_clone->scan_interval_floor_ms = RC522_SCAN_INTERVAL_MS_FLOOR_DEFAULT;
+    }
+
+    if (config_clone->scan_interval_ceiling_ms == 0) {
+        config_clone->scan_interval_ceiling_ms = RC522_SCAN_INTERVAL_MS_CEILING_DEFAULT;
+    }
+
+    if (config_clone->scan_interval_ceiling_ms < config_clone->scan_interval_floor_ms) {
+        config_clone->scan_interval_ceiling_ms = config_clone->scan_interval_floor_ms;
+    }
+
+    if (config_clone->scan_backoff_after_ms == 0) {
+        config_clone->scan_backoff_after_ms = RC522_SCAN_BACKOFF_AFTER_MS_DEFAULT;
+    }
+
+    rc522_presence_check_config_t *presence_check = &config_clone->presence_check;
+    bool select = presence_check->mode == RC522_PRESENCE_CHECK_SELECT;
+
+    if (presence_check->interval_ms == 0) {
+        presence_check->interval_ms = select ? RC522_PRESENCE_CHECK_SELECT_INTERVAL_MS_DEFAULT
+                                             : RC522_PRESENCE_CHECK_INTERVAL_MS_DEFAULT;
+    }
+
+    if (presence_check->failure_threshold == 0) {
+        presence_check->failure_threshold = select ? RC522_PRESENCE_CHECK_SELECT_THRESHOLD_DEFAULT
+                                                   : RC522_PRESENCE_CHECK_THRESHOLD_DEFAULT;
+    }
+    // ~defaults
 
     return ESP_OK;
 }
 
+#if CONFIG_RC522_STATIC_ALLOCATION
+esp_err_t rc522_register_events(
+    const rc522_handle_t rc522, rc522_event_t event, esp_event_handler_t event_handler, void *event_handler_arg)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(event_handler == NULL);
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+
+    taskENTER_CRITICAL(&rc522->handlers_lock);
+
+    for (uint8_t i = 0; i < CONFIG_RC522_EVENT_HANDLERS_MAX; i++) {
+        rc522_event_handler_entry_t *entry = &rc522->handlers[i];
+
+        if (entry->handler == NULL) {
+            entry->event = event;
+            entry->handler = event_handler;
+            entry->arg = event_handler_arg;
+            ret = ESP_OK;
+            break;
+        }
+    }
+
+    taskEXIT_CRITICAL(&rc522->handlers_lock);
+
+    if (ret != ESP_OK) {
+        RC522_LOGE("no free event handler entry, increase CONFIG_RC522_EVENT_HANDLERS_MAX");
+    }
+
+    return ret;
+}
+
+esp_err_t rc522_unregister_events(const rc522_handle_t rc522, rc522_event_t event, esp_event_handler_t event_handler)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(event_handler == NULL);
+
+    taskENTER_CRITICAL(&rc522->handlers_lock);
+
+    for (uint8_t i = 0; i < CONFIG_RC522_EVENT_HANDLERS_MAX; i++) {
+        rc522_event_handler_entry_t *entry = &rc522->handlers[i];
+
+        if (entry->handler == event_handler && entry->event == event) {
+            entry->handler = NULL;
+        }
+    }
+
+    taskEXIT_CRITICAL(&rc522->handlers_lock);
+
+    return ESP_OK;
+}
+#else
 esp_err_t rc522_register_events(
     const rc522_handle_t rc522, rc522_event_t event, esp_event_handler_t event_handler, void *event_handler_arg)
 {
@@ -64,6 +156,7 @@ esp_err_t rc522_unregister_events(const rc522_handle_t rc522, rc522_event_t even
 
     return esp_event_handler_unregister_with(rc522->event_handle, RC522_EVENTS, event, event_handler);
 }
+#endif
 
 esp_err_t rc522_start(rc522_handle_t rc522)
 {
@@ -114,41 +207,87 @@ inline static void rc522_request_task_to_exit(const rc522_handle_t rc522)
     rc522->exit_requested = true; // task will delete itself
 }
 
-esp_err_t rc522_create(const rc522_config_t *config, rc522_handle_t *out_rc522)
+/**
+ * Initializes zeroed handle storage. The polling task is created
+ * from the static buffers if they are provided, otherwise on the heap.
+ */
+static esp_err_t rc522_init(
+    rc522_handle_t rc522, const rc522_config_t *config, rc522_static_t *buffers, rc522_handle_t *out_rc522)
 {
-    RC522_CHECK(config == NULL);
-    RC522_CHECK(out_rc522 == NULL);
-
-    rc522_handle_t rc522 = calloc(1, sizeof(struct rc522));
-    ESP_RETURN_ON_FALSE(rc522 != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
-
+    rc522->is_static = buffers != NULL;
     rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_IDLE, false);
 
+#if CONFIG_RC522_STATS
+    portMUX_INITIALIZE(&rc522->stats_lock);
+#endif
+
     esp_err_t ret = ESP_OK;
 
-    ESP_GOTO_ON_ERROR(rc522_clone_config(config, &(rc522->config)), _error, TAG, "clone config failed");
+    ESP_GOTO_ON_ERROR(rc522_clone_config(config, &rc522->config_buffer), _error, TAG, "clone config failed");
+    rc522->config = &rc522->config_buffer;
+
+    ESP_GOTO_ON_ERROR(rc522_detect_validate_plans(config->detect_plans, config->detect_plan_count),
+        _error,
+        TAG,
+        "invalid detect plans");
 
+#if CONFIG_RC522_STATIC_ALLOCATION
+    portMUX_INITIALIZE(&rc522->handlers_lock);
+#else
     esp_event_loop_args_t event_args = {
         .queue_size = 1,
         .task_name = NULL, // no task will be created
     };
 
-    rc522->bits = xEventGroupCreate();
-    ESP_GOTO_ON_FALSE(rc522->bits != NULL, ESP_ERR_NO_MEM, _error, TAG, "nomem");
-
     ESP_GOTO_ON_ERROR(esp_event_loop_create(&event_args, &rc522->event_handle),
         _error,
         TAG,
         "Failed to create event loop");
+#endif
 
-    BaseType_t task_create_result = xTaskCreate(rc522_task,
-        "rc522_polling_task",
-        rc522->config->task_stack_size,
-        rc522,
-        rc522->config->task_priority,
-        &rc522->task_handle);
+    rc522->ops = xQueueCreateStatic(RC522_OP_QUEUE_SIZE, sizeof(rc522_op_t *), rc522->ops_storage, &rc522->ops_buffer);
+    ESP_GOTO_ON_FALSE(rc522->ops != NULL, ESP_ERR_NO_MEM, _error, TAG, "nomem");
 
-    ESP_GOTO_ON_FALSE(task_create_result == pdTRUE, ESP_FAIL, _error, TAG, "task create failed");
+    if (rc522->config->dispatcher.enabled) {
+        ESP_GOTO_ON_ERROR(rc522_dispatcher_create(rc522, &rc522->dispatcher),
+            _error,
+            TAG,
+            "dispatcher create failed");
+    }
+
+    if (rc522->config->arbiter != NULL) {
+        ESP_GOTO_ON_ERROR(rc522_arbiter_attach(rc522->config->arbiter, rc522), _error, TAG, "arbiter attach failed");
+    }
+
+    if (rc522->config->group != NULL) {
+        ESP_GOTO_ON_ERROR(rc522_group_attach(rc522->config->group, rc522), _error, TAG, "group attach failed");
+        goto _success;
+    }
+
+    rc522->bits = xEventGroupCreateStatic(&rc522->bits_buffer);
+    ESP_GOTO_ON_FALSE(rc522->bits != NULL, ESP_ERR_NO_MEM, _error, TAG, "nomem");
+
+    if (buffers != NULL) {
+        rc522->task_handle = xTaskCreateStatic(rc522_task,
+            "rc522_polling_task",
+            rc522->config->task_stack_size,
+            rc522,
+            rc522->config->task_priority,
+            buffers->task_stack,
+            &buffers->task);
+
+        ESP_GOTO_ON_FALSE(rc522->task_handle != NULL, ESP_FAIL, _error, TAG, "task create failed");
+    }
+    else {
+        BaseType_t task_create_result = xTaskCreate(rc522_task,
+            "rc522_polling_task",
+            rc522->config->task_stack_size,
+            rc522,
+            rc522->config->task_priority,
+            &rc522->task_handle);
+
+        ESP_GOTO_ON_FALSE(task_create_result == pdTRUE, ESP_FAIL, _error, TAG, "task create failed");
+    }
 
     goto _success;
 _error:
@@ -162,23 +301,81 @@ _return:
     return ret;
 }
 
+esp_err_t rc522_create(const rc522_config_t *config, rc522_handle_t *out_rc522)
+{
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(out_rc522 == NULL);
+
+    rc522_handle_t rc522 = calloc(1, sizeof(struct rc522));
+    ESP_RETURN_ON_FALSE(rc522 != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
+
+    return rc522_init(rc522, config, NULL, out_rc522);
+}
+
+_Static_assert(sizeof(struct rc522) <= sizeof(((rc522_static_t *)0)->handle), "RC522_STATIC_HANDLE_SIZE is too small");
+
+esp_err_t rc522_create_static(const rc522_config_t *config, rc522_static_t *buffers, rc522_handle_t *out_rc522)
+{
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(buffers == NULL);
+    RC522_CHECK(out_rc522 == NULL);
+    RC522_CHECK(config->group == NULL && (buffers->task_stack == NULL || config->task_stack_size == 0));
+    RC522_CHECK_AND_RETURN(config->dispatcher.enabled, ESP_ERR_NOT_SUPPORTED);
+
+    rc522_handle_t rc522 = (rc522_handle_t)buffers->handle;
+    memset(rc522, 0, sizeof(struct rc522));
+
+    return rc522_init(rc522, config, buffers, out_rc522);
+}
+
 esp_err_t rc522_destroy(rc522_handle_t rc522)
 {
     RC522_CHECK(rc522 == NULL);
 
-    ESP_RETURN_ON_FALSE(xTaskGetCurrentTaskHandle() != rc522->task_handle,
+    ESP_RETURN_ON_FALSE(rc522->dispatcher == NULL || !rc522_dispatcher_is_current_task(rc522->dispatcher),
         ESP_ERR_INVALID_STATE,
         TAG,
         "Cannot destroy from event handler");
 
-    rc522_request_task_to_exit(rc522);
+    if (rc522->config != NULL && rc522->config->group != NULL) {
+        RC522_RETURN_ON_ERROR(rc522_group_detach(rc522->config->group, rc522));
+    }
+    else {
+        ESP_RETURN_ON_FALSE(xTaskGetCurrentTaskHandle() != rc522->task_handle,
+            ESP_ERR_INVALID_STATE,
+            TAG,
+            "Cannot destroy from event handler");
+
+        rc522_request_task_to_exit(rc522);
+    }
 
     if (rc522->bits) {
-        xEventGroupWaitBits(rc522->bits, RC522_TASK_STOPPED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+        if (rc522->task_handle != NULL) {
+            xEventGroupWaitBits(rc522->bits, RC522_TASK_STOPPED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+        }
+
         vEventGroupDelete(rc522->bits);
         rc522->bits = NULL;
     }
 
+    // Polling task was the only producer, handlers of the queued events run before the dispatcher stops
+    if (rc522->dispatcher) {
+        RC522_RETURN_ON_ERROR(rc522_dispatcher_destroy(rc522->dispatcher));
+        rc522->dispatcher = NULL;
+    }
+
+    if (rc522->ops) {
+        rc522_op_cancel_pending(rc522);
+        vQueueDelete(rc522->ops);
+        rc522->ops = NULL;
+    }
+
+    // Scanner does not poll anymore, so it cannot hold the bus
+    if (rc522->config != NULL && rc522->config->arbiter != NULL) {
+        RC522_RETURN_ON_ERROR(rc522_arbiter_detach(rc522->config->arbiter, rc522));
+    }
+
+#if !CONFIG_RC522_STATIC_ALLOCATION
     if (rc522->event_handle) {
         if (esp_event_loop_delete(rc522->event_handle) != ESP_OK) {
             ESP_LOGW(TAG, "Failed to delete event loop");
@@ -186,147 +383,268 @@ esp_err_t rc522_destroy(rc522_handle_t rc522)
 
         rc522->event_handle = NULL;
     }
+#endif
 
-    if (rc522->config) {
-        free(rc522->config);
-        rc522->config = NULL;
-    }
+    rc522->config = NULL;
 
-    free(rc522);
+    if (!rc522->is_static) {
+        free(rc522);
+    }
 
     return ESP_OK;
 }
 
-esp_err_t rc522_dispatch_event(const rc522_handle_t rc522, rc522_event_t event, const void *data, size_t data_size)
+esp_err_t rc522_run_event_handlers(const rc522_handle_t rc522, rc522_event_t event, const void *data, size_t data_size)
 {
+#if CONFIG_RC522_STATIC_ALLOCATION
+    // Handlers may (un)register handlers, so they are called from a copy of the table.
+    // Unlike esp_event, data is not copied, handlers get it as read-only
+    rc522_event_handler_entry_t handlers[CONFIG_RC522_EVENT_HANDLERS_MAX];
+    void *handler_data = (void *)(uintptr_t)data;
+
+    taskENTER_CRITICAL(&rc522->handlers_lock);
+    memcpy(handlers, rc522->handlers, sizeof(handlers));
+    taskEXIT_CRITICAL(&rc522->handlers_lock);
+
+    for (uint8_t i = 0; i < CONFIG_RC522_EVENT_HANDLERS_MAX; i++) {
+        if (handlers[i].handler != NULL && (handlers[i].event == ESP_EVENT_ANY_ID || handlers[i].event == event)) {
+            handlers[i].handler(handlers[i].arg, RC522_EVENTS, event, handler_data);
+        }
+    }
+
+    return ESP_OK;
+#else
     RC522_RETURN_ON_ERROR(esp_event_post_to(rc522->event_handle, RC522_EVENTS, event, data, data_size, portMAX_DELAY));
 
     return esp_event_loop_run(rc522->event_handle, 0);
+#endif
 }
 
-void rc522_task(void *arg)
+esp_err_t rc522_dispatch_event(const rc522_handle_t rc522, rc522_event_t event, const void *data, size_t data_size)
+{
+    RC522_STATS_BEGIN(rc522, span);
+
+    esp_err_t ret;
+
+    if (rc522->dispatcher != NULL) {
+        ret = rc522_dispatcher_push(rc522->dispatcher, event, data, data_size);
+    }
+    else {
+        ret = rc522_run_event_handlers(rc522, event, data, data_size);
+    }
+
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_DISPATCH, ret);
+
+    return ret;
+}
+
+esp_err_t rc522_get_dispatcher_stats(const rc522_handle_t rc522, rc522_dispatcher_stats_t *out_stats)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(out_stats == NULL);
+    RC522_CHECK_AND_RETURN(rc522->dispatcher == NULL, ESP_ERR_INVALID_STATE);
+
+    rc522_dispatcher_get_stats(rc522->dispatcher, out_stats);
+
+    return ESP_OK;
+}
+
+#if CONFIG_RC522_STATS
+static void rc522_dispatch_stats(const rc522_handle_t rc522)
+{
+    rc522_stats_event_t event = {
+        .stats = &rc522->stats,
+    };
+
+    if (rc522_dispatch_event(rc522, RC522_EVENT_STATS, &event, sizeof(event)) != ESP_OK) {
+        RC522_LOGW("failed to dispatch stats");
+    }
+}
+#endif
+
+void rc522_poll_init(const rc522_handle_t rc522)
+{
+    rc522->last_poll_ms = 0;
+    rc522->presence_check_failures = 0;
+#if CONFIG_RC522_STATS
+    rc522->last_stats_ms = rc522_millis();
+#endif
+
+    rc522_scheduler_init(rc522);
+}
+
+/**
+ * Scan for a PICC, activate it, or check that the active one is still in the field
+ */
+static void rc522_poll(const rc522_handle_t rc522)
 {
     esp_err_t ret = ESP_OK;
-    rc522_handle_t rc522 = (rc522_handle_t)arg;
-    uint32_t last_poll_ms = 0;
-    const uint32_t task_delay_ms = 50;
-    const uint32_t picc_heartbeat_failure_threshold_ms = (2 * task_delay_ms);
-    uint32_t picc_heartbeat_failure_at_ms = 0;
-    bool mutex_taken = false;
-    const uint16_t mutex_take_timeout_ms = 4000;
+    bool should_poll = (rc522_millis() - rc522->last_poll_ms) > rc522->config->poll_interval_ms;
 
-    xEventGroupClearBits(rc522->bits, RC522_TASK_STOPPED_BIT);
+    if (rc522->config->inventory) {
+        if (should_poll) {
+            uint8_t count = 0;
+            ret = rc522_inventory(rc522, NULL, 0, &count);
+            rc522->last_poll_ms = rc522_millis();
 
-    while (!rc522->exit_requested) {
-        if (mutex_taken && rc522->config->task_mutex != NULL) {
-            if (xSemaphoreGive(rc522->config->task_mutex) == pdTRUE) {
-                mutex_taken = false;
+            if (ret != ESP_OK) {
+                RC522_LOGW("inventory failed (err=%04" RC522_X ")", ret);
+            }
+            else if (count > 0) {
+                rc522_scheduler_on_activity(rc522);
             }
             else {
-                RC522_LOGW("failed to give mutex");
+                rc522_scheduler_on_empty_scan(rc522);
             }
         }
 
-        if (rc522->state != RC522_STATE_POLLING) {
-            // waiting for state change to polling
-            rc522_delay_ms(100);
-            continue;
-        }
+        return;
+    }
 
-        rc522_delay_ms(task_delay_ms);
+    if (rc522->picc.state == RC522_PICC_STATE_IDLE || rc522->picc.state == RC522_PICC_STATE_HALT) {
+        rc522_picc_atqa_desc_t atqa;
 
-        if (rc522->config->task_mutex != NULL) {
-            if (xSemaphoreTake(rc522->config->task_mutex, pdMS_TO_TICKS(mutex_take_timeout_ms)) == pdTRUE) {
-                mutex_taken = true;
-            }
-            else {
-                RC522_LOGW("failed to take mutex in %d ms", mutex_take_timeout_ms);
-                continue;
+        if (rc522->picc.state == RC522_PICC_STATE_IDLE) {
+            ret = rc522_picc_reqa(rc522, &atqa);
+        }
+        else {
+            ret = rc522_picc_wupa(rc522, &atqa);
+        }
+
+        if (ret != ESP_OK) {
+            if (ret == RC522_ERR_RX_TIMER_TIMEOUT || ret == RC522_ERR_RX_TIMEOUT) {
+                rc522_scheduler_on_empty_scan(rc522);
             }
+
+            return;
         }
 
-        bool should_poll = (rc522_millis() - last_poll_ms) > rc522->config->poll_interval_ms;
+        // card is present
+        rc522->picc.atqa = atqa;
 
-        if (rc522->picc.state == RC522_PICC_STATE_IDLE || rc522->picc.state == RC522_PICC_STATE_HALT) {
-            rc522_picc_atqa_desc_t atqa;
+#if CONFIG_RC522_STATS
+        rc522_stats_begin(rc522, &rc522->activation);
+#endif
 
-            if (rc522->picc.state == RC522_PICC_STATE_IDLE && ((ret = rc522_picc_reqa(rc522, &atqa)) != ESP_OK)) {
-                continue;
-            }
+        if (rc522->picc.state == RC522_PICC_STATE_IDLE) {
+            rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_READY, true);
+        }
+        else if (rc522->picc.state == RC522_PICC_STATE_HALT) {
+            rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_READY_H, true);
+        }
+    }
 
-            if (rc522->picc.state == RC522_PICC_STATE_HALT && ((ret = rc522_picc_wupa(rc522, &atqa)) != ESP_OK)) {
-                continue;
-            }
+    if (should_poll && (rc522->picc.state == RC522_PICC_STATE_READY || rc522->picc.state == RC522_PICC_STATE_READY_H)) {
+        rc522_picc_uid_t uid;
+        uint8_t sak;
 
-            // card is present
-            rc522->picc.atqa = atqa;
+        ret = rc522_picc_select(rc522, &rc522->picc.atqa, &uid, &sak, false);
+        rc522->last_poll_ms = rc522_millis();
 
-            if (rc522->picc.state == RC522_PICC_STATE_IDLE) {
-                rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_READY, true);
+#if CONFIG_RC522_STATS
+        rc522_stats_end(rc522, &rc522->activation, RC522_STATS_STAGE_ACTIVATION, ret);
+#endif
+
+        if (ret != ESP_OK) {
+            if (ret != RC522_ERR_RX_TIMEOUT && ret != RC522_ERR_INVALID_ATQA && ret != RC522_ERR_INVALID_SAK) {
+                RC522_LOGW("select failed (err=%04" RC522_X ")", ret);
             }
-            else if (rc522->picc.state == RC522_PICC_STATE_HALT) {
-                rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_READY_H, true);
+            else {
+                RC522_LOGD("select failed (err=%04" RC522_X ")", ret);
             }
+
+            rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_IDLE, true);
+            return;
         }
 
-        if (should_poll
-            && (rc522->picc.state == RC522_PICC_STATE_READY || rc522->picc.state == RC522_PICC_STATE_READY_H)) {
-            rc522_picc_uid_t uid;
-            uint8_t sak;
+        memcpy(&rc522->picc.uid, &uid, sizeof(rc522_picc_uid_t));
+        rc522->picc.sak = sak;
+        rc522->picc.type = rc522_picc_get_type(&rc522->picc);
 
-            ret = rc522_picc_select(rc522, &uid, &sak, false);
-            last_poll_ms = rc522_millis();
+        // Plan runs before the event, so its data is delivered with it
+        if (rc522_detect_run(rc522, &rc522->picc, &rc522->detect_result)) {
+            rc522->pending_detect_result = &rc522->detect_result;
+        }
 
-            if (ret != ESP_OK) {
-                if (ret != RC522_ERR_RX_TIMEOUT && ret != RC522_ERR_INVALID_ATQA && ret != RC522_ERR_INVALID_SAK) {
-                    RC522_LOGW("select failed (err=%04" RC522_X ")", ret);
-                }
-                else {
-                    RC522_LOGD("select failed (err=%04" RC522_X ")", ret);
-                }
-
-                rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_IDLE, true);
-                continue;
-            }
+        if (rc522->picc.state == RC522_PICC_STATE_READY) {
+            rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_ACTIVE, true);
+        }
+        else if (rc522->picc.state == RC522_PICC_STATE_READY_H) {
+            rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_ACTIVE_H, true);
+        }
 
-            memcpy(&rc522->picc.uid, &uid, sizeof(rc522_picc_uid_t));
-            rc522->picc.sak = sak;
-            rc522->picc.type = rc522_picc_get_type(&rc522->picc);
+        rc522->presence_check_failures = 0;
+        rc522_scheduler_on_activity(rc522);
 
-            if (rc522->picc.state == RC522_PICC_STATE_READY) {
-                rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_ACTIVE, true);
-            }
-            else if (rc522->picc.state == RC522_PICC_STATE_READY_H) {
-                rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_ACTIVE_H, true);
-            }
+        return;
+    }
 
-            picc_heartbeat_failure_at_ms = 0;
+    if (rc522->picc.state == RC522_PICC_STATE_ACTIVE || rc522->picc.state == RC522_PICC_STATE_ACTIVE_H) {
+        RC522_STATS_BEGIN(rc522, heartbeat_span);
+        ret = rc522_picc_presence_check(rc522, &rc522->picc, rc522->config->presence_check.mode);
+        RC522_STATS_END(rc522, heartbeat_span, RC522_STATS_STAGE_HEARTBEAT, ret);
 
-            continue;
+        if (ret == ESP_OK) {
+            // card is still in the field
+            rc522->presence_check_failures = 0;
+            return;
         }
 
-        if (rc522->picc.state == RC522_PICC_STATE_ACTIVE || rc522->picc.state == RC522_PICC_STATE_ACTIVE_H) {
-            if (picc_heartbeat_failure_at_ms != 0
-                && ((rc522_millis() - picc_heartbeat_failure_at_ms) > picc_heartbeat_failure_threshold_ms)) {
-                picc_heartbeat_failure_at_ms = 0;
-                rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_IDLE, true);
-                continue;
-            }
+        RC522_LOGD("presence check failed (err=%04" RC522_X ")", ret);
 
-            if ((ret = rc522_picc_heartbeat(rc522, &rc522->picc, NULL, NULL)) == ESP_OK) {
-                picc_heartbeat_failure_at_ms = 0;
-            }
-            else if (picc_heartbeat_failure_at_ms == 0) {
-                picc_heartbeat_failure_at_ms = rc522_millis();
-            }
+        if (++rc522->presence_check_failures >= rc522->config->presence_check.failure_threshold) {
+            rc522->presence_check_failures = 0;
+            rc522_picc_set_state(rc522, &rc522->picc, RC522_PICC_STATE_IDLE, true);
+            rc522_scheduler_on_activity(rc522);
+        }
+    }
+}
 
-            if (ret != ESP_OK) {
-                RC522_LOGD("heartbeat failed (err=%04" RC522_X ")", ret);
-            }
+uint32_t rc522_poll_step(const rc522_handle_t rc522)
+{
+    const uint16_t mutex_take_timeout_ms = 4000;
 
-            // card is still in the field
-            continue;
-        }
+    if (rc522->state != RC522_STATE_POLLING) {
+        // waiting for state change to polling
+        return RC522_POLL_STEP_PAUSED_DELAY_MS;
+    }
+
+    if (rc522->config->task_mutex != NULL
+        && xSemaphoreTake(rc522->config->task_mutex, pdMS_TO_TICKS(mutex_take_timeout_ms)) != pdTRUE) {
+        RC522_LOGW("failed to take mutex in %d ms", mutex_take_timeout_ms);
+
+        return rc522->scheduler.interval_ms;
+    }
+
+#if CONFIG_RC522_STATS
+    if (rc522->config->stats_interval_ms > 0
+        && (rc522_millis() - rc522->last_stats_ms) >= rc522->config->stats_interval_ms) {
+        rc522->last_stats_ms = rc522_millis();
+        rc522_dispatch_stats(rc522);
+    }
+#endif
+
+    rc522_poll(rc522);
+    rc522_op_run_pending(rc522);
+
+    if (rc522->config->task_mutex != NULL && xSemaphoreGive(rc522->config->task_mutex) != pdTRUE) {
+        RC522_LOGW("failed to give mutex");
+    }
+
+    bool picc_active = rc522->picc.state == RC522_PICC_STATE_ACTIVE || rc522->picc.state == RC522_PICC_STATE_ACTIVE_H;
+
+    return picc_active ? rc522->config->presence_check.interval_ms : rc522->scheduler.interval_ms;
+}
+
+void rc522_task(void *arg)
+{
+    rc522_handle_t rc522 = (rc522_handle_t)arg;
+
+    xEventGroupClearBits(rc522->bits, RC522_TASK_STOPPED_BIT);
+    rc522_poll_init(rc522);
+
+    while (!rc522->exit_requested) {
+        rc522_delay_ms(rc522_poll_step(rc522));
     }
 
     xEventGroupSetBits(rc522->bits, RC522_TASK_STOPPED_BIT);
@@ -0,0 +1,199 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "rc522_types_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_stats_internal.h"
+#include "rc522_arbiter_internal.h"
+
+RC522_LOG_DEFINE_BASE();
+
+typedef struct
+{
+    rc522_handle_t rc522;   /*<! NULL if the slot is free */
+    SemaphoreHandle_t turn; /*<! Given when the bus is handed over to the scanner */
+    StaticSemaphore_t turn_buffer;
+} rc522_arbiter_member_t;
+
+struct rc522_arbiter
+{
+    portMUX_TYPE lock;
+    rc522_arbiter_member_t members[RC522_ARBITER_SIZE_MAX]; /*<! Members keep their slots, semaphores cannot move */
+    uint8_t count;
+    rc522_handle_t owner; /*<! Scanner which holds the bus, NULL if the bus is free */
+
+    /**
+     * Scanners waiting for the bus, oldest first. Each scanner waits at most once,
+     * so the queue never holds more than RC522_ARBITER_SIZE_MAX entries
+     */
+    rc522_handle_t queue[RC522_ARBITER_SIZE_MAX];
+    uint8_t queue_head;
+    uint8_t queue_length;
+};
+
+static rc522_arbiter_member_t *rc522_arbiter_find(rc522_arbiter_handle_t arbiter, const rc522_handle_t rc522)
+{
+    for (uint8_t i = 0; i < RC522_ARBITER_SIZE_MAX; i++) {
+        if (arbiter->members[i].rc522 == rc522) {
+            return &arbiter->members[i];
+        }
+    }
+
+    return NULL;
+}
+
+esp_err_t rc522_arbiter_create(rc522_arbiter_handle_t *out_arbiter)
+{
+    RC522_CHECK(out_arbiter == NULL);
+
+    rc522_arbiter_handle_t arbiter = calloc(1, sizeof(struct rc522_arbiter));
+    ESP_RETURN_ON_FALSE(arbiter != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
+
+    portMUX_INITIALIZE(&arbiter->lock);
+
+    *out_arbiter = arbiter;
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_arbiter_destroy(rc522_arbiter_handle_t arbiter)
+{
+    RC522_CHECK(arbiter == NULL);
+    RC522_CHECK_AND_RETURN(arbiter->count > 0, ESP_ERR_INVALID_STATE);
+
+    free(arbiter);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_arbiter_attach(rc522_arbiter_handle_t arbiter, rc522_handle_t rc522)
+{
+    RC522_CHECK(arbiter == NULL);
+    RC522_CHECK(rc522 == NULL);
+
+    taskENTER_CRITICAL(&arbiter->lock);
+
+    // Free slot is claimed under the lock, its semaphore is created after
+    rc522_arbiter_member_t *member = rc522_arbiter_find(arbiter, NULL);
+
+    if (member != NULL) {
+        member->rc522 = rc522;
+        member->turn = NULL;
+        arbiter->count++;
+    }
+
+    taskEXIT_CRITICAL(&arbiter->lock);
+
+    if (member == NULL) {
+        RC522_LOGE("arbiter is full");
+        return ESP_ERR_NO_MEM;
+    }
+
+    member->turn = xSemaphoreCreateBinaryStatic(&member->turn_buffer);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_arbiter_detach(rc522_arbiter_handle_t arbiter, rc522_handle_t rc522)
+{
+    RC522_CHECK(arbiter == NULL);
+    RC522_CHECK(rc522 == NULL);
+
+    SemaphoreHandle_t turn = NULL;
+
+    taskENTER_CRITICAL(&arbiter->lock);
+
+    rc522_arbiter_member_t *member = rc522_arbiter_find(arbiter, rc522);
+
+    if (member != NULL) {
+        turn = member->turn;
+        member->rc522 = NULL;
+        arbiter->count--;
+    }
+
+    taskEXIT_CRITICAL(&arbiter->lock);
+
+    if (turn != NULL) {
+        vSemaphoreDelete(turn);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_arbiter_acquire(const rc522_handle_t rc522)
+{
+    RC522_CHECK(rc522 == NULL);
+
+    rc522_arbiter_handle_t arbiter = rc522->config->arbiter;
+
+    if (arbiter == NULL) {
+        return ESP_OK;
+    }
+
+    RC522_STATS_BEGIN(rc522, span);
+
+    esp_err_t ret = ESP_OK;
+    SemaphoreHandle_t turn = NULL;
+
+    taskENTER_CRITICAL(&arbiter->lock);
+
+    rc522_arbiter_member_t *member = rc522_arbiter_find(arbiter, rc522);
+
+    if (member == NULL || arbiter->owner == rc522) {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    else if (arbiter->owner == NULL) {
+        arbiter->owner = rc522;
+    }
+    else {
+        // Bus is handed over by the owner, nobody can take it out of turn
+        uint8_t tail = (arbiter->queue_head + arbiter->queue_length) % RC522_ARBITER_SIZE_MAX;
+        arbiter->queue[tail] = rc522;
+        arbiter->queue_length++;
+        turn = member->turn;
+    }
+
+    taskEXIT_CRITICAL(&arbiter->lock);
+
+    RC522_CHECK_AND_RETURN(ret != ESP_OK, ret);
+
+    if (turn != NULL) {
+        xSemaphoreTake(turn, portMAX_DELAY);
+    }
+
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_BUS_WAIT, ESP_OK);
+
+    return ESP_OK;
+}
+
+void rc522_arbiter_release(const rc522_handle_t rc522)
+{
+    rc522_arbiter_handle_t arbiter = rc522->config->arbiter;
+
+    if (arbiter == NULL) {
+        return;
+    }
+
+    SemaphoreHandle_t next_turn = NULL;
+
+    taskENTER_CRITICAL(&arbiter->lock);
+
+    if (arbiter->owner == rc522) {
+        arbiter->owner = NULL;
+
+        if (arbiter->queue_length > 0) {
+            rc522_handle_t next = arbiter->queue[arbiter->queue_head];
+            arbiter->queue_head = (arbiter->queue_head + 1) % RC522_ARBITER_SIZE_MAX;
+            arbiter->queue_length--;
+
+            arbiter->owner = next;
+            next_turn = rc522_arbiter_find(arbiter, next)->turn;
+        }
+    }
+
+    taskEXIT_CRITICAL(&arbiter->lock);
+
+    if (next_turn != NULL) {
+        xSemaphoreGive(next_turn);
+    }
+}
@@ -0,0 +1,143 @@
+
+#include "rc522_types_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_pcd_internal.h"
+#include "rc522_picc_internal.h"
+#include "rc522_stats_internal.h"
+#include "rc522_detect_internal.h"
+#include "picc/rc522_ntag.h"
+
+RC522_LOG_DEFINE_BASE();
+
+static size_t rc522_detect_step_data_size(const rc522_detect_step_t *step)
+{
+    switch (step->type) {
+        case RC522_DETECT_STEP_MIFARE_READ:
+            return step->count * RC522_MIFARE_BLOCK_SIZE;
+        case RC522_DETECT_STEP_NTAG_READ:
+            return step->count * NTAG_PAGE_SIZE;
+        default:
+            return 0;
+    }
+}
+
+esp_err_t rc522_detect_validate_plans(const rc522_detect_plan_t *plans, uint8_t plan_count)
+{
+    RC522_CHECK(plans == NULL && plan_count > 0);
+
+    for (uint8_t i = 0; i < plan_count; i++) {
+        const rc522_detect_plan_t *plan = &plans[i];
+        size_t data_size = 0;
+
+        RC522_CHECK(plan->steps == NULL && plan->step_count > 0);
+
+        for (uint8_t j = 0; j < plan->step_count; j++) {
+            const rc522_detect_step_t *step = &plan->steps[j];
+
+            RC522_CHECK(step->type > RC522_DETECT_STEP_NTAG_READ);
+            RC522_CHECK(step->type == RC522_DETECT_STEP_MIFARE_AUTH && step->key == NULL);
+            RC522_CHECK(step->type != RC522_DETECT_STEP_MIFARE_AUTH && step->count == 0);
+
+            data_size += rc522_detect_step_data_size(step);
+        }
+
+        RC522_CHECK_WITH_MESSAGE(data_size > RC522_DETECT_DATA_SIZE_MAX, "detect plan reads too much data");
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_detect_run_step(
+    const rc522_handle_t rc522, const rc522_picc_t *picc, const rc522_detect_step_t *step, uint8_t *buffer)
+{
+    switch (step->type) {
+        case RC522_DETECT_STEP_MIFARE_AUTH:
+            RC522_CHECK_AND_RETURN(!rc522_mifare_type_is_classic_compatible(picc->type), ESP_ERR_NOT_SUPPORTED);
+            return rc522_mifare_auth(rc522, picc, step->address, step->key);
+
+        case RC522_DETECT_STEP_MIFARE_READ:
+            for (uint8_t i = 0; i < step->count; i++) {
+                RC522_RETURN_ON_ERROR_SILENTLY(
+                    rc522_mifare_read(rc522, picc, step->address + i, buffer + (i * RC522_MIFARE_BLOCK_SIZE)));
+            }
+
+            return ESP_OK;
+
+        case RC522_DETECT_STEP_NTAG_READ:
+            for (uint8_t i = 0; i < step->count; i++) {
+                RC522_RETURN_ON_ERROR_SILENTLY(
+                    rc522_ntag_read(rc522, picc, step->address + i, buffer + (i * NTAG_PAGE_SIZE)));
+            }
+
+            return ESP_OK;
+
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+}
+
+/**
+ * Crypto1 is stopped by the PCD only, so the PICC takes the next plain frame
+ * as an error and falls back to IDLE (HALT if it has been woken up from it).
+ * WUPA wakes it up from both.
+ */
+static esp_err_t rc522_detect_reselect(const rc522_handle_t rc522, const rc522_picc_t *picc)
+{
+    RC522_RETURN_ON_ERROR(rc522_pcd_stop_crypto1(rc522));
+
+    return rc522_picc_reselect(rc522, picc);
+}
+
+bool rc522_detect_run(const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_detect_result_t *out_result)
+{
+    const rc522_config_t *config = rc522->config;
+    const rc522_detect_plan_t *plan = NULL;
+
+    for (uint8_t i = 0; i < config->detect_plan_count; i++) {
+        if (config->detect_plans[i].picc_type == picc->type) {
+            plan = &config->detect_plans[i];
+            break;
+        }
+    }
+
+    if (plan == NULL) {
+        return false;
+    }
+
+    RC522_STATS_BEGIN(rc522, span);
+
+    bool authenticated = false;
+
+    out_result->ret = ESP_OK;
+    out_result->steps_done = 0;
+    out_result->length = 0;
+
+    for (uint8_t i = 0; i < plan->step_count; i++) {
+        const rc522_detect_step_t *step = &plan->steps[i];
+
+        authenticated |= step->type == RC522_DETECT_STEP_MIFARE_AUTH;
+        out_result->ret = rc522_detect_run_step(rc522, picc, step, out_result->data + out_result->length);
+
+        if (out_result->ret != ESP_OK) {
+            RC522_LOGD("detect step %d failed (err=%04" RC522_X ")", i, out_result->ret);
+            break;
+        }
+
+        out_result->steps_done++;
+        out_result->length += rc522_detect_step_data_size(step);
+    }
+
+    // Failed step may leave the PICC unselected as well
+    if (authenticated || out_result->ret != ESP_OK) {
+        esp_err_t ret = rc522_detect_reselect(rc522, picc);
+
+        if (ret != ESP_OK) {
+            // Presence check decides whether the PICC is still there
+            RC522_LOGD("reselect after detect plan failed (err=%04" RC522_X ")", ret);
+        }
+    }
+
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_DETECT_PLAN, out_result->ret);
+
+    return true;
+}
@@ -0,0 +1,255 @@
+#include <string.h>
+#include <stdatomic.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+
+#include "rc522_types_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_internal.h"
+#include "rc522_dispatcher_internal.h"
+
+RC522_LOG_DEFINE_BASE();
+
+#define RC522_DISPATCHER_RING_MASK (RC522_DISPATCHER_RING_SIZE - 1)
+
+_Static_assert((RC522_DISPATCHER_RING_SIZE & RC522_DISPATCHER_RING_MASK) == 0,
+    "RC522_DISPATCHER_RING_SIZE must be a power of two");
+
+/**
+ * Event data is copied by value. Pointers in it are redirected
+ * to the copies of the PICC, detect result and statistics kept in the same slot.
+ */
+typedef struct
+{
+    rc522_event_t event;
+    size_t data_size;
+    union
+    {
+        rc522_picc_state_changed_event_t state_changed;
+        rc522_picc_inventory_event_t inventory;
+        rc522_stats_event_t stats;
+    } data;
+    rc522_picc_t picc;
+    rc522_detect_result_t detect_result;
+#if CONFIG_RC522_STATS
+    rc522_stats_t stats;
+#endif
+} rc522_dispatcher_slot_t;
+
+struct rc522_dispatcher
+{
+    rc522_handle_t rc522;
+    TaskHandle_t task_handle;
+    EventGroupHandle_t bits;
+    StaticSemaphore_t wake_buffer;
+    SemaphoreHandle_t wake; /*<! Given on push, not a task notification, which handlers may use themselves */
+    bool exit_requested;
+    atomic_uint head; /*<! Written only by the producer (polling task) */
+    atomic_uint tail; /*<! Written only by the consumer (dispatcher task) */
+    bool overflowing; /*<! Ring was full on the last push */
+
+    /**
+     * Each counter has a single writer: dispatched is written
+     * by the consumer, the rest by the producer
+     */
+    rc522_dispatcher_stats_t stats;
+    rc522_dispatcher_slot_t slots[RC522_DISPATCHER_RING_SIZE];
+};
+
+static esp_err_t rc522_dispatcher_snapshot(
+    rc522_dispatcher_handle_t dispatcher, uint32_t index, rc522_event_t event, const void *data, size_t data_size)
+{
+    rc522_dispatcher_slot_t *slot = &dispatcher->slots[index & RC522_DISPATCHER_RING_MASK];
+
+    RC522_CHECK(data_size > sizeof(slot->data));
+
+    slot->event = event;
+    memcpy(&slot->data, data, data_size);
+    slot->data_size = data_size;
+
+    switch (slot->event) {
+        case RC522_EVENT_PICC_STATE_CHANGED:
+            memcpy(&slot->picc, slot->data.state_changed.picc, sizeof(rc522_picc_t));
+            slot->data.state_changed.picc = &slot->picc;
+
+            if (slot->data.state_changed.detect_result != NULL) {
+                memcpy(&slot->detect_result, slot->data.state_changed.detect_result, sizeof(rc522_detect_result_t));
+                slot->data.state_changed.detect_result = &slot->detect_result;
+            }
+            break;
+        case RC522_EVENT_PICC_ARRIVED:
+        case RC522_EVENT_PICC_LEFT:
+            memcpy(&slot->picc, slot->data.inventory.picc, sizeof(rc522_picc_t));
+            slot->data.inventory.picc = &slot->picc;
+            break;
+#if CONFIG_RC522_STATS
+        case RC522_EVENT_STATS:
+            RC522_RETURN_ON_ERROR(rc522_get_stats(dispatcher->rc522, &slot->stats));
+            slot->data.stats.stats = &slot->stats;
+            break;
+#endif
+        default:
+            break;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_dispatcher_push(
+    rc522_dispatcher_handle_t dispatcher, rc522_event_t event, const void *data, size_t data_size)
+{
+    RC522_CHECK(dispatcher == NULL);
+    RC522_CHECK(data == NULL);
+
+    uint32_t head = atomic_load_explicit(&dispatcher->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&dispatcher->tail, memory_order_acquire);
+
+    if (head - tail >= RC522_DISPATCHER_RING_SIZE) {
+        if (!dispatcher->overflowing) {
+            dispatcher->overflowing = true;
+            dispatcher->stats.overflows++;
+        }
+
+        dispatcher->stats.dropped++;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    dispatcher->overflowing = false;
+
+    RC522_RETURN_ON_ERROR(rc522_dispatcher_snapshot(dispatcher, head, event, data, data_size));
+
+    // Slot is filled before the consumer can see it
+    atomic_store_explicit(&dispatcher->head, head + 1, memory_order_release);
+
+    if ((head + 1 - tail) > dispatcher->stats.high_water) {
+        dispatcher->stats.high_water = head + 1 - tail;
+    }
+
+    xSemaphoreGive(dispatcher->wake);
+
+    return ESP_OK;
+}
+
+/**
+ * @return false if the ring is empty
+ */
+static bool rc522_dispatcher_pop(rc522_dispatcher_handle_t dispatcher)
+{
+    uint32_t tail = atomic_load_explicit(&dispatcher->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&dispatcher->head, memory_order_acquire);
+
+    if (head == tail) {
+        return false;
+    }
+
+    rc522_dispatcher_slot_t *slot = &dispatcher->slots[tail & RC522_DISPATCHER_RING_MASK];
+
+    esp_err_t ret = rc522_run_event_handlers(dispatcher->rc522, slot->event, &slot->data, slot->data_size);
+
+    if (ret != ESP_OK) {
+        RC522_LOGW("event %d dispatch failed (err=%04" RC522_X ")", slot->event, ret);
+    }
+
+    dispatcher->stats.dispatched++;
+
+    // Slot is released only after the handlers have returned, they may use the snapshot until then
+    atomic_store_explicit(&dispatcher->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+static void rc522_dispatcher_task(void *arg)
+{
+    rc522_dispatcher_handle_t dispatcher = (rc522_dispatcher_handle_t)arg;
+
+    xEventGroupClearBits(dispatcher->bits, RC522_TASK_STOPPED_BIT);
+
+    while (true) {
+        xSemaphoreTake(dispatcher->wake, portMAX_DELAY);
+
+        while (rc522_dispatcher_pop(dispatcher)) { }
+
+        if (dispatcher->exit_requested) {
+            break;
+        }
+    }
+
+    xEventGroupSetBits(dispatcher->bits, RC522_TASK_STOPPED_BIT);
+    ESP_LOGI(TAG, "Dispatcher task exited");
+    vTaskDelete(NULL); // self-delete
+}
+
+esp_err_t rc522_dispatcher_create(rc522_handle_t rc522, rc522_dispatcher_handle_t *out_dispatcher)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(out_dispatcher == NULL);
+
+    rc522_dispatcher_handle_t dispatcher = calloc(1, sizeof(struct rc522_dispatcher));
+    ESP_RETURN_ON_FALSE(dispatcher != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
+
+    esp_err_t ret = ESP_OK;
+    const rc522_dispatcher_config_t *config = &rc522->config->dispatcher;
+
+    dispatcher->rc522 = rc522;
+    atomic_init(&dispatcher->head, 0);
+    atomic_init(&dispatcher->tail, 0);
+    dispatcher->wake = xSemaphoreCreateBinaryStatic(&dispatcher->wake_buffer);
+
+    dispatcher->bits = xEventGroupCreate();
+    ESP_GOTO_ON_FALSE(dispatcher->bits != NULL, ESP_ERR_NO_MEM, _error, TAG, "nomem");
+
+    BaseType_t task_create_result = xTaskCreatePinnedToCore(rc522_dispatcher_task,
+        "rc522_dispatcher_task",
+        config->task_stack_size,
+        dispatcher,
+        config->task_priority,
+        &dispatcher->task_handle,
+        config->task_pinned ? config->task_core_id : tskNO_AFFINITY);
+
+    ESP_GOTO_ON_FALSE(task_create_result == pdTRUE, ESP_FAIL, _error, TAG, "task create failed");
+
+    *out_dispatcher = dispatcher;
+
+    return ESP_OK;
+_error:
+    if (dispatcher->bits) {
+        vEventGroupDelete(dispatcher->bits);
+    }
+
+    free(dispatcher);
+
+    return ret;
+}
+
+esp_err_t rc522_dispatcher_destroy(rc522_dispatcher_handle_t dispatcher)
+{
+    RC522_CHECK(dispatcher == NULL);
+
+    ESP_RETURN_ON_FALSE(!rc522_dispatcher_is_current_task(dispatcher),
+        ESP_ERR_INVALID_STATE,
+        TAG,
+        "Cannot destroy from event handler");
+
+    dispatcher->exit_requested = true; // task will delete itself
+    xSemaphoreGive(dispatcher->wake);
+
+    xEventGroupWaitBits(dispatcher->bits, RC522_TASK_STOPPED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    vEventGroupDelete(dispatcher->bits);
+    vSemaphoreDelete(dispatcher->wake);
+    free(dispatcher);
+
+    return ESP_OK;
+}
+
+void rc522_dispatcher_get_stats(rc522_dispatcher_handle_t dispatcher, rc522_dispatcher_stats_t *out_stats)
+{
+    memcpy(out_stats, &dispatcher->stats, sizeof(rc522_dispatcher_stats_t));
+}
+
+bool rc522_dispatcher_is_current_task(rc522_dispatcher_handle_t dispatcher)
+{
+    return xTaskGetCurrentTaskHandle() == dispatcher->task_handle;
+}
@@ -1,5 +1,6 @@
 #include <string.h>
 #include <driver/gpio.h>
+#include <esp_attr.h>
 #include "rc522_types_internal.h"
 #include "rc522_driver_internal.h"
 
@@ -23,6 +24,141 @@ esp_err_t rc522_driver_init_rst_pin(gpio_num_t rst_io_num)
     return ESP_OK;
 }
 
+static void IRAM_ATTR rc522_driver_irq_isr_handler(void *arg)
+{
+    rc522_driver_handle_t driver = (rc522_driver_handle_t)(arg);
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    if (driver->irq_task != NULL) {
+        xSemaphoreGiveFromISR(driver->irq_semaphore, &higher_priority_task_woken);
+    }
+
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+esp_err_t rc522_driver_init_irq_pin(const rc522_driver_handle_t driver, gpio_num_t irq_io_num)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(irq_io_num < 0);
+
+    // IRQ output is configured as push-pull, active low (see rc522_pcd_init)
+    gpio_config_t io_conf = {
+        .intr_type = GPIO_INTR_NEGEDGE,
+        .mode = GPIO_MODE_INPUT,
+        .pin_bit_mask = (1ULL << irq_io_num),
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+    };
+
+    RC522_RETURN_ON_ERROR(gpio_config(&io_conf));
+
+    esp_err_t ret = gpio_install_isr_service(0);
+
+    // Service might be already installed by the application
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+
+    RC522_RETURN_ON_ERROR(gpio_isr_handler_add(irq_io_num, rc522_driver_irq_isr_handler, driver));
+
+    driver->irq_io_num = irq_io_num;
+    driver->irq_enabled = true;
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_driver_deinit_irq_pin(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+
+    if (!driver->irq_enabled) {
+        return ESP_OK;
+    }
+
+    if (driver->irq_io_num > GPIO_NUM_NC) {
+        RC522_RETURN_ON_ERROR(gpio_isr_handler_remove(driver->irq_io_num));
+        RC522_RETURN_ON_ERROR(gpio_reset_pin(driver->irq_io_num));
+    }
+
+    driver->irq_io_num = GPIO_NUM_NC;
+    driver->irq_enabled = false;
+    driver->irq_task = NULL;
+
+    return ESP_OK;
+}
+
+/**
+ * Wrapping drivers (e.g. recorder) use the IRQ of the driver they wrap
+ */
+inline static rc522_driver_handle_t rc522_driver_irq_owner(rc522_driver_handle_t driver)
+{
+    while (driver != NULL && driver->irq_owner != NULL) {
+        driver = driver->irq_owner;
+    }
+
+    return driver;
+}
+
+inline bool rc522_driver_irq_enabled(const rc522_driver_handle_t driver)
+{
+    rc522_driver_handle_t owner = rc522_driver_irq_owner(driver);
+
+    return owner != NULL && owner->irq_enabled;
+}
+
+esp_err_t rc522_driver_irq_arm(const rc522_driver_handle_t _driver)
+{
+    rc522_driver_handle_t driver = rc522_driver_irq_owner(_driver);
+
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(!driver->irq_enabled);
+
+    driver->irq_task = xTaskGetCurrentTaskHandle();
+
+    // Drop IRQ left over from the previous command
+    xSemaphoreTake(driver->irq_semaphore, 0);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_driver_irq_wait(const rc522_driver_handle_t _driver, uint32_t timeout_ms)
+{
+    rc522_driver_handle_t driver = rc522_driver_irq_owner(_driver);
+
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(!driver->irq_enabled);
+    RC522_CHECK(driver->irq_task != xTaskGetCurrentTaskHandle());
+
+    if (xSemaphoreTake(driver->irq_semaphore, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_driver_irq_disarm(const rc522_driver_handle_t _driver)
+{
+    rc522_driver_handle_t driver = rc522_driver_irq_owner(_driver);
+
+    RC522_CHECK(driver == NULL);
+
+    driver->irq_task = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_driver_raise_irq(const rc522_driver_handle_t driver)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(!driver->irq_enabled);
+
+    if (driver->irq_task != NULL) {
+        xSemaphoreGive(driver->irq_semaphore);
+    }
+
+    return ESP_OK;
+}
+
 inline esp_err_t rc522_driver_install(const rc522_driver_handle_t driver)
 {
     RC522_CHECK(driver == NULL);
@@ -46,6 +182,28 @@ inline esp_err_t rc522_driver_receive(const rc522_driver_handle_t driver, uint8_
     return driver->receive(driver, address, bytes);
 }
 
+esp_err_t rc522_driver_batch(const rc522_driver_handle_t driver, rc522_driver_op_t *ops, uint8_t count)
+{
+    RC522_CHECK(driver == NULL);
+    RC522_CHECK(ops == NULL);
+    RC522_CHECK(count < 1);
+
+    if (driver->batch) {
+        return driver->batch(driver, ops, count);
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (ops[i].type == RC522_DRIVER_OP_WRITE) {
+            RC522_RETURN_ON_ERROR(driver->send(driver, ops[i].address, &ops[i].bytes));
+        }
+        else {
+            RC522_RETURN_ON_ERROR(driver->receive(driver, ops[i].address, &ops[i].bytes));
+        }
+    }
+
+    return ESP_OK;
+}
+
 inline esp_err_t rc522_driver_reset(const rc522_driver_handle_t driver)
 {
     RC522_CHECK(driver == NULL);
@@ -71,6 +229,9 @@ esp_err_t rc522_driver_create(const void *config, size_t config_size, rc522_driv
     rc522_driver_handle_t _driver = calloc(1, sizeof(struct rc522_driver_handle));
     ESP_RETURN_ON_FALSE(_driver != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
 
+    _driver->irq_io_num = GPIO_NUM_NC;
+    _driver->irq_semaphore = xSemaphoreCreateBinaryStatic(&_driver->irq_semaphore_buffer);
+
     _driver->config = calloc(1, config_size);
     ESP_GOTO_ON_FALSE(_driver->config != NULL, ESP_ERR_NO_MEM, error, TAG, "nomem");
 
@@ -86,23 +247,61 @@ exit:
     return ret;
 }
 
+_Static_assert(
+    sizeof(struct rc522_driver_handle) <= sizeof(rc522_driver_static_t), "RC522_DRIVER_STATIC_SIZE is too small");
+
+esp_err_t rc522_driver_create_static(const void *config, size_t config_size, rc522_driver_static_t *handle_buffer,
+    void *config_buffer, rc522_driver_handle_t *driver)
+{
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(config_size == 0);
+    RC522_CHECK(handle_buffer == NULL);
+    RC522_CHECK(config_buffer == NULL);
+    RC522_CHECK(driver == NULL);
+
+    rc522_driver_handle_t _driver = (rc522_driver_handle_t)handle_buffer->handle;
+
+    memset(_driver, 0, sizeof(struct rc522_driver_handle));
+    _driver->is_static = true;
+    _driver->irq_io_num = GPIO_NUM_NC;
+    _driver->irq_semaphore = xSemaphoreCreateBinaryStatic(&_driver->irq_semaphore_buffer);
+    _driver->config = config_buffer;
+
+    memcpy(_driver->config, config, config_size);
+
+    *driver = _driver;
+
+    return ESP_OK;
+}
+
 esp_err_t rc522_driver_destroy(rc522_driver_handle_t driver)
 {
     RC522_CHECK(driver == NULL);
 
-    if (driver->config) {
+    if (driver->config && !driver->is_static) {
         free(driver->config);
-        driver->config = NULL;
     }
 
+    driver->config = NULL;
+
     driver->install = NULL;
     driver->send = NULL;
     driver->receive = NULL;
+    driver->batch = NULL;
     driver->uninstall = NULL;
 
     driver->device = NULL;
+    driver->irq_task = NULL;
+    driver->irq_owner = NULL;
 
-    free(driver);
+    if (driver->irq_semaphore != NULL) {
+        vSemaphoreDelete(driver->irq_semaphore);
+        driver->irq_semaphore = NULL;
+    }
+
+    if (!driver->is_static) {
+        free(driver);
+    }
 
     return ESP_OK;
 }
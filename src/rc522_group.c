@@ -0,0 +1,214 @@
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+
+#include "rc522_types_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_internal.h"
+#include "rc522_group_internal.h"
+
+RC522_LOG_DEFINE_BASE();
+
+typedef struct
+{
+    rc522_handle_t rc522;
+    uint32_t next_step_ms; /*<! When the scanner is polled next time */
+} rc522_group_member_t;
+
+struct rc522_group
+{
+    rc522_group_config_t config;
+    TaskHandle_t task_handle;
+    EventGroupHandle_t bits;
+    SemaphoreHandle_t lock; /*<! Guards members, taken while the scanners are polled */
+    bool exit_requested;
+    rc522_group_member_t members[RC522_GROUP_SIZE_MAX];
+    uint8_t count;
+    uint8_t first; /*<! Member polled first in the next round, rotates so no scanner is always preferred */
+};
+
+static inline uint32_t rc522_group_member_weight(const rc522_group_member_t *member)
+{
+    return member->rc522->config->group_weight > 0 ? member->rc522->config->group_weight : 1;
+}
+
+/**
+ * Polls members which are due, in round-robin order
+ *
+ * @return Delay (in milliseconds) until the next member is due
+ */
+static uint32_t rc522_group_round(rc522_group_handle_t group)
+{
+    uint32_t delay_ms = RC522_POLL_STEP_PAUSED_DELAY_MS;
+
+    for (uint8_t i = 0; i < group->count; i++) {
+        rc522_group_member_t *member = &group->members[(group->first + i) % group->count];
+
+        if ((int32_t)(member->next_step_ms - rc522_millis()) > 0) {
+            continue;
+        }
+
+        member->next_step_ms = rc522_millis() + rc522_poll_step(member->rc522) / rc522_group_member_weight(member);
+    }
+
+    group->first = group->count > 0 ? (group->first + 1) % group->count : 0;
+
+    uint32_t now_ms = rc522_millis();
+
+    for (uint8_t i = 0; i < group->count; i++) {
+        int32_t remaining_ms = (int32_t)(group->members[i].next_step_ms - now_ms);
+
+        if (remaining_ms < (int32_t)delay_ms) {
+            delay_ms = remaining_ms > 0 ? remaining_ms : 0;
+        }
+    }
+
+    return delay_ms;
+}
+
+static void rc522_group_task(void *arg)
+{
+    rc522_group_handle_t group = (rc522_group_handle_t)arg;
+
+    xEventGroupClearBits(group->bits, RC522_TASK_STOPPED_BIT);
+
+    while (!group->exit_requested) {
+        xSemaphoreTake(group->lock, portMAX_DELAY);
+        uint32_t delay_ms = rc522_group_round(group);
+        xSemaphoreGive(group->lock);
+
+        rc522_delay_ms(delay_ms);
+    }
+
+    xEventGroupSetBits(group->bits, RC522_TASK_STOPPED_BIT);
+    ESP_LOGI(TAG, "Group task exited");
+    vTaskDelete(NULL); // self-delete
+}
+
+esp_err_t rc522_group_create(const rc522_group_config_t *config, rc522_group_handle_t *out_group)
+{
+    RC522_CHECK(config == NULL);
+    RC522_CHECK(out_group == NULL);
+
+    rc522_group_handle_t group = calloc(1, sizeof(struct rc522_group));
+    ESP_RETURN_ON_FALSE(group != NULL, ESP_ERR_NO_MEM, TAG, "nomem");
+
+    esp_err_t ret = ESP_OK;
+
+    memcpy(&group->config, config, sizeof(rc522_group_config_t));
+
+    if (group->config.task_stack_size == 0) {
+        group->config.task_stack_size = RC522_TASK_STACK_SIZE_DEFAULT;
+    }
+
+    if (group->config.task_priority == 0) {
+        group->config.task_priority = RC522_TASK_PRIORITY_DEFAULT;
+    }
+
+    group->bits = xEventGroupCreate();
+    ESP_GOTO_ON_FALSE(group->bits != NULL, ESP_ERR_NO_MEM, _error, TAG, "nomem");
+
+    group->lock = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(group->lock != NULL, ESP_ERR_NO_MEM, _error, TAG, "nomem");
+
+    BaseType_t task_create_result = xTaskCreate(rc522_group_task,
+        "rc522_group_task",
+        group->config.task_stack_size,
+        group,
+        group->config.task_priority,
+        &group->task_handle);
+
+    ESP_GOTO_ON_FALSE(task_create_result == pdTRUE, ESP_FAIL, _error, TAG, "task create failed");
+
+    *out_group = group;
+
+    return ESP_OK;
+_error:
+    if (group->lock) {
+        vSemaphoreDelete(group->lock);
+    }
+
+    if (group->bits) {
+        vEventGroupDelete(group->bits);
+    }
+
+    free(group);
+
+    return ret;
+}
+
+esp_err_t rc522_group_destroy(rc522_group_handle_t group)
+{
+    RC522_CHECK(group == NULL);
+    RC522_CHECK_AND_RETURN(group->count > 0, ESP_ERR_INVALID_STATE);
+
+    ESP_RETURN_ON_FALSE(xTaskGetCurrentTaskHandle() != group->task_handle,
+        ESP_ERR_INVALID_STATE,
+        TAG,
+        "Cannot destroy from event handler");
+
+    group->exit_requested = true; // task will delete itself
+
+    xEventGroupWaitBits(group->bits, RC522_TASK_STOPPED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    vEventGroupDelete(group->bits);
+    vSemaphoreDelete(group->lock);
+    free(group);
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_group_attach(rc522_group_handle_t group, rc522_handle_t rc522)
+{
+    RC522_CHECK(group == NULL);
+    RC522_CHECK(rc522 == NULL);
+
+    esp_err_t ret = ESP_OK;
+
+    xSemaphoreTake(group->lock, portMAX_DELAY);
+
+    if (group->count < RC522_GROUP_SIZE_MAX) {
+        rc522_poll_init(rc522);
+
+        group->members[group->count].rc522 = rc522;
+        group->members[group->count].next_step_ms = rc522_millis();
+        group->count++;
+    }
+    else {
+        RC522_LOGE("group is full");
+        ret = ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreGive(group->lock);
+
+    return ret;
+}
+
+esp_err_t rc522_group_detach(rc522_group_handle_t group, rc522_handle_t rc522)
+{
+    RC522_CHECK(group == NULL);
+    RC522_CHECK(rc522 == NULL);
+
+    ESP_RETURN_ON_FALSE(xTaskGetCurrentTaskHandle() != group->task_handle,
+        ESP_ERR_INVALID_STATE,
+        TAG,
+        "Cannot destroy from event handler");
+
+    xSemaphoreTake(group->lock, portMAX_DELAY);
+
+    for (uint8_t i = 0; i < group->count; i++) {
+        if (group->members[i].rc522 != rc522) {
+            continue;
+        }
+
+        memmove(&group->members[i], &group->members[i + 1], (group->count - i - 1) * sizeof(rc522_group_member_t));
+        group->count--;
+        group->first = 0;
+        break;
+    }
+
+    xSemaphoreGive(group->lock);
+
+    return ESP_OK;
+}
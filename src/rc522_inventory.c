@@ -0,0 +1,138 @@
+#include <string.h>
+#include "rc522_types_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_pcd_internal.h"
+#include "rc522_picc_internal.h"
+#include "rc522_internal.h"
+#include "rc522_ntag_internal.h"
+#include "rc522.h"
+
+RC522_LOG_DEFINE_BASE();
+
+// PICC which fails to SELECT answers the next REQA again, so the number of rounds is limited
+#define RC522_INVENTORY_ROUNDS_MAX (2 * RC522_INVENTORY_SIZE_MAX)
+
+static bool rc522_inventory_contains(const rc522_picc_t *piccs, uint8_t count, const rc522_picc_uid_t *uid)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (piccs[i].uid.length == uid->length && memcmp(piccs[i].uid.value, uid->value, uid->length) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Finds the next PICC which is in IDLE state, SELECTs it and sends it to HALT,
+ * so it does not answer REQA of the next round.
+ *
+ * @return RC522_ERR_RX_TIMEOUT or RC522_ERR_RX_TIMER_TIMEOUT if there are no PICCs in IDLE state
+ */
+static esp_err_t rc522_inventory_next(const rc522_handle_t rc522, rc522_picc_t *out_picc)
+{
+    rc522_picc_atqa_desc_t atqa;
+    esp_err_t ret = rc522_picc_reqa(rc522, &atqa);
+
+    if (ret == RC522_ERR_COLLISION || ret == RC522_ERR_INVALID_ATQA) {
+        // ATQAs of PICCs with different UID sizes or types have collided,
+        // the UID size is found out by the anticollision anyway
+        RC522_LOGD("ATQA collision");
+        memset(&atqa, 0, sizeof(atqa));
+    }
+    else if (ret != ESP_OK) {
+        return ret;
+    }
+
+    memset(out_picc, 0, sizeof(rc522_picc_t));
+    out_picc->atqa = atqa;
+
+    RC522_RETURN_ON_ERROR_SILENTLY(rc522_picc_select(rc522, &atqa, &out_picc->uid, &out_picc->sak, false));
+
+    out_picc->type = rc522_picc_get_type(out_picc);
+    out_picc->state = RC522_PICC_STATE_HALT;
+
+    return rc522_picc_send_halta(rc522);
+}
+
+static void rc522_inventory_dispatch(const rc522_handle_t rc522, rc522_event_t event, rc522_picc_t *picc)
+{
+    rc522_picc_inventory_event_t event_data = {
+        .picc = picc,
+    };
+
+    if (rc522_dispatch_event(rc522, event, &event_data, sizeof(event_data)) != ESP_OK) {
+        RC522_LOGW("failed to dispatch inventory event %d", event);
+    }
+}
+
+esp_err_t rc522_inventory(rc522_handle_t rc522, rc522_picc_t *out_piccs, uint8_t capacity, uint8_t *out_count)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(out_piccs == NULL && capacity > 0);
+
+    rc522_picc_t found[RC522_INVENTORY_SIZE_MAX];
+    uint8_t found_count = 0;
+    bool round_failed = false;
+
+    // PICCs halted by the previous inventory answer only WUPA, which would wake up
+    // the ones halted in this inventory as well. Switching the field off returns all of them into IDLE
+    RC522_RETURN_ON_ERROR(rc522_pcd_rf_reset(rc522));
+
+    for (uint8_t round = 0; round < RC522_INVENTORY_ROUNDS_MAX && found_count < RC522_INVENTORY_SIZE_MAX; round++) {
+        rc522_picc_t picc;
+        esp_err_t ret = rc522_inventory_next(rc522, &picc);
+
+        if (ret == RC522_ERR_RX_TIMER_TIMEOUT || ret == RC522_ERR_RX_TIMEOUT) {
+            if (!round_failed) {
+                // All PICCs in the field are halted
+                break;
+            }
+
+            // PICCs left in READY by the failed round went into IDLE on this REQA, ask them again
+            round_failed = false;
+            continue;
+        }
+
+        round_failed = (ret != ESP_OK);
+
+        if (ret != ESP_OK) {
+            RC522_LOGD("inventory round %d failed (err=%04" RC522_X ")", round, ret);
+            continue;
+        }
+
+        if (rc522_inventory_contains(found, found_count, &picc.uid)) {
+            continue;
+        }
+
+        memcpy(&found[found_count++], &picc, sizeof(rc522_picc_t));
+    }
+
+    for (uint8_t i = 0; i < rc522->inventory_count; i++) {
+        if (!rc522_inventory_contains(found, found_count, &rc522->inventory[i].uid)) {
+#if CONFIG_RC522_NTAG_CACHE
+            rc522_ntag_cache_forget(rc522, &rc522->inventory[i]);
+#endif
+            rc522_inventory_dispatch(rc522, RC522_EVENT_PICC_LEFT, &rc522->inventory[i]);
+        }
+    }
+
+    for (uint8_t i = 0; i < found_count; i++) {
+        if (!rc522_inventory_contains(rc522->inventory, rc522->inventory_count, &found[i].uid)) {
+            rc522_inventory_dispatch(rc522, RC522_EVENT_PICC_ARRIVED, &found[i]);
+        }
+    }
+
+    memcpy(rc522->inventory, found, found_count * sizeof(rc522_picc_t));
+    rc522->inventory_count = found_count;
+
+    if (out_piccs != NULL) {
+        memcpy(out_piccs, found, (found_count < capacity ? found_count : capacity) * sizeof(rc522_picc_t));
+    }
+
+    if (out_count != NULL) {
+        *out_count = found_count;
+    }
+
+    return ESP_OK;
+}
@@ -0,0 +1,199 @@
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include "rc522_types_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_pcd_internal.h"
+#include "rc522_picc_internal.h"
+#include "rc522_op_internal.h"
+#include "picc/rc522_ntag.h"
+
+RC522_LOG_DEFINE_BASE();
+
+/**
+ * MIFARE Classic authentication shared by the ops of a single run
+ */
+typedef struct
+{
+    bool attempted; /*<! Crypto1 has to be stopped after the run */
+    int8_t sector;  /*<! Authenticated sector, -1 if none */
+    rc522_mifare_key_t key;
+} rc522_op_auth_t;
+
+static inline bool rc522_op_picc_is_active(const rc522_picc_t *picc)
+{
+    return picc->state == RC522_PICC_STATE_ACTIVE || picc->state == RC522_PICC_STATE_ACTIVE_H;
+}
+
+static void rc522_op_complete(rc522_op_t *op, esp_err_t result)
+{
+    rc522_op_callback_t callback = op->callback;
+    void *callback_arg = op->callback_arg;
+
+    op->result = result;
+
+    // Op goes back to the caller here, it is not touched afterwards
+    // (the callback may release it, and so may the task in rc522_op_wait())
+    xSemaphoreGive(op->done);
+
+    if (callback != NULL) {
+        callback(op, callback_arg);
+    }
+}
+
+esp_err_t rc522_op_submit(rc522_handle_t rc522, rc522_op_t *op)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(op == NULL);
+    RC522_CHECK(op->type > RC522_OP_NTAG_READ);
+    RC522_CHECK(op->buffer == NULL);
+    RC522_CHECK(op->count == 0);
+    RC522_CHECK((op->address + op->count) > (UINT8_MAX + 1));
+    RC522_CHECK(op->uid.length > RC522_PICC_UID_SIZE_MAX);
+
+    op->result = ESP_ERR_INVALID_STATE;
+    op->done = xSemaphoreCreateBinaryStatic(&op->done_buffer);
+
+    if (xQueueSendToBack(rc522->ops, &op, 0) != pdTRUE) {
+        RC522_LOGW("op queue is full");
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_op_wait(rc522_op_t *op, uint32_t timeout_ms)
+{
+    RC522_CHECK(op == NULL);
+    RC522_CHECK(op->done == NULL);
+
+    if (xSemaphoreTake(op->done, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return op->result;
+}
+
+static esp_err_t rc522_op_run_mifare(
+    const rc522_handle_t rc522, const rc522_picc_t *picc, const rc522_op_t *op, rc522_op_auth_t *auth)
+{
+    RC522_CHECK_AND_RETURN(!rc522_mifare_type_is_classic_compatible(picc->type), ESP_ERR_NOT_SUPPORTED);
+
+    for (uint8_t i = 0; i < op->count; i++) {
+        uint8_t block_address = op->address + i;
+        uint8_t sector = rc522_mifare_get_sector_index_by_block_address(block_address);
+        uint8_t *buffer = op->buffer + (i * RC522_MIFARE_BLOCK_SIZE);
+
+        if (auth->sector != sector || memcmp(&auth->key, &op->key, sizeof(rc522_mifare_key_t)) != 0) {
+            auth->attempted = true;
+            auth->sector = -1;
+            RC522_RETURN_ON_ERROR_SILENTLY(rc522_mifare_auth(rc522, picc, block_address, &op->key));
+            auth->sector = sector;
+            memcpy(&auth->key, &op->key, sizeof(rc522_mifare_key_t));
+        }
+
+        if (op->type == RC522_OP_MIFARE_READ) {
+            RC522_RETURN_ON_ERROR_SILENTLY(rc522_mifare_read(rc522, picc, block_address, buffer));
+        }
+        else {
+            RC522_RETURN_ON_ERROR_SILENTLY(rc522_mifare_write(rc522, picc, block_address, buffer));
+        }
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_op_run_ntag(const rc522_handle_t rc522, const rc522_picc_t *picc, const rc522_op_t *op)
+{
+    RC522_CHECK_AND_RETURN(picc->type != RC522_PICC_TYPE_MIFARE_UL, ESP_ERR_NOT_SUPPORTED);
+
+    for (uint8_t i = 0; i < op->count; i++) {
+        RC522_RETURN_ON_ERROR_SILENTLY(
+            rc522_ntag_read(rc522, picc, op->address + i, op->buffer + (i * NTAG_PAGE_SIZE)));
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t rc522_op_run(
+    const rc522_handle_t rc522, const rc522_picc_t *picc, const rc522_op_t *op, rc522_op_auth_t *auth)
+{
+    if (op->uid.length > 0
+        && (op->uid.length != picc->uid.length || memcmp(op->uid.value, picc->uid.value, op->uid.length) != 0)) {
+        RC522_LOGD("op is meant for another PICC");
+
+        return RC522_ERR_OP_CANCELLED;
+    }
+
+    switch (op->type) {
+        case RC522_OP_MIFARE_READ:
+        case RC522_OP_MIFARE_WRITE:
+            return rc522_op_run_mifare(rc522, picc, op, auth);
+        case RC522_OP_NTAG_READ:
+            return rc522_op_run_ntag(rc522, picc, op);
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+}
+
+void rc522_op_run_pending(const rc522_handle_t rc522)
+{
+    rc522_picc_t *picc = &rc522->picc;
+
+    if (!rc522_op_picc_is_active(picc)) {
+        rc522_op_cancel_pending(rc522);
+        return;
+    }
+
+    if (uxQueueMessagesWaiting(rc522->ops) == 0) {
+        return;
+    }
+
+    // Presence checks other than SELECT do not leave the PICC selected
+    if (rc522->config->presence_check.mode != RC522_PRESENCE_CHECK_SELECT) {
+        esp_err_t ret = rc522_picc_reselect(rc522, picc);
+
+        if (ret != ESP_OK) {
+            RC522_LOGD("PICC not selected for the ops (err=%04" RC522_X ")", ret);
+            return;
+        }
+    }
+
+    rc522_op_auth_t auth = { .attempted = false, .sector = -1 };
+    rc522_op_t *op = NULL;
+
+    // Ops submitted during the run wait for the next one, so the polling is not held up
+    for (UBaseType_t pending = uxQueueMessagesWaiting(rc522->ops); pending > 0; pending--) {
+        if (xQueueReceive(rc522->ops, &op, 0) != pdTRUE) {
+            break;
+        }
+
+        esp_err_t ret = rc522_op_run(rc522, picc, op, &auth);
+
+        rc522_op_complete(op, ret);
+
+        if (ret != ESP_OK && ret != RC522_ERR_OP_CANCELLED) {
+            // Failed authentication or transaction may leave the PICC unselected,
+            // so the rest waits until the presence check selects it again
+            RC522_LOGD("op failed (err=%04" RC522_X ")", ret);
+            break;
+        }
+    }
+
+    // Same as rc522_mifare_deauth() at the end of the event handler
+    if (auth.attempted && rc522_pcd_stop_crypto1(rc522) != ESP_OK) {
+        RC522_LOGW("failed to stop crypto1");
+    }
+}
+
+void rc522_op_cancel_pending(const rc522_handle_t rc522)
+{
+    rc522_op_t *op = NULL;
+
+    while (xQueueReceive(rc522->ops, &op, 0) == pdTRUE) {
+        rc522_op_complete(op, RC522_ERR_OP_CANCELLED);
+    }
+}
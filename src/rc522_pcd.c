@@ -6,44 +6,173 @@
 #include "rc522_helpers_internal.h"
 #include "rc522_driver_internal.h"
 #include "rc522_pcd_internal.h"
+#include "rc522_stats_internal.h"
 
 RC522_LOG_DEFINE_BASE();
 
+/**
+ * Returns true if the register is shadowed. Volatile registers (command, interrupt
+ * requests, errors, status, FIFO, CRC result) are not shadowed since their value
+ * is changed by the PCD itself.
+ *
+ * @param[out] out_volatile_bits Bits of the shadowed register that can still be changed by the PCD
+ */
+static bool rc522_pcd_shadow_supported(rc522_pcd_register_t addr, uint8_t *out_volatile_bits)
+{
+    *out_volatile_bits = 0x00;
+
+    switch (addr) {
+        case RC522_PCD_STATUS_2_REG:
+            *out_volatile_bits = RC522_PCD_MF_CRYPTO1_ON_BIT; // Set by the MFAuthent command
+            return true;
+        case RC522_PCD_BIT_FRAMING_REG:
+            *out_volatile_bits = RC522_PCD_START_SEND_BIT; // Only valid in combination with Transceive
+            return true;
+        case RC522_PCD_COM_INT_EN_REG:
+        case RC522_PCD_DIV_INT_EN_REG:
+        case RC522_PCD_WATER_LEVEL_REG:
+        case RC522_PCD_COLL_REG: // Only ValuesAfterColl bit is writable, other bits are read-only
+        case RC522_PCD_MODE_REG:
+        case RC522_PCD_TX_MODE_REG:
+        case RC522_PCD_RX_MODE_REG:
+        case RC522_PCD_TX_CONTROL_REG:
+        case RC522_PCD_TX_ASK_REG:
+        case RC522_PCD_MOD_WIDTH_REG:
+        case RC522_PCD_RF_CFG_REG:
+        case RC522_PCD_TIMER_MODE_REG:
+        case RC522_PCD_TIMER_PRESCALER_REG:
+        case RC522_PCD_TIMER_RELOAD_MSB_REG:
+        case RC522_PCD_TIMER_RELOAD_LSB_REG:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void rc522_pcd_shadow_update(const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t value)
+{
+    uint8_t volatile_bits;
+
+    if (rc522_pcd_shadow_supported(addr, &volatile_bits)) {
+        rc522->shadow.values[addr] = value;
+        rc522->shadow.valid |= (1ULL << addr);
+    }
+}
+
+static void rc522_pcd_shadow_invalidate(const rc522_handle_t rc522, rc522_pcd_register_t addr)
+{
+    rc522->shadow.valid &= ~(1ULL << addr);
+}
+
+inline static bool rc522_pcd_shadow_equals(const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t value)
+{
+    return (rc522->shadow.valid & (1ULL << addr)) && rc522->shadow.values[addr] == value;
+}
+
 /**
  * @see https://stackoverflow.com/a/48705557
  */
-esp_err_t rc522_pcd_calculate_crc(const rc522_handle_t rc522, const rc522_bytes_t *bytes, rc522_pcd_crc_t *result)
+esp_err_t rc522_pcd_irq_arm(const rc522_handle_t rc522, uint8_t com_irq_bits, uint8_t div_irq_bits)
 {
     RC522_CHECK(rc522 == NULL);
-    RC522_CHECK_BYTES(bytes);
-    RC522_CHECK(result == NULL);
 
-    RC522_RETURN_ON_ERROR(rc522_pcd_stop_active_command(rc522));
-    RC522_RETURN_ON_ERROR(rc522_pcd_clear_bits(rc522, RC522_PCD_DIV_INT_REQ_REG, RC522_PCD_CRC_IRQ_BIT));
-    RC522_RETURN_ON_ERROR(rc522_pcd_fifo_flush(rc522));
-    RC522_RETURN_ON_ERROR(rc522_pcd_fifo_write(rc522, bytes));
-    RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_COMMAND_REG, RC522_PCD_CALC_CRC_CMD));
+    rc522_driver_handle_t driver = rc522->config->driver;
+
+    if (!rc522_driver_irq_enabled(driver)) {
+        return ESP_OK;
+    }
+
+    // Route only interrupts of the upcoming command to the IRQ pin. Any other pending
+    // interrupt would keep the pin asserted, so the falling edge would never come.
+    // Registers are shadowed, so these are no-ops if the command is the same as before.
+    RC522_RETURN_ON_ERROR(rc522_pcd_set_bits(rc522, RC522_PCD_COM_INT_EN_REG, com_irq_bits));
+    RC522_RETURN_ON_ERROR(
+        rc522_pcd_clear_bits(rc522, RC522_PCD_COM_INT_EN_REG, (uint8_t)(~(RC522_PCD_IRQ_INV_BIT | com_irq_bits))));
+    RC522_RETURN_ON_ERROR(rc522_pcd_set_bits(rc522, RC522_PCD_DIV_INT_EN_REG, div_irq_bits));
+    RC522_RETURN_ON_ERROR(rc522_pcd_clear_bits(
+        rc522, RC522_PCD_DIV_INT_EN_REG, (uint8_t)(~(RC522_PCD_IRQ_PUSH_PULL_BIT | div_irq_bits))));
+
+    return rc522_driver_irq_arm(driver);
+}
+
+esp_err_t rc522_pcd_irq_wait(const rc522_handle_t rc522, uint32_t deadline_ms)
+{
+    RC522_CHECK(rc522 == NULL);
 
-    uint32_t deadline_ms = rc522_millis() + 90;
-    bool calculation_done = false;
+    rc522_driver_handle_t driver = rc522->config->driver;
 
+    if (!rc522_driver_irq_enabled(driver)) {
+        return ESP_OK;
+    }
+
+    uint32_t now_ms = rc522_millis();
+
+    if (now_ms >= deadline_ms) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return rc522_driver_irq_wait(driver, deadline_ms - now_ms);
+}
+
+esp_err_t rc522_pcd_irq_disarm(const rc522_handle_t rc522)
+{
+    RC522_CHECK(rc522 == NULL);
+
+    rc522_driver_handle_t driver = rc522->config->driver;
+
+    if (!rc522_driver_irq_enabled(driver)) {
+        return ESP_OK;
+    }
+
+    return rc522_driver_irq_disarm(driver);
+}
+
+static esp_err_t rc522_pcd_wait_for_crc(const rc522_handle_t rc522, uint32_t deadline_ms)
+{
     do {
+        // Sleeps until the IRQ pin is asserted (no-op when registers are polled)
+        rc522_pcd_irq_wait(rc522, deadline_ms);
+
         uint8_t irq;
         RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, RC522_PCD_DIV_INT_REQ_REG, &irq));
 
         if (irq & RC522_PCD_CRC_IRQ_BIT) {
-            calculation_done = true;
-            break;
+            return ESP_OK;
         }
 
         taskYIELD();
     }
     while (rc522_millis() < deadline_ms);
 
-    if (!calculation_done) { // Deadline reached
-        return ESP_ERR_TIMEOUT;
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t rc522_pcd_calculate_crc(const rc522_handle_t rc522, const rc522_bytes_t *bytes, rc522_pcd_crc_t *result)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK_BYTES(bytes);
+    RC522_CHECK(result == NULL);
+
+    RC522_RETURN_ON_ERROR(rc522_pcd_irq_arm(rc522, 0x00, RC522_PCD_CRC_IEN_BIT));
+
+    rc522_driver_op_t ops[] = {
+        RC522_PCD_WRITE_OP(RC522_PCD_COMMAND_REG, RC522_PCD_IDLE_CMD), // Stop any active command
+        // Set2 bit is 0, so the marked CRCIRq bit is cleared
+        RC522_PCD_WRITE_OP(RC522_PCD_DIV_INT_REQ_REG, RC522_PCD_CRC_IRQ_BIT),
+        RC522_PCD_WRITE_OP(RC522_PCD_FIFO_LEVEL_REG, RC522_PCD_FLUSH_BUFFER_BIT),
+        RC522_PCD_WRITE_N_OP(RC522_PCD_FIFO_DATA_REG, *bytes),
+        RC522_PCD_WRITE_OP(RC522_PCD_COMMAND_REG, RC522_PCD_CALC_CRC_CMD),
+    };
+
+    esp_err_t ret = rc522_pcd_batch(rc522, ops, sizeof(ops) / sizeof(ops[0]));
+
+    if (ret == ESP_OK) {
+        ret = rc522_pcd_wait_for_crc(rc522, rc522_millis() + 90);
     }
 
+    rc522_pcd_irq_disarm(rc522);
+    RC522_RETURN_ON_ERROR(ret);
+
     rc522_pcd_crc_t crc = { 0 };
 
     RC522_RETURN_ON_ERROR(rc522_pcd_stop_active_command(rc522));
@@ -110,8 +239,13 @@ inline static esp_err_t rc522_pcd_soft_reset(const rc522_handle_t rc522, uint32_
 
 esp_err_t rc522_pcd_reset(const rc522_handle_t rc522, uint32_t timeout_ms)
 {
+    RC522_CHECK(rc522 == NULL);
+
     esp_err_t ret = ESP_OK;
 
+    // All registers are back to their reset values (or unknown if reset failed)
+    rc522->shadow.valid = 0;
+
     if ((ret = rc522_pcd_hard_reset(rc522, timeout_ms)) != ESP_OK) {
         if (ret != RC522_ERR_RST_PIN_UNUSED) {
             RC522_LOGW("hard reset failed, trying soft reset");
@@ -140,12 +274,64 @@ static esp_err_t rc522_pcd_configure_timer(const rc522_handle_t rc522, uint8_t m
     return ESP_OK;
 }
 
-inline static esp_err_t rc522_pcd_set_timer_reload_value(const rc522_handle_t rc522, uint16_t value)
+/**
+ * Writes only the bytes of the prescaler and reload value that differ from the shadowed ones
+ */
+static esp_err_t rc522_pcd_set_timer(const rc522_handle_t rc522, uint16_t prescaler, uint16_t reload)
 {
-    RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_TIMER_RELOAD_MSB_REG, (value >> 8) & 0xFF));
-    RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_TIMER_RELOAD_LSB_REG, value & 0xFF));
+    uint8_t values[] = {
+        RC522_PCD_T_AUTO_BIT | ((prescaler >> 8) & 0x0F),
+        prescaler & 0xFF,
+        (reload >> 8) & 0xFF,
+        reload & 0xFF,
+    };
+    const rc522_pcd_register_t addrs[] = {
+        RC522_PCD_TIMER_MODE_REG,
+        RC522_PCD_TIMER_PRESCALER_REG,
+        RC522_PCD_TIMER_RELOAD_MSB_REG,
+        RC522_PCD_TIMER_RELOAD_LSB_REG,
+    };
+    rc522_driver_op_t ops[4];
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        if (!rc522_pcd_shadow_equals(rc522, addrs[i], values[i])) {
+            ops[count++] = (rc522_driver_op_t)RC522_PCD_WRITE_N_OP(
+                addrs[i], ((rc522_bytes_t) { .ptr = &values[i], .length = 1 }));
+        }
+    }
 
-    return ESP_OK;
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    return rc522_pcd_batch(rc522, ops, count);
+}
+
+esp_err_t rc522_pcd_set_timeout(const rc522_handle_t rc522, uint32_t timeout_us)
+{
+    RC522_CHECK(rc522 == NULL);
+
+    uint32_t periods = (timeout_us + RC522_PCD_TIMER_PERIOD_US - 1) / RC522_PCD_TIMER_PERIOD_US;
+
+    // Timeouts longer than 65535 periods (1.6 s) are counted by a slower timer. Its period
+    // is an odd multiple of 25 us, so that 2 * TPrescaler + 1 stays a multiple of 2 * 169 + 1
+    uint32_t scale = ((periods + UINT16_MAX - 1) / UINT16_MAX) | 1;
+
+    if (scale > RC522_PCD_TIMER_SCALE_MAX) {
+        scale = RC522_PCD_TIMER_SCALE_MAX;
+    }
+
+    uint32_t reload = (periods + scale - 1) / scale;
+
+    if (reload < 1) {
+        reload = 1;
+    }
+    else if (reload > UINT16_MAX) {
+        reload = UINT16_MAX;
+    }
+
+    return rc522_pcd_set_timer(rc522, ((2 * RC522_PCD_TIMER_PRESCALER + 1) * scale - 1) / 2, reload);
 }
 
 inline static esp_err_t rc522_pcd_set_rx_gain(const rc522_handle_t rc522, rc522_pcd_rx_gain_t gain)
@@ -170,19 +356,30 @@ esp_err_t rc522_pcd_init(const rc522_handle_t rc522)
 
     // TAuto=1; timer starts automatically at the end of the transmission in all communication modes at all speeds
     // TPreScaler = TModeReg[3..0]:TPrescalerReg, ie 0x0A9 = 169 => f_timer=40kHz, ie a timer period of 25μs.
-    RC522_RETURN_ON_ERROR(rc522_pcd_configure_timer(rc522, RC522_PCD_T_AUTO_BIT, 169));
+    RC522_RETURN_ON_ERROR(rc522_pcd_configure_timer(rc522, RC522_PCD_T_AUTO_BIT, RC522_PCD_TIMER_PRESCALER));
 
-    // Reload timer with 0x3E8 = 1000, ie 25ms before timeout.
-    RC522_RETURN_ON_ERROR(rc522_pcd_set_timer_reload_value(rc522, 1000));
+    // 25ms before timeout. Transactions with the PICC change it when they need a different one
+    RC522_RETURN_ON_ERROR(rc522_pcd_set_timeout(rc522, RC522_PCD_TIMEOUT_US_DEFAULT));
 
     RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_TX_ASK_REG, RC522_PCD_FORCE_100_ASK_BIT));
 
+    // LoAlert and HiAlert are raised when the FIFO is half empty or half full,
+    // so frames longer than the FIFO are streamed in chunks of half of its size
+    RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_WATER_LEVEL_REG, RC522_PCD_WATER_LEVEL));
+
     // Default 0x3F. Set the preset value for the CRC coprocessor for the CalcCRC command to 0x6363 (ISO 14443-3
     // part 6.2.4)
     RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522,
         RC522_PCD_MODE_REG,
         (RC522_PCD_TX_WAIT_RF_BIT | RC522_PCD_POL_MFIN_BIT | RC522_PCD_CRC_PRESET_6363H)));
 
+    if (rc522_driver_irq_enabled(rc522->config->driver)) {
+        // Drive the IRQ pin (active low), so no external pull-up is needed.
+        // Interrupts are enabled per command, see rc522_pcd_irq_arm
+        RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_DIV_INT_EN_REG, RC522_PCD_IRQ_PUSH_PULL_BIT));
+        RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_COM_INT_EN_REG, RC522_PCD_IRQ_INV_BIT));
+    }
+
     // Enable the antenna driver pins TX1 and TX2 (they were disabled by the reset)
     RC522_RETURN_ON_ERROR(rc522_pcd_tx_enable(rc522));
 
@@ -201,6 +398,20 @@ esp_err_t rc522_pcd_init(const rc522_handle_t rc522)
     return ESP_OK;
 }
 
+esp_err_t rc522_pcd_rf_reset(const rc522_handle_t rc522)
+{
+    RC522_CHECK(rc522 == NULL);
+
+    RC522_RETURN_ON_ERROR(
+        rc522_pcd_clear_bits(rc522, RC522_PCD_TX_CONTROL_REG, (RC522_PCD_TX2_RF_EN_BIT | RC522_PCD_TX1_RF_EN_BIT)));
+    rc522_delay_ms(RC522_PCD_RF_RESET_OFF_MS);
+
+    RC522_RETURN_ON_ERROR(rc522_pcd_tx_enable(rc522));
+    rc522_delay_ms(RC522_PCD_RF_RESET_GUARD_MS);
+
+    return ESP_OK;
+}
+
 esp_err_t rc522_pcd_firmware(const rc522_handle_t rc522, rc522_pcd_firmware_t *fw)
 {
     RC522_CHECK(rc522 == NULL);
@@ -316,7 +527,15 @@ inline esp_err_t rc522_pcd_write_n(const rc522_handle_t rc522, rc522_pcd_registe
         RC522_LOGV("pcd [0x%02" RC522_X "] <<< %s", addr, debug_buffer);
     }
 
-    RC522_RETURN_ON_ERROR(rc522_driver_send(rc522->config->driver, addr, bytes));
+    RC522_STATS_BUS_OP(rc522);
+    esp_err_t ret = rc522_driver_send(rc522->config->driver, addr, bytes);
+
+    if (ret != ESP_OK) {
+        rc522_pcd_shadow_invalidate(rc522, addr);
+        RC522_RETURN_ON_ERROR(ret);
+    }
+
+    rc522_pcd_shadow_update(rc522, addr, bytes->ptr[bytes->length - 1]);
 
     return ESP_OK;
 }
@@ -331,6 +550,7 @@ inline esp_err_t rc522_pcd_read_n(const rc522_handle_t rc522, rc522_pcd_register
     RC522_CHECK(rc522 == NULL);
     RC522_CHECK_BYTES(bytes);
 
+    RC522_STATS_BUS_OP(rc522);
     esp_err_t ret = rc522_driver_receive(rc522->config->driver, addr, bytes);
 
     if (RC522_LOG_LEVEL >= ESP_LOG_VERBOSE) {
@@ -347,18 +567,124 @@ inline esp_err_t rc522_pcd_read(const rc522_handle_t rc522, rc522_pcd_register_t
     return rc522_pcd_read_n(rc522, addr, &(rc522_bytes_t) { .ptr = value_ref, .length = 1 });
 }
 
-inline esp_err_t rc522_pcd_set_bits(const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t bits)
+esp_err_t rc522_pcd_batch(const rc522_handle_t rc522, rc522_driver_op_t *ops, uint8_t count)
 {
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(ops == NULL);
+
+    RC522_STATS_BUS_OP(rc522);
+    esp_err_t ret = rc522_driver_batch(rc522->config->driver, ops, count);
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (ops[i].type != RC522_DRIVER_OP_WRITE) {
+            continue;
+        }
+
+        if (ret == ESP_OK) {
+            rc522_pcd_shadow_update(rc522, ops[i].address, ops[i].bytes.ptr[ops[i].bytes.length - 1]);
+        }
+        else {
+            rc522_pcd_shadow_invalidate(rc522, ops[i].address);
+        }
+    }
+
+    if (RC522_LOG_LEVEL >= ESP_LOG_VERBOSE) {
+        char debug_buffer[64];
+
+        for (uint8_t i = 0; i < count; i++) {
+            rc522_buffer_to_hex_str(ops[i].bytes.ptr, ops[i].bytes.length, debug_buffer, sizeof(debug_buffer));
+            RC522_LOGV("pcd [0x%02" RC522_X "] %s %s",
+                ops[i].address,
+                ops[i].type == RC522_DRIVER_OP_WRITE ? "<<<" : ">>>",
+                debug_buffer);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * Reads the register for read-modify-write of the given bits.
+ * Value is taken from the shadow if it is known and none of the bits
+ * which can be changed by the PCD would be written back.
+ *
+ * @param[out] out_cached Set to true if the value is taken from the shadow
+ */
+static esp_err_t rc522_pcd_read_for_update(
+    const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t bits, uint8_t *value_ref, bool *out_cached)
+{
+    uint8_t volatile_bits;
+
+    *out_cached = rc522_pcd_shadow_supported(addr, &volatile_bits) && (rc522->shadow.valid & (1ULL << addr))
+                  && (volatile_bits & ~bits) == 0;
+
+    if (*out_cached) {
+        *value_ref = rc522->shadow.values[addr];
+
+        return ESP_OK;
+    }
+
+    return rc522_pcd_read(rc522, addr, value_ref);
+}
+
+/**
+ * Replaces the bits of the mask with the bits of the value, the rest of the register is kept
+ */
+static esp_err_t rc522_pcd_update_field(
+    const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t mask, uint8_t field_value)
+{
+    RC522_CHECK(rc522 == NULL);
+
     uint8_t value;
-    RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, addr, &value));
+    bool cached;
+    RC522_RETURN_ON_ERROR(rc522_pcd_read_for_update(rc522, addr, mask, &value, &cached));
+
+    uint8_t new_value = (value & (~mask)) | (field_value & mask);
+    uint8_t volatile_bits;
+    rc522_pcd_shadow_supported(addr, &volatile_bits);
+
+    // Skip the write if register already has the requested value
+    if (cached && new_value == value && (mask & volatile_bits) == 0) {
+        return ESP_OK;
+    }
+
+    return rc522_pcd_write(rc522, addr, new_value);
+}
+
+static esp_err_t rc522_pcd_update_bits(const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t bits, bool set)
+{
+    return rc522_pcd_update_field(rc522, addr, bits, set ? bits : 0x00);
+}
 
-    return rc522_pcd_write(rc522, addr, value | bits);
+inline esp_err_t rc522_pcd_set_bits(const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t bits)
+{
+    return rc522_pcd_update_bits(rc522, addr, bits, true);
 }
 
 inline esp_err_t rc522_pcd_clear_bits(const rc522_handle_t rc522, rc522_pcd_register_t addr, uint8_t bits)
 {
-    uint8_t value;
-    ESP_RETURN_ON_ERROR(rc522_pcd_read(rc522, addr, &value), TAG, "");
+    return rc522_pcd_update_bits(rc522, addr, bits, false);
+}
 
-    return rc522_pcd_write(rc522, addr, value & (~bits));
+esp_err_t rc522_pcd_set_speed(const rc522_handle_t rc522, rc522_pcd_speed_t tx_speed, rc522_pcd_speed_t rx_speed)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(tx_speed > RC522_PCD_SPEED_848);
+    RC522_CHECK(rx_speed > RC522_PCD_SPEED_848);
+
+    // Pulse width of the Miller coding is shortened together with the bit duration
+    static const uint8_t mod_widths[] = {
+        [RC522_PCD_SPEED_106] = RC522_PCD_MOD_WIDTH_REG_RESET_VALUE,
+        [RC522_PCD_SPEED_212] = 0x15,
+        [RC522_PCD_SPEED_424] = 0x0A,
+        [RC522_PCD_SPEED_848] = 0x05,
+    };
+
+    RC522_RETURN_ON_ERROR(rc522_pcd_update_field(
+        rc522, RC522_PCD_TX_MODE_REG, RC522_PCD_SPEED_MASK, (uint8_t)(tx_speed << RC522_PCD_SPEED_SHIFT)));
+    RC522_RETURN_ON_ERROR(rc522_pcd_update_field(
+        rc522, RC522_PCD_RX_MODE_REG, RC522_PCD_SPEED_MASK, (uint8_t)(rx_speed << RC522_PCD_SPEED_SHIFT)));
+    RC522_RETURN_ON_ERROR(rc522_pcd_update_field(rc522, RC522_PCD_MOD_WIDTH_REG, 0xFF, mod_widths[tx_speed]));
+
+    return ESP_OK;
 }
@@ -6,20 +6,141 @@
 #include "rc522_types_internal.h"
 #include "rc522_helpers_internal.h"
 #include "rc522_pcd_internal.h"
+#include "rc522_crc_internal.h"
 #include "rc522_picc_internal.h"
+#include "rc522_stats_internal.h"
+#include "rc522_arbiter_internal.h"
+#include "rc522_ntag_internal.h"
 
 RC522_LOG_DEFINE_BASE();
 
 struct rc522_picc_transaction_context
 {
     const rc522_picc_transaction_t *transaction;
+    uint32_t timeout_us;
     uint8_t interrupts;
     bool completed;
     uint8_t error_reg;
+    uint8_t fifo_level;
+    uint8_t control_reg;
+    uint8_t stream_bits;     /*<! LoAlert and HiAlert interrupts used to stream the frame, 0 if it fits the FIFO */
+    uint8_t tx_written;      /*<! Bytes of the frame written into the FIFO */
+    rc522_bytes_t rx_buffer; /*<! Buffer of the caller, the response is streamed into it */
+    uint8_t rx_streamed;     /*<! Bytes of the response read out of the FIFO before its end was received */
 };
 
-esp_err_t rc522_picc_send(const rc522_handle_t rc522, const rc522_picc_transaction_t *transaction,
-    rc522_picc_transaction_context_t *out_context)
+/**
+ * Refills the FIFO with the rest of the frame, or drains the part of the response received so far,
+ * while the frame is still on the air. Alert interrupts are requested as long as the FIFO level is
+ * beyond the water level, so they are cleared only once the FIFO has been served.
+ */
+static esp_err_t rc522_picc_stream(const rc522_handle_t rc522, rc522_picc_transaction_context_t *context)
+{
+    const rc522_bytes_t *bytes = &context->transaction->bytes;
+    uint8_t fifo_level = 0;
+
+    if (context->tx_written < bytes->length) {
+        if (!(context->interrupts & RC522_PCD_LO_ALERT_IRQ_BIT)) {
+            return ESP_OK;
+        }
+
+        RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, RC522_PCD_FIFO_LEVEL_REG, &fifo_level));
+
+        uint8_t remaining = bytes->length - context->tx_written;
+        uint8_t room = RC522_PCD_FIFO_SIZE - fifo_level;
+        rc522_bytes_t chunk = {
+            .ptr = bytes->ptr + context->tx_written,
+            .length = remaining < room ? remaining : room,
+        };
+
+        if (chunk.length > 0) {
+            RC522_RETURN_ON_ERROR(rc522_pcd_fifo_write(rc522, &chunk));
+            context->tx_written += chunk.length;
+        }
+
+        RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_COM_INT_REQ_REG, RC522_PCD_LO_ALERT_IRQ_BIT));
+
+        // Transmission ends once the FIFO runs empty, nothing is left to refill it with
+        if (context->tx_written == bytes->length) {
+            RC522_RETURN_ON_ERROR(rc522_pcd_clear_bits(rc522, RC522_PCD_COM_INT_EN_REG, RC522_PCD_LO_ALERT_IRQ_BIT));
+        }
+
+        return ESP_OK;
+    }
+
+    // FIFO is above the water level during the transmission as well
+    if (!(context->stream_bits & RC522_PCD_HI_ALERT_IRQ_BIT) || !(context->interrupts & RC522_PCD_TX_IRQ_BIT)
+        || !(context->interrupts & RC522_PCD_HI_ALERT_IRQ_BIT)) {
+        return ESP_OK;
+    }
+
+    RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, RC522_PCD_FIFO_LEVEL_REG, &fifo_level));
+    RC522_CHECK((context->rx_streamed + fifo_level) > context->rx_buffer.length);
+
+    if (fifo_level > 0) {
+        rc522_bytes_t chunk = { .ptr = context->rx_buffer.ptr + context->rx_streamed, .length = fifo_level };
+
+        RC522_RETURN_ON_ERROR(rc522_pcd_fifo_read(rc522, &chunk));
+        context->rx_streamed += fifo_level;
+    }
+
+    return rc522_pcd_write(rc522, RC522_PCD_COM_INT_REQ_REG, RC522_PCD_HI_ALERT_IRQ_BIT);
+}
+
+static esp_err_t rc522_picc_wait_for_completion(const rc522_handle_t rc522, rc522_picc_transaction_context_t *context)
+{
+    // TAuto flag in TModeReg is set.
+    // This means the timer automatically starts when the PCD stops transmitting.
+
+    uint32_t stream_time_us = context->stream_bits
+                                  ? (context->transaction->bytes.length + context->rx_buffer.length)
+                                        * RC522_PICC_BYTE_TIME_US
+                                  : 0;
+    const uint32_t deadline = rc522_millis() + ((context->timeout_us + stream_time_us) / 1000)
+                              + RC522_PICC_DEADLINE_MARGIN_MS;
+
+    do {
+        // Sleeps until the IRQ pin is asserted (no-op when registers are polled).
+        // Alert interrupts keep the pin asserted while the FIFO is being served, so streamed frames are polled.
+        if (!context->stream_bits) {
+            rc522_pcd_irq_wait(rc522, deadline);
+        }
+
+        RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, RC522_PCD_COM_INT_REQ_REG, &context->interrupts));
+
+        if (context->interrupts & context->transaction->expected_interrupts) {
+            context->completed = true;
+            break;
+        }
+
+        // Timer interrupt - nothing received
+        if (context->interrupts & RC522_PCD_TIMER_IRQ_BIT) {
+            RC522_LOGD("timer interrupt (irq=0x%02" RC522_X ")", context->interrupts);
+
+            return RC522_ERR_RX_TIMER_TIMEOUT;
+        }
+
+        if (context->stream_bits) {
+            RC522_RETURN_ON_ERROR(rc522_picc_stream(rc522, context));
+        }
+
+        taskYIELD();
+    }
+    while (rc522_millis() < deadline);
+
+    // Deadline reached and nothing happened.
+    // Communication with the MFRC522 might be down.
+    RC522_RETURN_ON_FALSE(context->completed, RC522_ERR_RX_TIMEOUT);
+
+    return ESP_OK;
+}
+
+/**
+ * @param rx_buffer Buffer for the response, which is streamed into it if it is longer than the FIFO.
+ *                  NULL if the response is read by the caller.
+ */
+static esp_err_t rc522_picc_send_frame(const rc522_handle_t rc522, const rc522_picc_transaction_t *transaction,
+    const rc522_bytes_t *rx_buffer, rc522_picc_transaction_context_t *out_context)
 {
     RC522_CHECK(rc522 == NULL);
     RC522_CHECK(transaction == NULL);
@@ -30,8 +151,27 @@ esp_err_t rc522_picc_send(const rc522_handle_t rc522, const rc522_picc_transacti
 
     rc522_picc_transaction_context_t context = {
         .transaction = transaction,
+        .timeout_us = transaction->timeout_us ? transaction->timeout_us : RC522_PCD_TIMEOUT_US_DEFAULT,
+        .tx_written = transaction->bytes.length < RC522_PCD_FIFO_SIZE ? transaction->bytes.length : RC522_PCD_FIFO_SIZE,
     };
 
+    // Rest of the frame is written as the FIFO runs empty
+    if (context.tx_written < transaction->bytes.length) {
+        RC522_CHECK(transaction->pcd_command != RC522_PCD_TRANSCEIVE_CMD);
+
+        context.stream_bits |= RC522_PCD_LO_ALERT_IRQ_BIT;
+    }
+
+    // Response is read out as the FIFO fills up. Bits before RxAlign are merged
+    // with the first byte of the buffer, so aligned responses are never streamed.
+    if (rx_buffer != NULL && rx_buffer->length > RC522_PCD_FIFO_SIZE && transaction->rx_align == 0
+        && transaction->pcd_command == RC522_PCD_TRANSCEIVE_CMD) {
+        context.stream_bits |= RC522_PCD_HI_ALERT_IRQ_BIT;
+        context.rx_buffer = *rx_buffer;
+    }
+
+    rc522_bytes_t first_chunk = { .ptr = transaction->bytes.ptr, .length = context.tx_written };
+
     // Prepare values for bit framing
     uint8_t bit_framing = (transaction->rx_align << 4) + transaction->valid_bits;
 
@@ -46,47 +186,77 @@ esp_err_t rc522_picc_send(const rc522_handle_t rc522, const rc522_picc_transacti
         RC522_LOGD("picc << %s", debug_buffer);
     }
 
-    RC522_RETURN_ON_ERROR(rc522_pcd_stop_active_command(rc522));
-    RC522_RETURN_ON_ERROR(rc522_pcd_clear_all_com_interrupts(rc522));
-    RC522_RETURN_ON_ERROR(rc522_pcd_fifo_flush(rc522));
-    RC522_RETURN_ON_ERROR(rc522_pcd_fifo_write(rc522, &transaction->bytes));
-    RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_BIT_FRAMING_REG, bit_framing));
-    RC522_RETURN_ON_ERROR(rc522_pcd_write(rc522, RC522_PCD_COMMAND_REG, transaction->pcd_command));
+    // Inline CRC_A. Registers are shadowed, so these are no-ops if nothing changes
+    if (transaction->tx_crc) {
+        RC522_RETURN_ON_ERROR(rc522_pcd_set_bits(rc522, RC522_PCD_TX_MODE_REG, RC522_PCD_TX_CRC_EN_BIT));
+    }
+    else {
+        RC522_RETURN_ON_ERROR(rc522_pcd_clear_bits(rc522, RC522_PCD_TX_MODE_REG, RC522_PCD_TX_CRC_EN_BIT));
+    }
 
-    if (transaction->pcd_command == RC522_PCD_TRANSCEIVE_CMD) {
-        RC522_RETURN_ON_ERROR(rc522_pcd_start_data_transmission(rc522));
+    if (transaction->rx_crc) {
+        RC522_RETURN_ON_ERROR(rc522_pcd_set_bits(rc522, RC522_PCD_RX_MODE_REG, RC522_PCD_RX_CRC_EN_BIT));
+    }
+    else {
+        RC522_RETURN_ON_ERROR(rc522_pcd_clear_bits(rc522, RC522_PCD_RX_MODE_REG, RC522_PCD_RX_CRC_EN_BIT));
     }
 
-    // TAuto flag in TModeReg is set.
-    // This means the timer automatically starts when the PCD stops transmitting.
+    rc522_driver_op_t ops[] = {
+        RC522_PCD_WRITE_OP(RC522_PCD_COMMAND_REG, RC522_PCD_IDLE_CMD), // Stop any active command
+        RC522_PCD_WRITE_OP(RC522_PCD_FIFO_LEVEL_REG, RC522_PCD_FLUSH_BUFFER_BIT),
+        RC522_PCD_WRITE_N_OP(RC522_PCD_FIFO_DATA_REG, first_chunk),
+        // Clear all interrupts, LoAlert of the empty FIFO included
+        RC522_PCD_WRITE_OP(RC522_PCD_COM_INT_REQ_REG, (uint8_t)(~RC522_PCD_SET_1_BIT)),
+        RC522_PCD_WRITE_OP(RC522_PCD_BIT_FRAMING_REG, bit_framing),
+        RC522_PCD_WRITE_OP(RC522_PCD_COMMAND_REG, transaction->pcd_command),
+        // Start the transmission (transceive only). Value of the register is known,
+        // so there is no need for read-modify-write
+        RC522_PCD_WRITE_OP(RC522_PCD_BIT_FRAMING_REG, bit_framing | RC522_PCD_START_SEND_BIT),
+    };
 
-    const uint32_t deadline = rc522_millis() + 36;
+    uint8_t ops_count = sizeof(ops) / sizeof(ops[0]);
 
-    do {
-        RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, RC522_PCD_COM_INT_REQ_REG, &context.interrupts));
+    if (transaction->pcd_command != RC522_PCD_TRANSCEIVE_CMD) {
+        ops_count--;
+    }
 
-        if (context.interrupts & transaction->expected_interrupts) {
-            context.completed = true;
-            break;
-        }
+    RC522_RETURN_ON_ERROR(rc522_pcd_set_timeout(rc522, context.timeout_us));
 
-        // Timer interrupt - nothing received
-        if (context.interrupts & RC522_PCD_TIMER_IRQ_BIT) {
-            RC522_LOGD("timer interrupt (irq=0x%02" RC522_X ")", context.interrupts);
+    // Timer interrupt is enabled as well, to wake up when nothing is received
+    RC522_RETURN_ON_ERROR(rc522_pcd_irq_arm(rc522, transaction->expected_interrupts | RC522_PCD_TIMER_IRQ_BIT, 0x00));
 
-            return RC522_ERR_RX_TIMER_TIMEOUT;
-        }
+    // Alert interrupts tell when the FIFO has to be refilled or drained
+    if (context.stream_bits) {
+        RC522_RETURN_ON_ERROR(rc522_pcd_set_bits(rc522, RC522_PCD_COM_INT_EN_REG, context.stream_bits));
+    }
 
-        taskYIELD();
+    esp_err_t ret = rc522_pcd_batch(rc522, ops, ops_count);
+
+    if (ret == ESP_OK) {
+        ret = rc522_picc_wait_for_completion(rc522, &context);
     }
-    while (rc522_millis() < deadline);
 
-    // Deadline reached and nothing happened.
-    // Communication with the MFRC522 might be down.
-    RC522_RETURN_ON_FALSE(context.completed, RC522_ERR_RX_TIMEOUT);
+    rc522_pcd_irq_disarm(rc522);
+
+    if (context.stream_bits) {
+        esp_err_t clear_ret = rc522_pcd_clear_bits(rc522, RC522_PCD_COM_INT_EN_REG, context.stream_bits);
+        ret = ret == ESP_OK ? clear_ret : ret;
+    }
+
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Read everything needed to handle the result at once
+    rc522_driver_op_t status_ops[] = {
+        RC522_PCD_READ_OP(RC522_PCD_ERROR_REG, &context.error_reg),
+        RC522_PCD_READ_OP(RC522_PCD_FIFO_LEVEL_REG, &context.fifo_level),
+        RC522_PCD_READ_OP(RC522_PCD_CONTROL_REG, &context.control_reg),
+    };
+
+    RC522_RETURN_ON_ERROR(rc522_pcd_batch(rc522, status_ops, sizeof(status_ops) / sizeof(status_ops[0])));
 
     // Stop now if any errors except collisions were detected.
-    RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, RC522_PCD_ERROR_REG, &context.error_reg));
 
     if (context.error_reg & RC522_PCD_BUFFER_OVFL_BIT) {
         return RC522_ERR_PCD_FIFO_BUFFER_OVERFLOW;
@@ -101,6 +271,11 @@ esp_err_t rc522_picc_send(const rc522_handle_t rc522, const rc522_picc_transacti
 
         return RC522_ERR_PCD_PROTOCOL_ERROR;
     }
+    else if (transaction->rx_crc && (context.error_reg & RC522_PCD_CRC_ERR_BIT)) {
+        RC522_LOGD("crc error detected");
+
+        return RC522_ERR_CRC_WRONG;
+    }
 
     if (out_context) {
         memcpy(out_context, &context, sizeof(context));
@@ -109,6 +284,18 @@ esp_err_t rc522_picc_send(const rc522_handle_t rc522, const rc522_picc_transacti
     return ESP_OK;
 }
 
+esp_err_t rc522_picc_send(const rc522_handle_t rc522, const rc522_picc_transaction_t *transaction,
+    rc522_picc_transaction_context_t *out_context)
+{
+    RC522_CHECK(rc522 == NULL);
+
+    RC522_RETURN_ON_ERROR(rc522_arbiter_acquire(rc522));
+    esp_err_t ret = rc522_picc_send_frame(rc522, transaction, NULL, out_context);
+    rc522_arbiter_release(rc522);
+
+    return ret;
+}
+
 static esp_err_t rc522_picc_receive(const rc522_handle_t rc522, const rc522_picc_transaction_context_t *context,
     rc522_picc_transaction_result_t *out_result)
 {
@@ -118,25 +305,32 @@ static esp_err_t rc522_picc_receive(const rc522_handle_t rc522, const rc522_picc
     RC522_CHECK(out_result == NULL);
     RC522_CHECK_BYTES(&context->transaction->bytes);
 
-    uint8_t fifo_level = 0;
-    RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, RC522_PCD_FIFO_LEVEL_REG, &fifo_level));
+    uint8_t fifo_level = context->fifo_level;
 
-    if (fifo_level < 1) {
+    if (fifo_level < 1 && context->rx_streamed < 1) {
         RC522_LOGW("fifo empty (irq=0x%02" RC522_X ")", context->interrupts);
 
         return RC522_ERR_PCD_FIFO_EMPTY;
     }
 
-    RC522_CHECK(fifo_level > out_result->bytes.length);
+    RC522_CHECK((context->rx_streamed + fifo_level) > out_result->bytes.length);
 
     rc522_picc_transaction_result_t result = {
         .bytes = { 
             .ptr = out_result->bytes.ptr, // Use buffer provided by caller
-            .length = fifo_level,
+            .length = context->rx_streamed + fifo_level,
         },
     };
 
-    RC522_RETURN_ON_ERROR(rc522_pcd_fifo_read(rc522, &result.bytes));
+    // Bits 0..rx_align-1 of the first byte are not received, they are kept
+    // from the caller's buffer (e.g. known bits of the UID during anticollision)
+    uint8_t first_byte = result.bytes.ptr[0];
+
+    // Beginning of a streamed response is in the buffer already
+    if (fifo_level > 0) {
+        RC522_RETURN_ON_ERROR(rc522_pcd_fifo_read(
+            rc522, &(rc522_bytes_t) { .ptr = result.bytes.ptr + context->rx_streamed, .length = fifo_level }));
+    }
 
     if (RC522_LOG_LEVEL >= ESP_LOG_DEBUG) {
         char debug_buffer[64];
@@ -148,13 +342,13 @@ static esp_err_t rc522_picc_receive(const rc522_handle_t rc522, const rc522_picc
         RC522_LOGD("applying mask (rx_align=%d)", context->transaction->rx_align);
 
         // Apply mask for rx_align..7 of the first byte
-        result.bytes.ptr[0] &= (0xFF << context->transaction->rx_align);
+        uint8_t mask = (0xFF << context->transaction->rx_align);
+        result.bytes.ptr[0] = (first_byte & ~mask) | (result.bytes.ptr[0] & mask);
     }
 
     // RxLastBits[2:0] indicates the number of valid bits in the last received byte.
     // If this value is 0, the whole byte is valid.
-    RC522_RETURN_ON_ERROR(rc522_pcd_read(rc522, RC522_PCD_CONTROL_REG, &result.valid_bits));
-    result.valid_bits &= 0x07;
+    result.valid_bits = context->control_reg & 0x07;
 
     if (result.valid_bits) {
         RC522_LOGD("not full byte received, valid_bits=%d", result.valid_bits);
@@ -173,7 +367,7 @@ static esp_err_t rc522_picc_receive(const rc522_handle_t rc522, const rc522_picc
 
         // Verify CRC_A
         rc522_pcd_crc_t crc = { 0 };
-        RC522_RETURN_ON_ERROR(rc522_pcd_calculate_crc(rc522,
+        RC522_RETURN_ON_ERROR(rc522_crc_calculate(rc522,
             &(rc522_bytes_t) { .ptr = result.bytes.ptr, .length = result.bytes.length - 2 },
             &crc));
 
@@ -187,6 +381,20 @@ static esp_err_t rc522_picc_receive(const rc522_handle_t rc522, const rc522_picc
     return ESP_OK;
 }
 
+static esp_err_t rc522_picc_transceive_frame(const rc522_handle_t rc522, const rc522_picc_transaction_t *transaction,
+    rc522_picc_transaction_result_t *out_result)
+{
+    rc522_picc_transaction_context_t context = { 0 };
+    RC522_RETURN_ON_ERROR_SILENTLY(
+        rc522_picc_send_frame(rc522, transaction, out_result ? &out_result->bytes : NULL, &context));
+
+    if (out_result) {
+        RC522_RETURN_ON_ERROR(rc522_picc_receive(rc522, &context, out_result));
+    }
+
+    return ESP_OK;
+}
+
 esp_err_t rc522_picc_transceive(const rc522_handle_t rc522, const rc522_picc_transaction_t *transaction,
     rc522_picc_transaction_result_t *out_result)
 {
@@ -199,14 +407,12 @@ esp_err_t rc522_picc_transceive(const rc522_handle_t rc522, const rc522_picc_tra
     transaction_clone.pcd_command = RC522_PCD_TRANSCEIVE_CMD;
     transaction_clone.expected_interrupts = RC522_PCD_RX_IRQ_BIT | RC522_PCD_IDLE_IRQ_BIT;
 
-    rc522_picc_transaction_context_t context = { 0 };
-    RC522_RETURN_ON_ERROR_SILENTLY(rc522_picc_send(rc522, &transaction_clone, &context));
-
-    if (out_result) {
-        RC522_RETURN_ON_ERROR(rc522_picc_receive(rc522, &context, out_result));
-    }
+    // Bus is held until the response is read out of the FIFO
+    RC522_RETURN_ON_ERROR(rc522_arbiter_acquire(rc522));
+    esp_err_t ret = rc522_picc_transceive_frame(rc522, &transaction_clone, out_result);
+    rc522_arbiter_release(rc522);
 
-    return ESP_OK;
+    return ret;
 }
 
 inline static esp_err_t rc522_picc_parse_atqa(uint16_t atqa, rc522_picc_atqa_desc_t *out_atqa)
@@ -231,11 +437,15 @@ static esp_err_t rc522_picc_reqa_or_wupa(const rc522_handle_t rc522, uint8_t pic
 
     RC522_RETURN_ON_ERROR(rc522_pcd_clear_bits(rc522, RC522_PCD_COLL_REG, RC522_PCD_VALUES_AFTER_COLL_BIT));
 
+    // Activation always runs at 106 kBd, bit rate of the previous ISO-DEP session is not kept
+    RC522_RETURN_ON_ERROR(rc522_pcd_set_speed(rc522, RC522_PCD_SPEED_106, RC522_PCD_SPEED_106));
+
     uint8_t buffer[2] = { 0 };
 
     rc522_picc_transaction_t transaction = {
         .bytes = { .ptr = &picc_cmd, .length = 1 },
         .valid_bits = 7, // REQA and WUPA use short frame format
+        .timeout_us = RC522_PICC_TIMEOUT_US_ACTIVATION,
     };
 
     rc522_picc_transaction_result_t transaction_result = {
@@ -269,7 +479,12 @@ inline esp_err_t rc522_picc_reqa(const rc522_handle_t rc522, rc522_picc_atqa_des
     RC522_CHECK(out_atqa == NULL);
 
     RC522_LOGD("REQA");
-    return rc522_picc_reqa_or_wupa(rc522, RC522_PICC_CMD_REQA, out_atqa);
+
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_picc_reqa_or_wupa(rc522, RC522_PICC_CMD_REQA, out_atqa);
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_REQA, ret);
+
+    return ret;
 }
 
 inline esp_err_t rc522_picc_wupa(const rc522_handle_t rc522, rc522_picc_atqa_desc_t *out_atqa)
@@ -278,15 +493,24 @@ inline esp_err_t rc522_picc_wupa(const rc522_handle_t rc522, rc522_picc_atqa_des
     RC522_CHECK(out_atqa == NULL);
 
     RC522_LOGD("WUPA");
-    return rc522_picc_reqa_or_wupa(rc522, RC522_PICC_CMD_WUPA, out_atqa);
+
+    RC522_STATS_BEGIN(rc522, span);
+    esp_err_t ret = rc522_picc_reqa_or_wupa(rc522, RC522_PICC_CMD_WUPA, out_atqa);
+    RC522_STATS_END(rc522, span, RC522_STATS_STAGE_REQA, ret);
+
+    return ret;
 }
 
 /**
  * Resolve collision and SELECT a PICC
+ *
+ * @param atqa ATQA received in REQA or WUPA (zeroed if ATQAs of multiple PICCs have collided)
  */
-esp_err_t rc522_picc_select(const rc522_handle_t rc522, rc522_picc_uid_t *out_uid, uint8_t *out_sak, bool skip_anticoll)
+esp_err_t rc522_picc_select(const rc522_handle_t rc522, const rc522_picc_atqa_desc_t *atqa, rc522_picc_uid_t *out_uid,
+    uint8_t *out_sak, bool skip_anticoll)
 {
     RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(atqa == NULL);
     RC522_CHECK(skip_anticoll && (out_uid == NULL || out_uid->length < RC522_PICC_UID_SIZE_MIN));
 
     bool uid_complete;
@@ -346,7 +570,7 @@ esp_err_t rc522_picc_select(const rc522_handle_t rc522, rc522_picc_uid_t *out_ui
     // Prepare MFRC522
     RC522_RETURN_ON_ERROR(rc522_pcd_clear_bits(rc522, RC522_PCD_COLL_REG, RC522_PCD_VALUES_AFTER_COLL_BIT));
 
-    isNTAGCard = (rc522->picc.atqa.source == 0x4400 ) ? true : false;
+    isNTAGCard = (atqa->source == 0x4400 ) ? true : false;
     if(isNTAGCard){
         RC522_LOGD("Card is NTAG card");
         memset(ntag_flag_buff,0,sizeof(ntag_flag_buff)); //init ntag data&flag buff
@@ -425,7 +649,7 @@ esp_err_t rc522_picc_select(const rc522_handle_t rc522, rc522_picc_uid_t *out_ui
         }
 
         uint8_t current_uid_num = 32;
-        if(rc522->picc.atqa.source == 0x4400 ){
+        if(atqa->source == 0x4400 ){
             current_uid_num = 56;
         }
         // Repeat anti collision loop until we can transmit all UID bits + BCC and receive a SAK - max 32 iterations.
@@ -444,7 +668,7 @@ esp_err_t rc522_picc_select(const rc522_handle_t rc522, rc522_picc_uid_t *out_ui
                 // Calculate CRC_A
                 rc522_pcd_crc_t crc = { 0 };
                 RC522_RETURN_ON_ERROR(
-                    rc522_pcd_calculate_crc(rc522, &(rc522_bytes_t) { .ptr = buffer, .length = 7 }, &crc));
+                    rc522_crc_calculate(rc522, &(rc522_bytes_t) { .ptr = buffer, .length = 7 }, &crc));
 
                 buffer[7] = crc.lsb;
                 buffer[8] = crc.msb;
@@ -489,12 +713,19 @@ esp_err_t rc522_picc_select(const rc522_handle_t rc522, rc522_picc_uid_t *out_ui
                 .bytes = { .ptr = buffer, .length = buffer_used },
                 .rx_align = rx_align,
                 .valid_bits = tx_last_bits,
+                .timeout_us = RC522_PICC_TIMEOUT_US_ACTIVATION,
             };
 
             rc522_picc_transaction_result_t transaction_result = {
                 .bytes = { .ptr = response_buffer, .length = response_length },
             };
+
+            RC522_STATS_BEGIN(rc522, span);
             ret = rc522_picc_transceive(rc522, &transaction, &transaction_result);
+            RC522_STATS_END(rc522,
+                span,
+                buffer[1] == 0x70 ? RC522_STATS_STAGE_SELECT : RC522_STATS_STAGE_ANTICOLLISION,
+                ret);
             if (ret == ESP_OK) {
                 response_length = transaction_result.bytes.length;
                 tx_last_bits = transaction_result.valid_bits;
@@ -622,7 +853,7 @@ esp_err_t rc522_picc_select(const rc522_handle_t rc522, rc522_picc_uid_t *out_ui
 #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
         rc522_pcd_crc_t crc = { 0 };
         RC522_RETURN_ON_ERROR(
-            rc522_pcd_calculate_crc(rc522, &(rc522_bytes_t) { .ptr = response_buffer, .length = 1 }, &crc));
+            rc522_crc_calculate(rc522, &(rc522_bytes_t) { .ptr = response_buffer, .length = 1 }, &crc));
 
         if (memcmp(response_buffer + 1, &crc, sizeof(crc)) != 0) {
             RC522_LOGD("crc wrong");
@@ -663,6 +894,30 @@ esp_err_t rc522_picc_select(const rc522_handle_t rc522, rc522_picc_uid_t *out_ui
     return ESP_OK;
 }
 
+esp_err_t rc522_picc_reselect(const rc522_handle_t rc522, const rc522_picc_t *picc)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(picc == NULL);
+
+    esp_err_t ret = ESP_OK;
+    rc522_picc_atqa_desc_t atqa;
+
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        if ((ret = rc522_picc_wupa(rc522, &atqa)) == ESP_OK) {
+            break;
+        }
+    }
+
+    RC522_RETURN_ON_ERROR_SILENTLY(ret);
+
+    rc522_picc_uid_t uid;
+    uint8_t sak;
+
+    memcpy(&uid, &picc->uid, sizeof(rc522_picc_uid_t));
+
+    return rc522_picc_select(rc522, &picc->atqa, &uid, &sak, true);
+}
+
 /**
  * Checks if PICC is still in the PCD field
  */
@@ -713,7 +968,7 @@ esp_err_t rc522_picc_heartbeat(
     memcpy(&uid, &picc->uid, sizeof(rc522_picc_uid_t));
 
     RC522_LOGD("heartbeat rc522_picc_select");
-    ret = rc522_picc_select(rc522, &uid, &sak, true);
+    ret = rc522_picc_select(rc522, &picc->atqa, &uid, &sak, true);
 
     if (ret != ESP_OK) {
         return ret;
@@ -749,26 +1004,16 @@ esp_err_t rc522_picc_uid_to_str(const rc522_picc_uid_t *uid, char *buffer, uint8
     return rc522_buffer_to_hex_str(uid->value, uid->length, buffer, buffer_size);
 }
 
-esp_err_t rc522_picc_halta(const rc522_handle_t rc522, rc522_picc_t *picc)
+static esp_err_t rc522_picc_hlta(const rc522_handle_t rc522, uint32_t timeout_us)
 {
-    RC522_CHECK(rc522 == NULL);
-    RC522_CHECK(picc == NULL);
-
     RC522_LOGD("HALTA");
 
-    uint8_t buffer[4] = { 0 };
-
-    buffer[0] = RC522_PICC_CMD_HLTA;
-    buffer[1] = 0;
-
-    rc522_pcd_crc_t crc = { 0 };
-    RC522_RETURN_ON_ERROR(rc522_pcd_calculate_crc(rc522, &(rc522_bytes_t) { .ptr = buffer, .length = 2 }, &crc));
-
-    buffer[2] = crc.lsb;
-    buffer[3] = crc.msb;
+    uint8_t buffer[2] = { RC522_PICC_CMD_HLTA, 0x00 };
 
     rc522_picc_transaction_t transaction = {
         .bytes = { .ptr = buffer, .length = sizeof(buffer) },
+        .tx_crc = true,
+        .timeout_us = timeout_us,
     };
 
     esp_err_t ret = rc522_picc_transceive(rc522, &transaction, NULL);
@@ -779,14 +1024,92 @@ esp_err_t rc522_picc_halta(const rc522_handle_t rc522, rc522_picc_t *picc)
         return RC522_ERR_HLTA_NOT_ACKED;
     }
     else if (ret == RC522_ERR_RX_TIMER_TIMEOUT || ret == RC522_ERR_RX_TIMEOUT) {
-        RC522_RETURN_ON_ERROR(rc522_picc_set_state(rc522, picc, RC522_PICC_STATE_HALT, true));
-
         return ESP_OK;
     }
 
     return ret;
 }
 
+esp_err_t rc522_picc_send_halta(const rc522_handle_t rc522)
+{
+    RC522_CHECK(rc522 == NULL);
+
+    return rc522_picc_hlta(rc522, RC522_PICC_TIMEOUT_US_ACTIVATION);
+}
+
+/**
+ * PICC answers WUPA only in IDLE or HALT state, so it is halted first. HLTA is never answered
+ * and the check does not rely on it, so the (missing) response is not waited for long.
+ */
+static esp_err_t rc522_picc_probe_wupa(const rc522_handle_t rc522)
+{
+    RC522_RETURN_ON_ERROR_SILENTLY(rc522_picc_hlta(rc522, RC522_PICC_TIMEOUT_US_PROBE_HLTA));
+
+    rc522_picc_atqa_desc_t atqa;
+
+    return rc522_picc_wupa(rc522, &atqa);
+}
+
+/**
+ * READ keeps the PICC selected. CRC_A is appended and verified by the PCD, so there are no extra bus transactions
+ */
+static esp_err_t rc522_picc_probe_read(const rc522_handle_t rc522)
+{
+    uint8_t cmd_buffer[2] = { RC522_PICC_CMD_T2T_READ, 0x00 };
+    uint8_t buffer[16];
+
+    rc522_picc_transaction_t transaction = {
+        .bytes = { .ptr = cmd_buffer, .length = sizeof(cmd_buffer) },
+        .tx_crc = true,
+        .rx_crc = true,
+        .timeout_us = RC522_PICC_TIMEOUT_US_ACTIVATION,
+    };
+
+    rc522_picc_transaction_result_t result = {
+        .bytes = { .ptr = buffer, .length = sizeof(buffer) },
+    };
+
+    RC522_RETURN_ON_ERROR_SILENTLY(rc522_picc_transceive(rc522, &transaction, &result));
+
+    // NAK is 4 bits long
+    return result.bytes.length == sizeof(buffer) ? ESP_OK : RC522_ERR_PICC_POST_HEARTBEAT_MISSMATCH;
+}
+
+esp_err_t rc522_picc_presence_check(
+    const rc522_handle_t rc522, const rc522_picc_t *picc, rc522_presence_check_mode_t mode)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(picc == NULL);
+
+    switch (mode) {
+        case RC522_PRESENCE_CHECK_READ:
+            if (picc->type == RC522_PICC_TYPE_MIFARE_UL) {
+                return rc522_picc_probe_read(rc522);
+            }
+
+            // MIFARE Classic needs authentication for READ, and a failed one deselects the PICC
+            return rc522_picc_probe_wupa(rc522);
+
+        case RC522_PRESENCE_CHECK_WUPA:
+            return rc522_picc_probe_wupa(rc522);
+
+        case RC522_PRESENCE_CHECK_SELECT:
+        default:
+            return rc522_picc_heartbeat(rc522, picc, NULL, NULL);
+    }
+}
+
+esp_err_t rc522_picc_halta(const rc522_handle_t rc522, rc522_picc_t *picc)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(picc == NULL);
+
+    RC522_RETURN_ON_ERROR_SILENTLY(rc522_picc_send_halta(rc522));
+    RC522_RETURN_ON_ERROR(rc522_picc_set_state(rc522, picc, RC522_PICC_STATE_HALT, true));
+
+    return ESP_OK;
+}
+
 esp_err_t rc522_picc_set_state(
     const rc522_handle_t rc522, rc522_picc_t *picc, rc522_picc_state_t new_state, bool fire_event)
 {
@@ -805,12 +1128,23 @@ esp_err_t rc522_picc_set_state(
 
     picc->state = new_state;
 
+#if CONFIG_RC522_NTAG_CACHE
+    if (new_state == RC522_PICC_STATE_IDLE) {
+        rc522_ntag_cache_forget(rc522, picc); // PICC has left the field or the field has been reset
+    }
+#endif
+
     if (fire_event) {
         rc522_picc_state_changed_event_t event_data = {
             .old_state = old_state,
             .picc = picc,
         };
 
+        if (picc == &rc522->picc && (new_state == RC522_PICC_STATE_ACTIVE || new_state == RC522_PICC_STATE_ACTIVE_H)) {
+            event_data.detect_result = rc522->pending_detect_result;
+            rc522->pending_detect_result = NULL;
+        }
+
         if ((ret = rc522_dispatch_event(rc522, RC522_EVENT_PICC_STATE_CHANGED, &event_data, sizeof(event_data)))
             != ESP_OK) {
             RC522_LOGW("picc_state_changed event dispatch failed (err=%04" RC522_X ")", ret);
@@ -0,0 +1,46 @@
+#include "rc522_types_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_scheduler_internal.h"
+
+RC522_LOG_DEFINE_BASE();
+
+static void rc522_scheduler_set_interval(const rc522_handle_t rc522, uint32_t interval_ms)
+{
+    if (rc522->scheduler.interval_ms != interval_ms) {
+        RC522_LOGD("scan interval %" PRIu32 " ms", interval_ms);
+    }
+
+    rc522->scheduler.interval_ms = interval_ms;
+
+#if CONFIG_RC522_STATS
+    taskENTER_CRITICAL(&rc522->stats_lock);
+    rc522->stats.scan_interval_ms = interval_ms;
+    taskEXIT_CRITICAL(&rc522->stats_lock);
+#endif
+}
+
+void rc522_scheduler_init(const rc522_handle_t rc522)
+{
+    rc522_scheduler_on_activity(rc522);
+}
+
+void rc522_scheduler_on_activity(const rc522_handle_t rc522)
+{
+    rc522->scheduler.last_activity_ms = rc522_millis();
+    rc522_scheduler_set_interval(rc522, rc522->config->scan_interval_floor_ms);
+}
+
+void rc522_scheduler_on_empty_scan(const rc522_handle_t rc522)
+{
+    if ((rc522_millis() - rc522->scheduler.last_activity_ms) < rc522->config->scan_backoff_after_ms) {
+        return;
+    }
+
+    uint32_t interval_ms = rc522->scheduler.interval_ms * 2;
+
+    if (interval_ms > rc522->config->scan_interval_ceiling_ms) {
+        interval_ms = rc522->config->scan_interval_ceiling_ms;
+    }
+
+    rc522_scheduler_set_interval(rc522, interval_ms);
+}
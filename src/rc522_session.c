@@ -0,0 +1,173 @@
+#include <string.h>
+#include "rc522_types_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_pcd_internal.h"
+#include "rc522_picc_internal.h"
+#include "rc522_session.h"
+
+RC522_LOG_DEFINE_BASE();
+
+static inline bool rc522_session_picc_is_active(const rc522_picc_t *picc)
+{
+    return picc->state == RC522_PICC_STATE_ACTIVE || picc->state == RC522_PICC_STATE_ACTIVE_H;
+}
+
+/**
+ * Active PICC has left the session: it is halted or went back into IDLE
+ */
+static void rc522_session_deactivate(rc522_session_t *session, rc522_picc_state_t new_state)
+{
+    rc522_session_entry_t *entry = &session->entries[session->active];
+
+    entry->picc.state = new_state;
+    entry->auth_sector = -1;
+    session->active = -1;
+}
+
+esp_err_t rc522_session_init(rc522_session_t *session, const rc522_picc_t *piccs, uint8_t count)
+{
+    RC522_CHECK(session == NULL);
+    RC522_CHECK(piccs == NULL && count > 0);
+    RC522_CHECK(count > RC522_SESSION_SIZE_MAX);
+
+    memset(session, 0, sizeof(rc522_session_t));
+    session->active = -1;
+
+    for (uint8_t i = 0; i < count; i++) {
+        bool active = rc522_session_picc_is_active(&piccs[i]);
+
+        RC522_CHECK(!active && piccs[i].state != RC522_PICC_STATE_HALT);
+        RC522_CHECK(active && session->active >= 0);
+
+        memcpy(&session->entries[i].picc, &piccs[i], sizeof(rc522_picc_t));
+        session->entries[i].auth_sector = -1;
+
+        if (active) {
+            session->active = i;
+        }
+    }
+
+    session->count = count;
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_session_halt(const rc522_handle_t rc522, rc522_session_t *session)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(session == NULL);
+
+    if (session->active < 0) {
+        return ESP_OK;
+    }
+
+    rc522_session_entry_t *entry = &session->entries[session->active];
+
+    // HLTA is encrypted if the PICC is authenticated, so Crypto1 is stopped after it
+    esp_err_t ret = rc522_picc_send_halta(rc522);
+
+    if (entry->auth_sector >= 0) {
+        RC522_RETURN_ON_ERROR(rc522_pcd_stop_crypto1(rc522));
+    }
+
+    RC522_RETURN_ON_ERROR_SILENTLY(ret);
+
+    rc522_session_deactivate(session, RC522_PICC_STATE_HALT);
+
+    return ESP_OK;
+}
+
+/**
+ * Wakes up all halted PICCs of the session and SELECTs the one of the entry
+ */
+static esp_err_t rc522_session_wake_up(const rc522_handle_t rc522, const rc522_session_entry_t *entry, uint8_t *out_sak)
+{
+    // ATQAs of the PICCs may collide
+    rc522_picc_atqa_desc_t atqa;
+    esp_err_t ret = rc522_picc_wupa(rc522, &atqa);
+
+    if (ret != ESP_OK && ret != RC522_ERR_COLLISION && ret != RC522_ERR_INVALID_ATQA) {
+        return ret;
+    }
+
+    // PICCs which have not been selected go back into HALT on the next command
+    rc522_picc_uid_t uid;
+    memcpy(&uid, &entry->picc.uid, sizeof(rc522_picc_uid_t));
+
+    return rc522_picc_select(rc522, &entry->picc.atqa, &uid, out_sak, true);
+}
+
+esp_err_t rc522_session_activate(
+    const rc522_handle_t rc522, rc522_session_t *session, uint8_t index, rc522_picc_t **out_picc)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(session == NULL);
+    RC522_CHECK(index >= session->count);
+
+    rc522_session_entry_t *entry = &session->entries[index];
+
+    if (session->active != index) {
+        RC522_RETURN_ON_ERROR_SILENTLY(rc522_session_halt(rc522, session));
+
+        // PICCs woken up by the previous activation stay in READY until the next plain frame,
+        // e.g. after a failed authentication. WUPA only sends them back into HALT, so it is repeated
+        esp_err_t ret = ESP_OK;
+        uint8_t sak = 0;
+
+        for (uint8_t attempt = 0; attempt < 2; attempt++) {
+            if ((ret = rc522_session_wake_up(rc522, entry, &sak)) != RC522_ERR_RX_TIMER_TIMEOUT) {
+                break;
+            }
+        }
+
+        RC522_RETURN_ON_ERROR_SILENTLY(ret);
+
+        if (sak != entry->picc.sak) {
+            RC522_LOGW("SAK has changed (%02" RC522_X " != %02" RC522_X ")", sak, entry->picc.sak);
+
+            return RC522_ERR_INVALID_SAK;
+        }
+
+        entry->picc.state = RC522_PICC_STATE_ACTIVE_H;
+        entry->auth_sector = -1;
+        session->active = index;
+    }
+
+    if (out_picc != NULL) {
+        *out_picc = &entry->picc;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t rc522_session_mifare_auth(
+    const rc522_handle_t rc522, rc522_session_t *session, uint8_t block_address, const rc522_mifare_key_t *key)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(session == NULL);
+    RC522_CHECK(key == NULL);
+    RC522_CHECK_AND_RETURN(session->active < 0, ESP_ERR_INVALID_STATE);
+
+    rc522_session_entry_t *entry = &session->entries[session->active];
+    uint8_t sector = rc522_mifare_get_sector_index_by_block_address(block_address);
+
+    if (entry->auth_sector == sector && memcmp(&entry->auth_key, key, sizeof(rc522_mifare_key_t)) == 0) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = rc522_mifare_auth(rc522, &entry->picc, block_address, key);
+
+    if (ret != ESP_OK) {
+        // PICC drops out of the ACTIVE state when the authentication fails
+        RC522_RETURN_ON_ERROR(rc522_pcd_stop_crypto1(rc522));
+        rc522_session_deactivate(session,
+            entry->picc.state == RC522_PICC_STATE_ACTIVE_H ? RC522_PICC_STATE_HALT : RC522_PICC_STATE_IDLE);
+
+        return ret;
+    }
+
+    entry->auth_sector = sector;
+    memcpy(&entry->auth_key, key, sizeof(rc522_mifare_key_t));
+
+    return ESP_OK;
+}
@@ -0,0 +1,130 @@
+#include <string.h>
+#include "rc522_types_internal.h"
+#include "rc522_helpers_internal.h"
+#include "rc522_stats_internal.h"
+#include "rc522.h"
+
+RC522_LOG_DEFINE_BASE();
+
+#if CONFIG_RC522_STATS
+
+static uint8_t rc522_stats_bucket(uint32_t duration_us)
+{
+    uint8_t bucket = 0;
+    uint32_t limit = RC522_STATS_BUCKET_0_LIMIT;
+
+    while (duration_us >= limit && bucket < RC522_STATS_BUCKET_COUNT - 1) {
+        limit <<= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+void rc522_stats_begin(const rc522_handle_t rc522, rc522_stats_span_t *span)
+{
+    span->bus_ops = rc522->stats_bus_ops;
+    span->start_us = rc522_micros();
+}
+
+void rc522_stats_end(
+    const rc522_handle_t rc522, const rc522_stats_span_t *span, rc522_stats_stage_t stage, esp_err_t ret)
+{
+    uint32_t duration_us = rc522_micros() - span->start_us;
+    uint32_t bus_ops = rc522->stats_bus_ops - span->bus_ops;
+    uint8_t bucket = rc522_stats_bucket(duration_us);
+
+    rc522_stage_stats_t *stats = &rc522->stats.stages[stage];
+
+    taskENTER_CRITICAL(&rc522->stats_lock);
+
+    stats->bus_ops += bus_ops;
+
+    if (ret != ESP_OK) {
+        stats->errors++;
+    }
+    else {
+        if (stats->count == 0 || duration_us < stats->min_us) {
+            stats->min_us = duration_us;
+        }
+
+        if (duration_us > stats->max_us) {
+            stats->max_us = duration_us;
+        }
+
+        stats->count++;
+        stats->total_us += duration_us;
+        stats->histogram[bucket]++;
+    }
+
+    taskEXIT_CRITICAL(&rc522->stats_lock);
+}
+
+#endif // CONFIG_RC522_STATS
+
+esp_err_t rc522_get_stats(const rc522_handle_t rc522, rc522_stats_t *out_stats)
+{
+    RC522_CHECK(rc522 == NULL);
+    RC522_CHECK(out_stats == NULL);
+
+#if CONFIG_RC522_STATS
+    taskENTER_CRITICAL(&rc522->stats_lock);
+    memcpy(out_stats, &rc522->stats, sizeof(rc522_stats_t));
+    taskEXIT_CRITICAL(&rc522->stats_lock);
+
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t rc522_reset_stats(const rc522_handle_t rc522)
+{
+    RC522_CHECK(rc522 == NULL);
+
+#if CONFIG_RC522_STATS
+    taskENTER_CRITICAL(&rc522->stats_lock);
+    memset(&rc522->stats, 0, sizeof(rc522_stats_t));
+    rc522->stats.scan_interval_ms = rc522->scheduler.interval_ms;
+    taskEXIT_CRITICAL(&rc522->stats_lock);
+
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+char *rc522_stats_stage_name(rc522_stats_stage_t stage)
+{
+    switch (stage) {
+        case RC522_STATS_STAGE_REQA:
+            return "REQA/WUPA";
+        case RC522_STATS_STAGE_ANTICOLLISION:
+            return "ANTICOLLISION";
+        case RC522_STATS_STAGE_SELECT:
+            return "SELECT";
+        case RC522_STATS_STAGE_ACTIVATION:
+            return "activation";
+        case RC522_STATS_STAGE_CRC:
+            return "CRC_A";
+        case RC522_STATS_STAGE_MIFARE_AUTH:
+            return "MIFARE auth";
+        case RC522_STATS_STAGE_READ:
+            return "read";
+        case RC522_STATS_STAGE_WRITE:
+            return "write";
+        case RC522_STATS_STAGE_HEARTBEAT:
+            return "heartbeat";
+        case RC522_STATS_STAGE_DISPATCH:
+            return "event dispatch";
+        case RC522_STATS_STAGE_BUS_WAIT:
+            return "bus wait";
+        case RC522_STATS_STAGE_DETECT_PLAN:
+            return "detect plan";
+        case RC522_STATS_STAGE_ISODEP:
+            return "ISO-DEP";
+        case RC522_STATS_STAGE_COUNT:
+        default:
+            return "unknown";
+    }
+}
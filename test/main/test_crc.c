@@ -0,0 +1,85 @@
+#include "unity.h"
+
+#include "rc522_crc.c"
+
+/**
+ * Bit-serial CRC_A, as described in ISO/IEC 14443-3, Annex B
+ */
+static uint16_t test_crc_a_reference(const uint8_t *data, uint8_t length)
+{
+    uint16_t crc = RC522_CRC_A_PRESET;
+
+    for (uint8_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = ((crc ^ byte) & 0x01) ? ((crc >> 1) ^ 0x8408) : (crc >> 1);
+            byte >>= 1;
+        }
+    }
+
+    return crc;
+}
+
+static void test_crc_a_assert(const uint8_t *data, uint8_t length, uint8_t expected_lsb, uint8_t expected_msb)
+{
+    rc522_pcd_crc_t crc = { 0 };
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_crc_a(&(rc522_bytes_t) { .ptr = (uint8_t *)data, .length = length }, &crc));
+    TEST_ASSERT_EQUAL_HEX8(expected_lsb, crc.lsb);
+    TEST_ASSERT_EQUAL_HEX8(expected_msb, crc.msb);
+}
+
+TEST_CASE("test_CRC_A_of_ISO_14443_3_examples", "[crc]")
+{
+    test_crc_a_assert((uint8_t[]) { 0x00, 0x00 }, 2, 0xA0, 0x1E);
+    test_crc_a_assert((uint8_t[]) { 0x12, 0x34 }, 2, 0x26, 0xCF);
+}
+
+TEST_CASE("test_CRC_A_of_PICC_commands", "[crc]")
+{
+    // HLTA
+    test_crc_a_assert((uint8_t[]) { 0x50, 0x00 }, 2, 0x57, 0xCD);
+
+    // MIFARE READ, block 0
+    test_crc_a_assert((uint8_t[]) { 0x30, 0x00 }, 2, 0x02, 0xA8);
+
+    // SELECT, cascade level 1
+    test_crc_a_assert((uint8_t[]) { 0x93, 0x70, 0x88, 0x04, 0x9C, 0x41, 0x51 }, 7, 0x6D, 0x4B);
+}
+
+TEST_CASE("test_CRC_A_of_no_bytes_is_preset_value", "[crc]")
+{
+    uint8_t buffer[1] = { 0 };
+    test_crc_a_assert(buffer, 0, 0x63, 0x63);
+}
+
+TEST_CASE("test_CRC_A_matches_bit_serial_calculation", "[crc]")
+{
+    uint8_t buffer[64];
+
+    for (uint16_t i = 0; i < 256; i++) {
+        buffer[0] = i;
+        uint16_t expected = test_crc_a_reference(buffer, 1);
+        test_crc_a_assert(buffer, 1, expected & 0xFF, expected >> 8);
+    }
+
+    for (uint8_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (i * 37) ^ 0x5A;
+    }
+
+    for (uint8_t length = 1; length <= sizeof(buffer); length++) {
+        uint16_t expected = test_crc_a_reference(buffer, length);
+        test_crc_a_assert(buffer, length, expected & 0xFF, expected >> 8);
+    }
+}
+
+TEST_CASE("test_CRC_A_invalid_args", "[crc]")
+{
+    rc522_pcd_crc_t crc = { 0 };
+    uint8_t buffer[2] = { 0 };
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rc522_crc_a(NULL, &crc));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rc522_crc_a(&(rc522_bytes_t) { .ptr = NULL, .length = 2 }, &crc));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rc522_crc_a(&(rc522_bytes_t) { .ptr = buffer, .length = 2 }, NULL));
+}
@@ -0,0 +1,64 @@
+#include "unity.h"
+
+#include "rc522_driver.c"
+
+static void test_driver_init_irq(rc522_driver_handle_t driver)
+{
+    driver->irq_semaphore = xSemaphoreCreateBinaryStatic(&driver->irq_semaphore_buffer);
+}
+
+static void test_driver_raise_irq_task(void *arg)
+{
+    rc522_driver_handle_t driver = (rc522_driver_handle_t)arg;
+
+    vTaskDelay(pdMS_TO_TICKS(10));
+    rc522_driver_raise_irq(driver);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Waiting task is woken up by the virtual IRQ", "[driver]")
+{
+    struct rc522_driver_handle driver = { .irq_io_num = GPIO_NUM_NC, .irq_enabled = true };
+    test_driver_init_irq(&driver);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_irq_arm(&driver));
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(test_driver_raise_irq_task, "raise_irq", 2048, &driver, 5, NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_irq_wait(&driver, 1000));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_irq_disarm(&driver));
+}
+
+TEST_CASE("IRQ wait times out when IRQ is not raised", "[driver]")
+{
+    struct rc522_driver_handle driver = { .irq_io_num = GPIO_NUM_NC, .irq_enabled = true };
+    test_driver_init_irq(&driver);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_irq_arm(&driver));
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, rc522_driver_irq_wait(&driver, 10));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_irq_disarm(&driver));
+}
+
+TEST_CASE("IRQ raised before arming is dropped", "[driver]")
+{
+    struct rc522_driver_handle driver = { .irq_io_num = GPIO_NUM_NC, .irq_enabled = true };
+    test_driver_init_irq(&driver);
+
+    // Nobody is waiting
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_raise_irq(&driver));
+
+    // Left over from the previous command
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_irq_arm(&driver));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_raise_irq(&driver));
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_irq_arm(&driver));
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, rc522_driver_irq_wait(&driver, 10));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_irq_disarm(&driver));
+}
+
+TEST_CASE("IRQ cannot be used when it is not enabled", "[driver]")
+{
+    struct rc522_driver_handle driver = { .irq_io_num = GPIO_NUM_NC };
+
+    TEST_ASSERT_FALSE(rc522_driver_irq_enabled(&driver));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rc522_driver_irq_arm(&driver));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rc522_driver_raise_irq(&driver));
+}
@@ -0,0 +1,1649 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "unity.h"
+#include "rc522.h"
+#include "rc522_picc.h"
+#include "rc522_session.h"
+#include "rc522_group.h"
+#include "rc522_arbiter.h"
+#include "rc522_op.h"
+#include "rc522_detect.h"
+#include "rc522_driver_internal.h"
+#include "driver/rc522_emulator.h"
+#include "picc/rc522_mifare.h"
+#include "picc/rc522_ntag.h"
+#include "picc/rc522_isodep.h"
+
+#define TEST_EMULATOR_TIMEOUT_MS (2000)
+
+#define TEST_EMULATOR_RETURN_ON_ERROR(x)                                                                               \
+    do {                                                                                                               \
+        esp_err_t err_rc_ = (x);                                                                                       \
+        if (err_rc_ != ESP_OK) {                                                                                       \
+            return err_rc_;                                                                                            \
+        }                                                                                                              \
+    }                                                                                                                  \
+    while (0)
+
+typedef esp_err_t (*test_emulator_picc_handler_t)(rc522_handle_t scanner, rc522_picc_t *picc);
+
+typedef struct
+{
+    rc522_driver_handle_t driver;
+    rc522_handle_t scanner;
+    SemaphoreHandle_t done;
+    rc522_picc_state_t wait_for_state;
+    test_emulator_picc_handler_t handler; /*<! Called from the scanner task, when the PICC becomes active */
+    rc522_picc_t picc;
+    esp_err_t handler_ret;
+    rc522_detect_result_t detect_result; /*<! Copied from the awaited event, if it carries one */
+    rc522_config_t config;               /*<! Scanner configuration, the driver is set by test_emulator_start */
+    rc522_static_t *buffers;             /*<! Optional, the scanner is created by rc522_create_static() in them */
+} test_emulator_t;
+
+static void test_emulator_on_picc_state_changed(void *arg, esp_event_base_t base, int32_t event_id, void *data)
+{
+    test_emulator_t *test = (test_emulator_t *)arg;
+    rc522_picc_state_changed_event_t *event = (rc522_picc_state_changed_event_t *)data;
+    rc522_picc_t *picc = event->picc;
+
+    if (picc->state != test->wait_for_state) {
+        return;
+    }
+
+    memcpy(&test->picc, picc, sizeof(rc522_picc_t));
+
+    if (event->detect_result != NULL) {
+        memcpy(&test->detect_result, event->detect_result, sizeof(rc522_detect_result_t));
+    }
+
+    if (picc->state == RC522_PICC_STATE_ACTIVE && test->handler) {
+        test->handler_ret = test->handler(test->scanner, picc);
+    }
+
+    xSemaphoreGive(test->done);
+}
+
+static void test_emulator_start(test_emulator_t *test, const rc522_emulator_config_t *config)
+{
+    test->done = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(test->done);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_create(config, &test->driver));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_install(test->driver));
+
+    test->config.driver = test->driver;
+
+    if (test->buffers != NULL) {
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_create_static(&test->config, test->buffers, &test->scanner));
+    }
+    else {
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_create(&test->config, &test->scanner));
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK,
+        rc522_register_events(test->scanner, RC522_EVENT_PICC_STATE_CHANGED, test_emulator_on_picc_state_changed, test));
+}
+
+static void test_emulator_wait_for_state(test_emulator_t *test, rc522_picc_state_t state)
+{
+    test->wait_for_state = state;
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_start(test->scanner));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(test->done, pdMS_TO_TICKS(TEST_EMULATOR_TIMEOUT_MS)));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(test->scanner));
+}
+
+static void test_emulator_stop(test_emulator_t *test)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_destroy(test->scanner));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_uninstall(test->driver));
+    vSemaphoreDelete(test->done);
+}
+
+static esp_err_t test_emulator_mifare_write_and_read(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    const uint8_t block_address = 4;
+    const uint8_t data[RC522_MIFARE_BLOCK_SIZE] = "emulated block 4";
+    uint8_t buffer[RC522_MIFARE_BLOCK_SIZE] = { 0 };
+
+    rc522_mifare_key_t key = {
+        .type = RC522_MIFARE_KEY_A,
+        .value = { RC522_MIFARE_KEY_VALUE_DEFAULT },
+    };
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_mifare_auth(scanner, picc, block_address, &key));
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_mifare_write(scanner, picc, block_address, data));
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_mifare_read(scanner, picc, block_address, buffer));
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_mifare_deauth(scanner, picc));
+
+    return memcmp(data, buffer, sizeof(data)) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+TEST_CASE("MIFARE Classic 1K is selected, written and read back", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_mifare_write_and_read };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_1K,
+        .uid = { 0xDE, 0xAD, 0xBE, 0xEF },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+    TEST_ASSERT_EQUAL(RC522_PICC_TYPE_MIFARE_1K, test.picc.type);
+    TEST_ASSERT_EQUAL(4, test.picc.uid.length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(picc_config.uid, test.picc.uid.value, 4);
+
+    uint8_t block[RC522_MIFARE_BLOCK_SIZE];
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_read_memory(test.driver, index, 4 * 16, block, sizeof(block)));
+    TEST_ASSERT_EQUAL_MEMORY("emulated block 4", block, sizeof(block));
+
+    test_emulator_stop(&test);
+}
+
+static esp_err_t test_emulator_mifare_wrong_key(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    rc522_mifare_key_t key = {
+        .type = RC522_MIFARE_KEY_B,
+        .value = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 },
+    };
+
+    return rc522_mifare_auth(scanner, picc, 4, &key);
+}
+
+TEST_CASE("MIFARE Classic authentication with wrong key fails", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_mifare_wrong_key };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_4K,
+        .uid = { 0x01, 0x02, 0x03, 0x04 },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(RC522_PICC_TYPE_MIFARE_4K, test.picc.type);
+    TEST_ASSERT_EQUAL(RC522_ERR_MIFARE_AUTHENTICATION_FAILED, test.handler_ret);
+
+    test_emulator_stop(&test);
+}
+
+static esp_err_t test_emulator_ntag_read(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    const uint8_t empty_ndef_message[NTAG_PAGE_SIZE] = { 0x03, 0x00, 0xFE, 0x00 };
+    uint8_t page[NTAG_PAGE_SIZE];
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_ntag_read(scanner, picc, 4, page));
+
+    return memcmp(empty_ndef_message, page, sizeof(page)) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+TEST_CASE("NTAG213 with double size UID is selected and read", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_ntag_read };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_NTAG213,
+        .uid = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 },
+        .uid_length = 7,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+    TEST_ASSERT_EQUAL(7, test.picc.uid.length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(picc_config.uid, test.picc.uid.value, 7);
+
+    test_emulator_stop(&test);
+}
+
+#define TEST_NTAG216_MEMORY_SIZE (231 * NTAG_PAGE_SIZE)
+
+/**
+ * FAST_READ test, the handler has no access to the test itself
+ */
+static struct
+{
+    rc522_driver_handle_t driver;
+    uint8_t memory[TEST_NTAG216_MEMORY_SIZE];
+    uint8_t unaligned[300]; /*<! Read from the byte 17, which is in the middle of a page */
+    uint32_t fast_read_air_time_us;
+    uint32_t read_air_time_us; /*<! Air time of reading the same memory by READ, page by page */
+} test_ntag_fast_read;
+
+static esp_err_t test_emulator_ntag_fast_read(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    uint8_t page[NTAG_PAGE_SIZE];
+    uint32_t start_us;
+    uint32_t end_us;
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_emulator_get_air_time(test_ntag_fast_read.driver, &start_us));
+    TEST_EMULATOR_RETURN_ON_ERROR(
+        rc522_ntag_readn(scanner, picc, 0, test_ntag_fast_read.memory, TEST_NTAG216_MEMORY_SIZE));
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_emulator_get_air_time(test_ntag_fast_read.driver, &end_us));
+
+    test_ntag_fast_read.fast_read_air_time_us = end_us - start_us;
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_ntag_readn(
+        scanner, picc, 17, test_ntag_fast_read.unaligned, sizeof(test_ntag_fast_read.unaligned)));
+
+    // Range beyond the end of the memory is refused by the PICC
+    if (rc522_ntag_fast_read(scanner, picc, 230, 231, page) == ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_emulator_get_air_time(test_ntag_fast_read.driver, &start_us));
+
+    for (uint8_t i = 0; i < TEST_NTAG216_MEMORY_SIZE / NTAG_PAGE_SIZE; i++) {
+        TEST_EMULATOR_RETURN_ON_ERROR(rc522_ntag_read(scanner, picc, i, page));
+    }
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_emulator_get_air_time(test_ntag_fast_read.driver, &end_us));
+
+    test_ntag_fast_read.read_air_time_us = end_us - start_us;
+
+    return ESP_OK;
+}
+
+TEST_CASE("NTAG216 memory is read with FAST_READ", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_ntag_fast_read };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_NTAG216,
+        .uid = { 0x04, 0x21, 0x60, 0x00, 0x00, 0x00, 0x01 },
+        .uid_length = 7,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    uint8_t memory[TEST_NTAG216_MEMORY_SIZE];
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_read_memory(test.driver, index, 0, memory, 16));
+
+    for (uint16_t i = 16; i < sizeof(memory); i++) {
+        memory[i] = i * 7;
+    }
+
+    TEST_ASSERT_EQUAL(
+        ESP_OK, rc522_emulator_picc_write_memory(test.driver, index, 16, memory + 16, sizeof(memory) - 16));
+
+    test_ntag_fast_read.driver = test.driver;
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(memory, test_ntag_fast_read.memory, sizeof(memory));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(memory + 17, test_ntag_fast_read.unaligned, sizeof(test_ntag_fast_read.unaligned));
+
+    printf("NTAG216 read: FAST_READ %" PRIu32 " us, READ %" PRIu32 " us\n",
+        test_ntag_fast_read.fast_read_air_time_us,
+        test_ntag_fast_read.read_air_time_us);
+
+    // 4 frames instead of 231
+    TEST_ASSERT_LESS_THAN_UINT32(test_ntag_fast_read.read_air_time_us, test_ntag_fast_read.fast_read_air_time_us * 4);
+
+    test_emulator_stop(&test);
+}
+
+#define TEST_ULTRALIGHT_MEMORY_SIZE (16 * NTAG_PAGE_SIZE)
+
+static struct
+{
+    uint8_t memory[TEST_ULTRALIGHT_MEMORY_SIZE];
+    uint8_t unaligned[50]; /*<! Read from the byte 5 */
+} test_ultralight_readn;
+
+static esp_err_t test_emulator_ultralight_readn(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    TEST_EMULATOR_RETURN_ON_ERROR(
+        rc522_ntag_readn(scanner, picc, 5, test_ultralight_readn.unaligned, sizeof(test_ultralight_readn.unaligned)));
+
+    return rc522_ntag_readn(scanner, picc, 0, test_ultralight_readn.memory, TEST_ULTRALIGHT_MEMORY_SIZE);
+}
+
+TEST_CASE("MIFARE Ultralight without FAST_READ is read with READ", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_ultralight_readn };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_UL,
+        .uid = { 0x04, 0x21, 0x40, 0x00, 0x00, 0x00, 0x03 },
+        .uid_length = 7,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    uint8_t memory[TEST_ULTRALIGHT_MEMORY_SIZE];
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_read_memory(test.driver, index, 0, memory, 16));
+
+    for (uint8_t i = 16; i < sizeof(memory); i++) {
+        memory[i] = i * 3;
+    }
+
+    TEST_ASSERT_EQUAL(
+        ESP_OK, rc522_emulator_picc_write_memory(test.driver, index, 16, memory + 16, sizeof(memory) - 16));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(memory, test_ultralight_readn.memory, sizeof(memory));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(memory + 5, test_ultralight_readn.unaligned, sizeof(test_ultralight_readn.unaligned));
+
+    test_emulator_stop(&test);
+}
+
+#if CONFIG_RC522_NTAG_CACHE
+/**
+ * Lock Control TLV, then NDEF Message TLV with a 40 byte message (bytes 23 to 62) and Terminator TLV
+ */
+#define TEST_NTAG_TLV_AREA_SIZE (5 + 2 + 40 + 1)
+
+static struct
+{
+    uint8_t tlv_area[TEST_NTAG_TLV_AREA_SIZE];
+    uint8_t page_5[NTAG_PAGE_SIZE]; /*<! Expected in the page 5 by the current handler */
+    rc522_ntag_cache_stats_t stats; /*<! Difference made by the handler */
+    ntag_tvl_info_t tlv_info;
+    uint8_t message[40];
+} test_ntag_cache;
+
+static esp_err_t test_emulator_ntag_cache_discover(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    const uint8_t page_5[NTAG_PAGE_SIZE] = { 'w', 'r', 'i', 't' };
+    rc522_ntag_cache_stats_t start;
+    uint8_t buffer[NTAG_PAGE_SIZE];
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_ntag_get_cache_stats(scanner, &start));
+    TEST_EMULATOR_RETURN_ON_ERROR(ntag_get_tlv_info(scanner, picc, &test_ntag_cache.tlv_info));
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_ntag_readn(scanner,
+        picc,
+        test_ntag_cache.tlv_info.start_addr,
+        test_ntag_cache.message,
+        sizeof(test_ntag_cache.message)));
+
+    // Written page is read from the PICC again
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_ntag_write(scanner, picc, 5, page_5));
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_ntag_readn(scanner, picc, 5 * NTAG_PAGE_SIZE, buffer, sizeof(buffer)));
+
+    if (memcmp(buffer, page_5, sizeof(buffer)) != 0) {
+        return ESP_FAIL;
+    }
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_ntag_get_cache_stats(scanner, &test_ntag_cache.stats));
+
+    test_ntag_cache.stats.hits -= start.hits;
+    test_ntag_cache.stats.misses -= start.misses;
+
+    return ESP_OK;
+}
+
+static esp_err_t test_emulator_ntag_cache_return(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    uint8_t buffer[NTAG_PAGE_SIZE];
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_ntag_readn(scanner, picc, 5 * NTAG_PAGE_SIZE, buffer, sizeof(buffer)));
+
+    return memcmp(buffer, test_ntag_cache.page_5, sizeof(buffer)) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+TEST_CASE("NTAG pages are cached until written or removed", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_ntag_cache_discover };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_NTAG213,
+        .uid = { 0x04, 0x21, 0x30, 0x00, 0x00, 0x00, 0x02 },
+        .uid_length = 7,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    uint8_t *tlv_area = test_ntag_cache.tlv_area;
+    memcpy(tlv_area, (const uint8_t[]) { 0x01, 0x03, 0xA0, 0x0C, 0x34, 0x03, 40 }, 7);
+
+    for (uint8_t i = 0; i < 40; i++) {
+        tlv_area[7 + i] = 'a' + i % 26;
+    }
+
+    tlv_area[TEST_NTAG_TLV_AREA_SIZE - 1] = 0xFE;
+
+    TEST_ASSERT_EQUAL(
+        ESP_OK, rc522_emulator_picc_write_memory(test.driver, index, 16, tlv_area, TEST_NTAG_TLV_AREA_SIZE));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+    TEST_ASSERT_EQUAL(23, test_ntag_cache.tlv_info.start_addr);
+    TEST_ASSERT_EQUAL(40, test_ntag_cache.tlv_info.blocklen);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(tlv_area + 7, test_ntag_cache.message, 40);
+
+    // Lock Control TLV needs a READ, NDEF TLV is in the same 16 bytes. Rest of the message, then the written page
+    TEST_ASSERT_EQUAL(1, test_ntag_cache.stats.hits);
+    TEST_ASSERT_EQUAL(3, test_ntag_cache.stats.misses);
+
+    // Memory changed while the PICC is away from the reader is read again
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_set_in_field(test.driver, index, false));
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_IDLE);
+
+    memcpy(test_ntag_cache.page_5, "away", NTAG_PAGE_SIZE);
+    TEST_ASSERT_EQUAL(ESP_OK,
+        rc522_emulator_picc_write_memory(
+            test.driver, index, 5 * NTAG_PAGE_SIZE, test_ntag_cache.page_5, NTAG_PAGE_SIZE));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_set_in_field(test.driver, index, true));
+
+    test.handler = test_emulator_ntag_cache_return;
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+
+    test_emulator_stop(&test);
+}
+#endif
+
+TEST_CASE("Collision of two PICCs is resolved", "[emulator]")
+{
+    test_emulator_t test = { 0 };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    // UIDs differ in the bit 24, PICC with the bit set wins
+    rc522_emulator_picc_config_t picc_configs[] = {
+        { .type = RC522_EMULATOR_PICC_MIFARE_1K, .uid = { 0x11, 0x22, 0x33, 0x44 }, .uid_length = 4 },
+        { .type = RC522_EMULATOR_PICC_MIFARE_1K, .uid = { 0x11, 0x22, 0x33, 0x45 }, .uid_length = 4 },
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_configs[0], &index));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_configs[1], &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(4, test.picc.uid.length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(picc_configs[1].uid, test.picc.uid.value, 4);
+
+    test_emulator_stop(&test);
+}
+
+TEST_CASE("PICC removal is detected by every presence check mode", "[emulator]")
+{
+    const rc522_presence_check_mode_t modes[] = {
+        RC522_PRESENCE_CHECK_SELECT,
+        RC522_PRESENCE_CHECK_WUPA,
+        RC522_PRESENCE_CHECK_READ,
+    };
+
+    const rc522_emulator_picc_config_t picc_configs[] = {
+        { .type = RC522_EMULATOR_PICC_MIFARE_1K, .uid = { 0xCA, 0xFE, 0xBA, 0xBE }, .uid_length = 4 },
+        { .type = RC522_EMULATOR_PICC_NTAG213, .uid = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 }, .uid_length = 7 },
+    };
+
+    for (uint8_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        for (uint8_t p = 0; p < sizeof(picc_configs) / sizeof(picc_configs[0]); p++) {
+            test_emulator_t test = { .config = { .presence_check = { .mode = modes[m] } } };
+            test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+            uint8_t index;
+            TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_configs[p], &index));
+
+            test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+            // PICC which stays in the field passes the checks
+            test.wait_for_state = RC522_PICC_STATE_IDLE;
+            TEST_ASSERT_EQUAL(ESP_OK, rc522_start(test.scanner));
+            TEST_ASSERT_EQUAL_MESSAGE(pdFALSE,
+                xSemaphoreTake(test.done, pdMS_TO_TICKS(300)),
+                "PICC in the field is considered removed");
+            TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(test.scanner));
+
+            TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_set_in_field(test.driver, index, false));
+            test_emulator_wait_for_state(&test, RC522_PICC_STATE_IDLE);
+
+            test_emulator_stop(&test);
+        }
+    }
+}
+
+TEST_CASE("PICC removal is detected with the virtual IRQ", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_mifare_write_and_read };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { .irq = true });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_1K,
+        .uid = { 0xCA, 0xFE, 0xBA, 0xBE },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_set_in_field(test.driver, index, false));
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_IDLE);
+
+    test_emulator_stop(&test);
+}
+
+typedef struct
+{
+    uint8_t arrived;
+    uint8_t left;
+    rc522_picc_t last_left;
+} test_emulator_inventory_t;
+
+static void test_emulator_on_inventory(void *arg, esp_event_base_t base, int32_t event_id, void *data)
+{
+    test_emulator_inventory_t *inventory = (test_emulator_inventory_t *)arg;
+    rc522_picc_inventory_event_t *event = (rc522_picc_inventory_event_t *)data;
+
+    if (event_id == RC522_EVENT_PICC_ARRIVED) {
+        inventory->arrived++;
+    }
+    else if (event_id == RC522_EVENT_PICC_LEFT) {
+        inventory->left++;
+        memcpy(&inventory->last_left, event->picc, sizeof(rc522_picc_t));
+    }
+}
+
+TEST_CASE("Inventory finds all PICCs and reports arrivals and departures", "[emulator]")
+{
+    test_emulator_t test = { 0 };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    // Different UID sizes make ATQAs collide
+    rc522_emulator_picc_config_t picc_configs[] = {
+        { .type = RC522_EMULATOR_PICC_MIFARE_1K, .uid = { 0x11, 0x22, 0x33, 0x44 }, .uid_length = 4 },
+        { .type = RC522_EMULATOR_PICC_MIFARE_1K, .uid = { 0x11, 0x22, 0x33, 0x45 }, .uid_length = 4 },
+        { .type = RC522_EMULATOR_PICC_NTAG213, .uid = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 }, .uid_length = 7 },
+    };
+
+    uint8_t indexes[3];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_configs[i], &indexes[i]));
+    }
+
+    test_emulator_inventory_t inventory = { 0 };
+    TEST_ASSERT_EQUAL(ESP_OK,
+        rc522_register_events(test.scanner, RC522_EVENT_PICC_ARRIVED, test_emulator_on_inventory, &inventory));
+    TEST_ASSERT_EQUAL(ESP_OK,
+        rc522_register_events(test.scanner, RC522_EVENT_PICC_LEFT, test_emulator_on_inventory, &inventory));
+
+    // Initialize the PCD and let the task go idle, inventory is called from this task
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_start(test.scanner));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(test.scanner));
+    vTaskDelay(pdMS_TO_TICKS(200));
+
+    rc522_picc_t piccs[RC522_INVENTORY_SIZE_MAX];
+    uint8_t count = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_inventory(test.scanner, piccs, RC522_INVENTORY_SIZE_MAX, &count));
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_EQUAL(3, inventory.arrived);
+    TEST_ASSERT_EQUAL(0, inventory.left);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        bool found = false;
+
+        for (uint8_t j = 0; j < count; j++) {
+            found |= piccs[j].uid.length == picc_configs[i].uid_length
+                     && memcmp(piccs[j].uid.value, picc_configs[i].uid, picc_configs[i].uid_length) == 0;
+        }
+
+        TEST_ASSERT_TRUE_MESSAGE(found, "PICC not found by the inventory");
+    }
+
+    // PICCs halted by the previous inventory are found again
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_inventory(test.scanner, NULL, 0, &count));
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_EQUAL(3, inventory.arrived);
+    TEST_ASSERT_EQUAL(0, inventory.left);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_set_in_field(test.driver, indexes[2], false));
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_inventory(test.scanner, NULL, 0, &count));
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL(3, inventory.arrived);
+    TEST_ASSERT_EQUAL(1, inventory.left);
+    TEST_ASSERT_EQUAL(7, inventory.last_left.uid.length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(picc_configs[2].uid, inventory.last_left.uid.value, 7);
+
+    test_emulator_stop(&test);
+}
+
+TEST_CASE("Session switches between halted PICCs by their UIDs", "[emulator]")
+{
+    test_emulator_t test = { 0 };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_configs[] = {
+        { .type = RC522_EMULATOR_PICC_MIFARE_1K, .uid = { 0xA1, 0xA2, 0xA3, 0xA4 }, .uid_length = 4 },
+        { .type = RC522_EMULATOR_PICC_MIFARE_1K, .uid = { 0xB1, 0xB2, 0xB3, 0xB4 }, .uid_length = 4 },
+        { .type = RC522_EMULATOR_PICC_NTAG213, .uid = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 }, .uid_length = 7 },
+    };
+
+    uint8_t index;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_configs[i], &index));
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_start(test.scanner));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(test.scanner));
+    vTaskDelay(pdMS_TO_TICKS(200));
+
+    rc522_picc_t piccs[RC522_INVENTORY_SIZE_MAX];
+    uint8_t count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_inventory(test.scanner, piccs, RC522_INVENTORY_SIZE_MAX, &count));
+    TEST_ASSERT_EQUAL(3, count);
+
+    rc522_session_t session;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_session_init(&session, piccs, count));
+    TEST_ASSERT_EQUAL(-1, session.active);
+
+    rc522_mifare_key_t key = {
+        .type = RC522_MIFARE_KEY_A,
+        .value = { RC522_MIFARE_KEY_VALUE_DEFAULT },
+    };
+
+    // Move the block from one MIFARE Classic to the other, switching back and forth
+    uint8_t block[RC522_MIFARE_BLOCK_SIZE];
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (session.entries[i].picc.type != RC522_PICC_TYPE_MIFARE_1K) {
+            continue;
+        }
+
+        rc522_picc_t *picc = NULL;
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_session_activate(test.scanner, &session, i, &picc));
+        TEST_ASSERT_EQUAL(i, session.active);
+        TEST_ASSERT_EQUAL(RC522_PICC_STATE_ACTIVE_H, picc->state);
+
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_session_mifare_auth(test.scanner, &session, 4, &key));
+        TEST_ASSERT_EQUAL(1, session.entries[i].auth_sector);
+
+        // Already authenticated, no transaction with the PICC
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_session_mifare_auth(test.scanner, &session, 5, &key));
+
+        if (picc->uid.value[0] == 0xA1) {
+            memcpy(block, "from the card A!", sizeof(block));
+            TEST_ASSERT_EQUAL(ESP_OK, rc522_mifare_write(test.scanner, picc, 4, block));
+        }
+
+        // Another key of the same type is not taken as authenticated
+        rc522_mifare_key_t wrong_key = key;
+        wrong_key.value[0] ^= 0xFF;
+
+        TEST_ASSERT_EQUAL(
+            RC522_ERR_MIFARE_AUTHENTICATION_FAILED, rc522_session_mifare_auth(test.scanner, &session, 4, &wrong_key));
+        TEST_ASSERT_EQUAL(-1, session.active);
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        rc522_picc_t *picc = NULL;
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_session_activate(test.scanner, &session, i, &picc));
+        TEST_ASSERT_EQUAL(-1, session.entries[i].auth_sector);
+
+        if (picc->type == RC522_PICC_TYPE_MIFARE_1K && picc->uid.value[0] == 0xA1) {
+            TEST_ASSERT_EQUAL(ESP_OK, rc522_session_mifare_auth(test.scanner, &session, 4, &key));
+            TEST_ASSERT_EQUAL(ESP_OK, rc522_mifare_read(test.scanner, picc, 4, block));
+            TEST_ASSERT_EQUAL_MEMORY("from the card A!", block, sizeof(block));
+        }
+        else if (picc->type != RC522_PICC_TYPE_MIFARE_1K) {
+            TEST_ASSERT_EQUAL(7, picc->uid.length);
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(picc_configs[2].uid, picc->uid.value, 7);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_session_halt(test.scanner, &session));
+    TEST_ASSERT_EQUAL(-1, session.active);
+
+    test_emulator_stop(&test);
+}
+
+TEST_CASE("Group task polls several scanners", "[emulator]")
+{
+    rc522_group_handle_t group;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_group_create(&(rc522_group_config_t) { 0 }, &group));
+
+    test_emulator_t tests[3] = { 0 };
+
+    for (uint8_t i = 0; i < 3; i++) {
+        tests[i].config.group = group;
+        tests[i].config.group_weight = i + 1;
+        test_emulator_start(&tests[i], &(rc522_emulator_config_t) { 0 });
+
+        rc522_emulator_picc_config_t picc_config = {
+            .type = RC522_EMULATOR_PICC_MIFARE_1K,
+            .uid = { 0x10, 0x20, 0x30, i },
+            .uid_length = 4,
+        };
+
+        uint8_t index;
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(tests[i].driver, &picc_config, &index));
+
+        tests[i].wait_for_state = RC522_PICC_STATE_ACTIVE;
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_start(tests[i].scanner));
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(tests[i].done, pdMS_TO_TICKS(TEST_EMULATOR_TIMEOUT_MS)));
+        TEST_ASSERT_EQUAL(i, tests[i].picc.uid.value[3]);
+    }
+
+    // Group cannot be destroyed while it has scanners
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, rc522_group_destroy(group));
+
+    for (uint8_t i = 0; i < 3; i++) {
+        test_emulator_stop(&tests[i]);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_group_destroy(group));
+}
+
+TEST_CASE("Scanners sharing an arbiter take turns on the bus", "[emulator]")
+{
+    rc522_arbiter_handle_t arbiter;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_arbiter_create(&arbiter));
+
+    test_emulator_t tests[2] = { 0 };
+
+    for (uint8_t i = 0; i < 2; i++) {
+        tests[i].config.arbiter = arbiter;
+        tests[i].handler = test_emulator_mifare_write_and_read;
+        test_emulator_start(&tests[i], &(rc522_emulator_config_t) { 0 });
+
+        rc522_emulator_picc_config_t picc_config = {
+            .type = RC522_EMULATOR_PICC_MIFARE_1K,
+            .uid = { 0x40, 0x50, 0x60, i },
+            .uid_length = 4,
+        };
+
+        uint8_t index;
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(tests[i].driver, &picc_config, &index));
+
+        tests[i].wait_for_state = RC522_PICC_STATE_ACTIVE;
+    }
+
+    // Both scanners poll from their own tasks at the same time
+    for (uint8_t i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_start(tests[i].scanner));
+    }
+
+    for (uint8_t i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(tests[i].done, pdMS_TO_TICKS(TEST_EMULATOR_TIMEOUT_MS)));
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(tests[i].scanner));
+        TEST_ASSERT_EQUAL(ESP_OK, tests[i].handler_ret);
+        TEST_ASSERT_EQUAL(i, tests[i].picc.uid.value[3]);
+
+#if CONFIG_RC522_STATS
+        rc522_stats_t stats;
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_get_stats(tests[i].scanner, &stats));
+
+        // Every PICC transaction has waited for the bus, even if the bus was free
+        TEST_ASSERT_GREATER_OR_EQUAL(stats.stages[RC522_STATS_STAGE_READ].count,
+            stats.stages[RC522_STATS_STAGE_BUS_WAIT].count);
+        TEST_ASSERT_EQUAL(0, stats.stages[RC522_STATS_STAGE_BUS_WAIT].errors);
+#endif
+    }
+
+    // Arbiter cannot be destroyed while it has scanners
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, rc522_arbiter_destroy(arbiter));
+
+    for (uint8_t i = 0; i < 2; i++) {
+        test_emulator_stop(&tests[i]);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_arbiter_destroy(arbiter));
+}
+
+typedef struct
+{
+    SemaphoreHandle_t release; /*<! Handler of the first READY event blocks until it is given */
+    bool blocked;
+    rc522_picc_state_t snapshot_state; /*<! State of the PICC in the blocked event, read after the block */
+} test_dispatcher_t;
+
+static void test_dispatcher_on_picc_state_changed(void *arg, esp_event_base_t base, int32_t event_id, void *data)
+{
+    test_dispatcher_t *test = (test_dispatcher_t *)arg;
+    rc522_picc_state_changed_event_t *event = (rc522_picc_state_changed_event_t *)data;
+
+    if (event->picc->state != RC522_PICC_STATE_READY || test->blocked) {
+        return;
+    }
+
+    test->blocked = true;
+    xSemaphoreTake(test->release, portMAX_DELAY);
+    test->snapshot_state = event->picc->state;
+}
+
+TEST_CASE("Dispatcher runs slow handlers without stalling the polling", "[emulator]")
+{
+    test_emulator_t test = { .config = { .dispatcher = { .enabled = true } } };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    test_dispatcher_t dispatcher = { .release = xSemaphoreCreateBinary() };
+    TEST_ASSERT_NOT_NULL(dispatcher.release);
+    TEST_ASSERT_EQUAL(ESP_OK,
+        rc522_register_events(test.scanner,
+            RC522_EVENT_PICC_STATE_CHANGED,
+            test_dispatcher_on_picc_state_changed,
+            &dispatcher));
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_1K,
+        .uid = { 0x70, 0x71, 0x72, 0x73 },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_start(test.scanner));
+
+    // While the handler is blocked, the scanner keeps polling and fires more events
+    // (IDLE, READY and ACTIVE per cycle) than the ring can hold. Slot of the blocked event is not free yet
+    for (uint8_t i = 0; i < RC522_DISPATCHER_RING_SIZE / 2 + 2; i++) {
+        vTaskDelay(pdMS_TO_TICKS(300));
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_set_in_field(test.driver, index, (i % 2) == 1));
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(300));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(test.scanner));
+    TEST_ASSERT_TRUE(dispatcher.blocked);
+
+    rc522_dispatcher_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_get_dispatcher_stats(test.scanner, &stats));
+    TEST_ASSERT_EQUAL(RC522_DISPATCHER_RING_SIZE, stats.high_water);
+    TEST_ASSERT_GREATER_THAN(0, stats.dropped);
+    TEST_ASSERT_EQUAL(1, stats.overflows);
+
+    xSemaphoreGive(dispatcher.release);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    // Live PICC has become ACTIVE long ago, the event carries the state it was fired with
+    TEST_ASSERT_EQUAL(RC522_PICC_STATE_READY, dispatcher.snapshot_state);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_get_dispatcher_stats(test.scanner, &stats));
+    TEST_ASSERT_EQUAL(RC522_DISPATCHER_RING_SIZE, stats.dispatched);
+
+    test_emulator_stop(&test);
+    vSemaphoreDelete(dispatcher.release);
+}
+
+typedef struct
+{
+    rc522_driver_handle_t driver; /*<! Not used by the scanner, so nothing raises its IRQ */
+    bool waited;
+    esp_err_t wait_ret;
+    rc522_picc_state_t last_state; /*<! State of the last dispatched event */
+} test_dispatcher_irq_t;
+
+static void test_dispatcher_irq_on_picc_state_changed(void *arg, esp_event_base_t base, int32_t event_id, void *data)
+{
+    test_dispatcher_irq_t *test = (test_dispatcher_irq_t *)arg;
+    rc522_picc_state_changed_event_t *event = (rc522_picc_state_changed_event_t *)data;
+
+    test->last_state = event->picc->state;
+
+    if (event->picc->state != RC522_PICC_STATE_READY || test->waited) {
+        return;
+    }
+
+    // Events pushed by the polling task in the meantime must not end the wait
+    test->waited = true;
+    test->wait_ret = rc522_driver_irq_arm(test->driver);
+
+    if (test->wait_ret == ESP_OK) {
+        test->wait_ret = rc522_driver_irq_wait(test->driver, 1000);
+    }
+
+    rc522_driver_irq_disarm(test->driver);
+}
+
+TEST_CASE("IRQ wait in the dispatcher task is not woken up by dispatched events", "[emulator]")
+{
+    test_emulator_t test = { .config = { .dispatcher = { .enabled = true } } };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    test_dispatcher_irq_t dispatcher = { 0 };
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_create(&(rc522_emulator_config_t) { .irq = true }, &dispatcher.driver));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_install(dispatcher.driver));
+    TEST_ASSERT_EQUAL(ESP_OK,
+        rc522_register_events(test.scanner,
+            RC522_EVENT_PICC_STATE_CHANGED,
+            test_dispatcher_irq_on_picc_state_changed,
+            &dispatcher));
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_1K,
+        .uid = { 0x74, 0x75, 0x76, 0x77 },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_start(test.scanner));
+
+    // PICC leaves and returns while the handler waits
+    for (uint8_t i = 0; i < 4; i++) {
+        vTaskDelay(pdMS_TO_TICKS(150));
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_set_in_field(test.driver, index, (i % 2) == 1));
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_set_in_field(test.driver, index, false));
+    vTaskDelay(pdMS_TO_TICKS(1500));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(test.scanner));
+
+    TEST_ASSERT_TRUE(dispatcher.waited);
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, dispatcher.wait_ret);
+
+    // Events queued during the wait have been dispatched afterwards
+    TEST_ASSERT_EQUAL(RC522_PICC_STATE_IDLE, dispatcher.last_state);
+
+    test_emulator_stop(&test);
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_uninstall(dispatcher.driver));
+}
+
+static void test_op_on_completed(rc522_op_t *op, void *arg)
+{
+    // Callback runs after rc522_op_wait() may have returned, so only the semaphore is touched
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+static void test_op_on_completed_free(rc522_op_t *op, void *arg)
+{
+    // Op is back with the caller and is not touched by the scanner anymore
+    uint8_t *buffer = op->buffer;
+    bool read = op->result == ESP_OK && buffer[0] == 0x0A;
+
+    free(buffer);
+    free(op);
+
+    if (read) {
+        xSemaphoreGive((SemaphoreHandle_t)arg);
+    }
+}
+
+TEST_CASE("Submitted operations run on the active PICC and are cancelled when it leaves", "[emulator]")
+{
+    test_emulator_t test = { 0 };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_1K,
+        .uid = { 0x0A, 0x0B, 0x0C, 0x0D },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_start(test.scanner));
+
+    const rc522_mifare_key_t key = {
+        .type = RC522_MIFARE_KEY_A,
+        .value = { RC522_MIFARE_KEY_VALUE_DEFAULT },
+    };
+
+    uint8_t data[3 * RC522_MIFARE_BLOCK_SIZE];
+    uint8_t sector_1[3 * RC522_MIFARE_BLOCK_SIZE] = { 0 };
+    uint8_t sector_2[2 * RC522_MIFARE_BLOCK_SIZE] = { 0 };
+    SemaphoreHandle_t completed = xSemaphoreCreateCounting(4, 0);
+
+    for (uint8_t i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+
+    // Submitted from this task, while the scanner keeps polling
+    rc522_op_t ops[] = {
+        { .type = RC522_OP_MIFARE_WRITE, .address = 4, .count = 3, .buffer = data, .key = key },
+        { .type = RC522_OP_MIFARE_READ, .address = 4, .count = 3, .buffer = sector_1, .key = key },
+        { .type = RC522_OP_MIFARE_READ, .address = 8, .count = 2, .buffer = sector_2, .key = key },
+        { .type = RC522_OP_MIFARE_READ, .address = 8, .count = 1, .buffer = sector_2, .key = key },
+    };
+
+    // Last op is meant for another PICC
+    ops[3].uid.length = 7;
+
+    for (uint8_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        ops[i].callback = test_op_on_completed;
+        ops[i].callback_arg = completed;
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_op_submit(test.scanner, &ops[i]));
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_op_wait(&ops[0], TEST_EMULATOR_TIMEOUT_MS));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_op_wait(&ops[1], TEST_EMULATOR_TIMEOUT_MS));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_op_wait(&ops[2], TEST_EMULATOR_TIMEOUT_MS));
+    TEST_ASSERT_EQUAL(RC522_ERR_OP_CANCELLED, rc522_op_wait(&ops[3], TEST_EMULATOR_TIMEOUT_MS));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, sector_1, sizeof(data));
+
+    for (uint8_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(completed, pdMS_TO_TICKS(TEST_EMULATOR_TIMEOUT_MS)));
+    }
+
+    // Op released by its own callback, block 0 starts with the UID
+    rc522_op_t *heap_op = calloc(1, sizeof(rc522_op_t));
+    TEST_ASSERT_NOT_NULL(heap_op);
+    heap_op->type = RC522_OP_MIFARE_READ;
+    heap_op->address = 0;
+    heap_op->count = 1;
+    heap_op->buffer = calloc(1, RC522_MIFARE_BLOCK_SIZE);
+    heap_op->key = key;
+    heap_op->callback = test_op_on_completed_free;
+    heap_op->callback_arg = completed;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_op_submit(test.scanner, heap_op));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(completed, pdMS_TO_TICKS(TEST_EMULATOR_TIMEOUT_MS)));
+
+    // PICC has left, ops which have not run yet are cancelled
+    test.wait_for_state = RC522_PICC_STATE_IDLE;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_set_in_field(test.driver, index, false));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(test.done, pdMS_TO_TICKS(TEST_EMULATOR_TIMEOUT_MS)));
+
+    rc522_op_t op = { .type = RC522_OP_MIFARE_READ, .address = 4, .count = 1, .buffer = sector_1, .key = key };
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_op_submit(test.scanner, &op));
+    TEST_ASSERT_EQUAL(RC522_ERR_OP_CANCELLED, rc522_op_wait(&op, TEST_EMULATOR_TIMEOUT_MS));
+
+    test_emulator_stop(&test);
+    vSemaphoreDelete(completed);
+}
+
+TEST_CASE("Submitted operations run after presence checks that do not select the PICC", "[emulator]")
+{
+    const rc522_presence_check_mode_t modes[] = { RC522_PRESENCE_CHECK_WUPA, RC522_PRESENCE_CHECK_READ };
+
+    for (uint8_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        test_emulator_t test = { .config = { .presence_check = { .mode = modes[m] } } };
+        test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+        rc522_emulator_picc_config_t picc_config = {
+            .type = RC522_EMULATOR_PICC_MIFARE_1K,
+            .uid = { 0x0A, 0x0B, 0x0C, 0x0E },
+            .uid_length = 4,
+        };
+
+        uint8_t index;
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+        test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_start(test.scanner));
+
+        const rc522_mifare_key_t key = {
+            .type = RC522_MIFARE_KEY_A,
+            .value = { RC522_MIFARE_KEY_VALUE_DEFAULT },
+        };
+
+        uint8_t data[RC522_MIFARE_BLOCK_SIZE] = "op after probe  ";
+        uint8_t block[RC522_MIFARE_BLOCK_SIZE] = { 0 };
+
+        // Each op waits for its own presence check, which leaves the PICC in READY
+        rc522_op_t write = { .type = RC522_OP_MIFARE_WRITE, .address = 5, .count = 1, .buffer = data, .key = key };
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_op_submit(test.scanner, &write));
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_op_wait(&write, TEST_EMULATOR_TIMEOUT_MS));
+
+        rc522_op_t read = { .type = RC522_OP_MIFARE_READ, .address = 5, .count = 1, .buffer = block, .key = key };
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_op_submit(test.scanner, &read));
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_op_wait(&read, TEST_EMULATOR_TIMEOUT_MS));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(data, block, sizeof(data));
+
+        test_emulator_stop(&test);
+    }
+}
+
+#define TEST_STATIC_TASK_STACK_SIZE (4 * 1024)
+
+TEST_CASE("Scanner created in static storage activates PICC", "[emulator]")
+{
+    static rc522_static_t buffers;
+    static StackType_t stack[TEST_STATIC_TASK_STACK_SIZE];
+
+    buffers.task_stack = stack;
+
+    test_emulator_t test = {
+        .handler = test_emulator_mifare_write_and_read,
+        .config = { .task_stack_size = TEST_STATIC_TASK_STACK_SIZE },
+        .buffers = &buffers,
+    };
+
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_1K,
+        .uid = { 0x20, 0x21, 0x22, 0x23 },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(picc_config.uid, test.picc.uid.value, 4);
+    TEST_ASSERT_EQUAL_PTR(buffers.handle, test.scanner);
+
+    test_emulator_stop(&test);
+
+    // Stack size is needed to size the stack, dispatcher would need heap
+    rc522_config_t config = { .driver = test.driver };
+    rc522_handle_t scanner = NULL;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rc522_create_static(&config, &buffers, &scanner));
+
+    config.task_stack_size = TEST_STATIC_TASK_STACK_SIZE;
+    config.dispatcher.enabled = true;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, rc522_create_static(&config, &buffers, &scanner));
+    TEST_ASSERT_NULL(scanner);
+}
+
+TEST_CASE("Detect plan reads MIFARE Classic blocks before the event", "[emulator]")
+{
+    const rc522_mifare_key_t key = {
+        .type = RC522_MIFARE_KEY_A,
+        .value = { RC522_MIFARE_KEY_VALUE_DEFAULT },
+    };
+
+    const rc522_detect_step_t mifare_steps[] = {
+        { .type = RC522_DETECT_STEP_MIFARE_AUTH, .address = 4, .key = &key },
+        { .type = RC522_DETECT_STEP_MIFARE_READ, .address = 4, .count = 3 },
+    };
+
+    const rc522_detect_step_t ntag_steps[] = {
+        { .type = RC522_DETECT_STEP_NTAG_READ, .address = 4, .count = 4 },
+    };
+
+    const rc522_detect_plan_t plans[] = {
+        { .picc_type = RC522_PICC_TYPE_MIFARE_UL, .steps = ntag_steps, .step_count = 1 },
+        { .picc_type = RC522_PICC_TYPE_MIFARE_1K, .steps = mifare_steps, .step_count = 2 },
+    };
+
+    // Handler uses the PICC after the plan, so it has to be selected again
+    test_emulator_t test = {
+        .handler = test_emulator_mifare_write_and_read,
+        .config = { .detect_plans = plans, .detect_plan_count = 2 },
+    };
+
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_1K,
+        .uid = { 0x19, 0x29, 0x39, 0x49 },
+        .uid_length = 4,
+    };
+
+    uint8_t data[3 * RC522_MIFARE_BLOCK_SIZE];
+
+    for (uint8_t i = 0; i < sizeof(data); i++) {
+        data[i] = 0xA0 ^ i;
+    }
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+    TEST_ASSERT_EQUAL(ESP_OK,
+        rc522_emulator_picc_write_memory(test.driver, index, 4 * RC522_MIFARE_BLOCK_SIZE, data, sizeof(data)));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.detect_result.ret);
+    TEST_ASSERT_EQUAL(2, test.detect_result.steps_done);
+    TEST_ASSERT_EQUAL(sizeof(data), test.detect_result.length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, test.detect_result.data, sizeof(data));
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+
+    test_emulator_stop(&test);
+
+    // Plan which reads more than the result can hold is rejected
+    const uint8_t page_count = (RC522_DETECT_DATA_SIZE_MAX / NTAG_PAGE_SIZE) + 1;
+    const rc522_detect_step_t long_steps[] = {
+        { .type = RC522_DETECT_STEP_NTAG_READ, .address = 0, .count = page_count },
+    };
+
+    const rc522_detect_plan_t long_plan = {
+        .picc_type = RC522_PICC_TYPE_MIFARE_UL,
+        .steps = long_steps,
+        .step_count = 1,
+    };
+
+    rc522_config_t config = { .detect_plans = &long_plan, .detect_plan_count = 1 };
+    rc522_handle_t scanner = NULL;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rc522_create(&config, &scanner));
+    TEST_ASSERT_NULL(scanner);
+}
+
+#define TEST_ISODEP_DATA_SIZE (255) // Longer than the largest frame
+
+static esp_err_t test_emulator_isodep_exchange(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    rc522_isodep_t isodep;
+    uint8_t update[5 + TEST_ISODEP_DATA_SIZE] = { 0x00, 0xD6, 0x00, 0x10, TEST_ISODEP_DATA_SIZE };
+    const uint8_t read[] = { 0x00, 0xB0, 0x00, 0x10, TEST_ISODEP_DATA_SIZE };
+    uint8_t response[TEST_ISODEP_DATA_SIZE + 2];
+    uint8_t short_buffer[8];
+    size_t length = 0;
+
+    for (uint16_t i = 0; i < TEST_ISODEP_DATA_SIZE; i++) {
+        update[5 + i] = i;
+    }
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_isodep_activate(scanner, picc, &isodep));
+
+    if (isodep.ats.fsc != 256 || isodep.ats.fwi != 8 || !isodep.ats.cid_supported
+        || isodep.ats.historical_bytes_length != 1 || isodep.ats.historical_bytes[0] != 0x80) {
+        return ESP_FAIL;
+    }
+
+    TEST_EMULATOR_RETURN_ON_ERROR(
+        rc522_isodep_pps(scanner, &isodep, RC522_ISODEP_BITRATE_106, RC522_ISODEP_BITRATE_106));
+
+    // Command is chained by the PCD, the PICC asks for a waiting time extension
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_isodep_transceive_apdu(
+        scanner, &isodep, update, sizeof(update), response, sizeof(response), &length));
+
+    if (length != 2 || response[0] != 0x90 || response[1] != 0x00) {
+        return ESP_FAIL;
+    }
+
+    // Response does not fit into the buffer, but the session stays usable
+    if (rc522_isodep_transceive_apdu(
+            scanner, &isodep, read, sizeof(read), short_buffer, sizeof(short_buffer), &length)
+        != RC522_ERR_ISODEP_RESPONSE_TOO_LONG) {
+        return ESP_FAIL;
+    }
+
+    // Response is chained by the PICC
+    TEST_EMULATOR_RETURN_ON_ERROR(
+        rc522_isodep_transceive_apdu(scanner, &isodep, read, sizeof(read), response, sizeof(response), &length));
+
+    if (length != sizeof(response) || memcmp(response, update + 5, TEST_ISODEP_DATA_SIZE) != 0
+        || response[TEST_ISODEP_DATA_SIZE] != 0x90) {
+        return ESP_FAIL;
+    }
+
+    return rc522_isodep_deselect(scanner, &isodep);
+}
+
+TEST_CASE("ISO-DEP APDUs are chained in both directions", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_isodep_exchange };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_ISO_14443_4,
+        .uid = { 0x08, 0x14, 0x44, 0x43 },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(RC522_PICC_TYPE_ISO_14443_4, test.picc.type);
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+
+    uint8_t file[TEST_ISODEP_DATA_SIZE];
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_read_memory(test.driver, index, 0x10, file, sizeof(file)));
+
+    for (uint16_t i = 0; i < TEST_ISODEP_DATA_SIZE; i++) {
+        TEST_ASSERT_EQUAL_HEX8(i, file[i]);
+    }
+
+    test_emulator_stop(&test);
+}
+
+#define TEST_ISODEP_FRAME_DATA_SIZE (240) // Longer than the FIFO, shorter than the largest frame
+
+static esp_err_t test_emulator_isodep_stream(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    rc522_isodep_t isodep;
+    uint8_t update[5 + TEST_ISODEP_FRAME_DATA_SIZE] = { 0x00, 0xD6, 0x00, 0x20, TEST_ISODEP_FRAME_DATA_SIZE };
+    const uint8_t read[] = { 0x00, 0xB0, 0x00, 0x20, TEST_ISODEP_FRAME_DATA_SIZE };
+    uint8_t response[TEST_ISODEP_FRAME_DATA_SIZE + 2];
+    size_t length = 0;
+
+    for (uint16_t i = 0; i < TEST_ISODEP_FRAME_DATA_SIZE; i++) {
+        update[5 + i] = 0xFF - i;
+    }
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_isodep_activate(scanner, picc, &isodep));
+
+    if (isodep.frame_size != RC522_ISODEP_FRAME_SIZE_MAX) {
+        return ESP_FAIL;
+    }
+
+    // Both APDUs fit into one frame, which is streamed through the FIFO
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_isodep_transceive_apdu(
+        scanner, &isodep, update, sizeof(update), response, sizeof(response), &length));
+
+    if (length != 2 || response[0] != 0x90) {
+        return ESP_FAIL;
+    }
+
+    TEST_EMULATOR_RETURN_ON_ERROR(
+        rc522_isodep_transceive_apdu(scanner, &isodep, read, sizeof(read), response, sizeof(response), &length));
+
+    if (length != sizeof(response) || memcmp(response, update + 5, TEST_ISODEP_FRAME_DATA_SIZE) != 0
+        || response[TEST_ISODEP_FRAME_DATA_SIZE] != 0x90) {
+        return ESP_FAIL;
+    }
+
+    return rc522_isodep_deselect(scanner, &isodep);
+}
+
+TEST_CASE("ISO-DEP frames longer than the FIFO are streamed", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_isodep_stream };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { .irq = true });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_ISO_14443_4,
+        .uid = { 0x08, 0x14, 0x44, 0x44 },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+
+    uint8_t file[TEST_ISODEP_FRAME_DATA_SIZE];
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_read_memory(test.driver, index, 0x20, file, sizeof(file)));
+
+    for (uint16_t i = 0; i < TEST_ISODEP_FRAME_DATA_SIZE; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0xFF - i, file[i]);
+    }
+
+    test_emulator_stop(&test);
+}
+
+static esp_err_t test_emulator_isodep_long_wtx(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    rc522_isodep_t isodep;
+    const uint8_t update[] = { 0x00, 0xD6, 0x00, 0x00, 0x04, 0xCA, 0xFE, 0xBA, 0xBE };
+    uint8_t response[2];
+    size_t length = 0;
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_isodep_activate(scanner, picc, &isodep));
+
+    // Response comes after 58 FWTs (4.5 s), far beyond the 1.6 s of the timer at its default resolution
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_isodep_transceive_apdu(
+        scanner, &isodep, update, sizeof(update), response, sizeof(response), &length));
+
+    if (length != 2 || response[0] != 0x90 || response[1] != 0x00) {
+        return ESP_FAIL;
+    }
+
+    return rc522_isodep_deselect(scanner, &isodep);
+}
+
+TEST_CASE("ISO-DEP response is awaited for the whole extended waiting time", "[emulator]")
+{
+    test_emulator_t test = { .handler = test_emulator_isodep_long_wtx };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_ISO_14443_4,
+        .uid = { 0x08, 0x14, 0x44, 0x45 },
+        .uid_length = 4,
+        .wtxm = 59,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+
+    uint32_t air_time_us = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_get_air_time(test.driver, &air_time_us));
+    TEST_ASSERT_GREATER_THAN_UINT32(4400000, air_time_us);
+
+    test_emulator_stop(&test);
+}
+
+#define TEST_ISODEP_FILE_SIZE (2048)
+
+/**
+ * Bit rate test, the handler has no access to the test itself
+ */
+static struct
+{
+    rc522_driver_handle_t driver;
+    rc522_isodep_bitrate_t max_bitrate;
+    rc522_isodep_bitrate_t dsi; /*<! Negotiated bit rates, the session is back at 106 kbit/s after DESELECT */
+    rc522_isodep_bitrate_t dri;
+    uint32_t air_time_us;       /*<! Air time of reading the file */
+    uint8_t file[TEST_ISODEP_FILE_SIZE];
+} test_isodep_bitrate;
+
+static esp_err_t test_emulator_isodep_read_file(rc522_handle_t scanner, rc522_picc_t *picc)
+{
+    rc522_isodep_t isodep;
+    uint8_t response[256 + 2];
+    size_t length = 0;
+    uint32_t start_us;
+    uint32_t end_us;
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_isodep_activate(scanner, picc, &isodep));
+    TEST_EMULATOR_RETURN_ON_ERROR(
+        rc522_isodep_negotiate_bitrate(scanner, picc, &isodep, test_isodep_bitrate.max_bitrate));
+
+    test_isodep_bitrate.dsi = isodep.dsi;
+    test_isodep_bitrate.dri = isodep.dri;
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_emulator_get_air_time(test_isodep_bitrate.driver, &start_us));
+
+    // READ BINARY with Le of 256 bytes
+    for (uint16_t offset = 0; offset < TEST_ISODEP_FILE_SIZE; offset += 256) {
+        const uint8_t read[] = { 0x00, 0xB0, offset >> 8, offset & 0xFF, 0x00 };
+
+        TEST_EMULATOR_RETURN_ON_ERROR(
+            rc522_isodep_transceive_apdu(scanner, &isodep, read, sizeof(read), response, sizeof(response), &length));
+
+        if (length != sizeof(response) || response[256] != 0x90) {
+            return ESP_FAIL;
+        }
+
+        memcpy(test_isodep_bitrate.file + offset, response, 256);
+    }
+
+    TEST_EMULATOR_RETURN_ON_ERROR(rc522_emulator_get_air_time(test_isodep_bitrate.driver, &end_us));
+    test_isodep_bitrate.air_time_us = end_us - start_us;
+
+    return rc522_isodep_deselect(scanner, &isodep);
+}
+
+/**
+ * Reads the file of the ISO/IEC 14443-4 PICC at the negotiated bit rates
+ */
+static void test_emulator_isodep_read_at(rc522_isodep_bitrate_t max_bitrate, uint16_t picc_max_bitrate_kbps)
+{
+    test_emulator_t test = { .handler = test_emulator_isodep_read_file };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_ISO_14443_4,
+        .uid = { 0x08, 0x14, 0x44, 0x43 },
+        .uid_length = 4,
+        .max_bitrate_kbps = picc_max_bitrate_kbps,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    uint8_t file[TEST_ISODEP_FILE_SIZE];
+
+    for (uint16_t i = 0; i < TEST_ISODEP_FILE_SIZE; i++) {
+        file[i] = i * 7;
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_write_memory(test.driver, index, 0, file, sizeof(file)));
+
+    memset(&test_isodep_bitrate, 0, sizeof(test_isodep_bitrate));
+    test_isodep_bitrate.driver = test.driver;
+    test_isodep_bitrate.max_bitrate = max_bitrate;
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(file, test_isodep_bitrate.file, sizeof(file));
+
+    test_emulator_stop(&test);
+}
+
+TEST_CASE("ISO-DEP bit rate is raised to 848 kbit/s and speeds up reading", "[emulator]")
+{
+    test_emulator_isodep_read_at(RC522_ISODEP_BITRATE_106, 0);
+    uint32_t slow_us = test_isodep_bitrate.air_time_us;
+
+    TEST_ASSERT_EQUAL(RC522_ISODEP_BITRATE_106, test_isodep_bitrate.dsi);
+    TEST_ASSERT_EQUAL(RC522_ISODEP_BITRATE_106, test_isodep_bitrate.dri);
+
+    test_emulator_isodep_read_at(RC522_ISODEP_BITRATE_848, 0);
+    uint32_t fast_us = test_isodep_bitrate.air_time_us;
+
+    TEST_ASSERT_EQUAL(RC522_ISODEP_BITRATE_848, test_isodep_bitrate.dsi);
+    TEST_ASSERT_EQUAL(RC522_ISODEP_BITRATE_848, test_isodep_bitrate.dri);
+
+    printf("Read of %d bytes: %" PRIu32 " us at 106 kbit/s, %" PRIu32 " us at 848 kbit/s\n",
+        TEST_ISODEP_FILE_SIZE,
+        slow_us,
+        fast_us);
+
+    // Frame delay times and frames of the PCD do not shrink as much as the data
+    TEST_ASSERT_LESS_THAN_UINT32(slow_us, fast_us * 4);
+}
+
+TEST_CASE("ISO-DEP bit rate falls back when frames are lost", "[emulator]")
+{
+    test_emulator_isodep_read_at(RC522_ISODEP_BITRATE_848, 212);
+
+    TEST_ASSERT_EQUAL(RC522_ISODEP_BITRATE_212, test_isodep_bitrate.dsi);
+    TEST_ASSERT_EQUAL(RC522_ISODEP_BITRATE_212, test_isodep_bitrate.dri);
+}
+
+#if CONFIG_RC522_STATS
+TEST_CASE("Latency of protocol stages is collected", "[emulator][stats]")
+{
+    test_emulator_t test = { .handler = test_emulator_mifare_write_and_read };
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_1K,
+        .uid = { 0x12, 0x34, 0x56, 0x78 },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+    TEST_ASSERT_EQUAL(ESP_OK, test.handler_ret);
+
+    rc522_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_get_stats(test.scanner, &stats));
+
+    TEST_ASSERT_GREATER_OR_EQUAL(1, stats.stages[RC522_STATS_STAGE_REQA].count);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, stats.stages[RC522_STATS_STAGE_ANTICOLLISION].count);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, stats.stages[RC522_STATS_STAGE_SELECT].count);
+    TEST_ASSERT_EQUAL(1, stats.stages[RC522_STATS_STAGE_ACTIVATION].count);
+    TEST_ASSERT_EQUAL(1, stats.stages[RC522_STATS_STAGE_MIFARE_AUTH].count);
+    TEST_ASSERT_EQUAL(1, stats.stages[RC522_STATS_STAGE_READ].count);
+    TEST_ASSERT_EQUAL(1, stats.stages[RC522_STATS_STAGE_WRITE].count);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, stats.stages[RC522_STATS_STAGE_DISPATCH].count);
+
+    for (uint8_t i = 0; i < RC522_STATS_STAGE_COUNT; i++) {
+        const rc522_stage_stats_t *stage = &stats.stages[i];
+        uint32_t histogram_count = 0;
+
+        for (uint8_t bucket = 0; bucket < RC522_STATS_BUCKET_COUNT; bucket++) {
+            histogram_count += stage->histogram[bucket];
+        }
+
+        TEST_ASSERT_EQUAL_MESSAGE(stage->count, histogram_count, rc522_stats_stage_name(i));
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(stage->max_us, stage->min_us, rc522_stats_stage_name(i));
+    }
+
+    // Activation covers the whole anticollision loop
+    TEST_ASSERT_GREATER_THAN(stats.stages[RC522_STATS_STAGE_SELECT].bus_ops,
+        stats.stages[RC522_STATS_STAGE_ACTIVATION].bus_ops);
+    TEST_ASSERT_GREATER_THAN(0, stats.stages[RC522_STATS_STAGE_READ].bus_ops);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_reset_stats(test.scanner));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_get_stats(test.scanner, &stats));
+    TEST_ASSERT_EQUAL(0, stats.stages[RC522_STATS_STAGE_REQA].count);
+    TEST_ASSERT_EQUAL(0, stats.stages[RC522_STATS_STAGE_READ].bus_ops);
+
+    test_emulator_stop(&test);
+}
+
+TEST_CASE("Scan interval backs off while the field is empty", "[emulator][stats]")
+{
+    test_emulator_t test = {
+        .config = {
+            .scan_interval_floor_ms = 10,
+            .scan_interval_ceiling_ms = 80,
+            .scan_backoff_after_ms = 100,
+        },
+    };
+
+    test_emulator_start(&test, &(rc522_emulator_config_t) { 0 });
+
+    rc522_stats_t stats;
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_start(test.scanner));
+    vTaskDelay(pdMS_TO_TICKS(50));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_get_stats(test.scanner, &stats));
+    TEST_ASSERT_EQUAL(10, stats.scan_interval_ms);
+
+    vTaskDelay(pdMS_TO_TICKS(600));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_get_stats(test.scanner, &stats));
+    TEST_ASSERT_EQUAL(80, stats.scan_interval_ms);
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(test.scanner));
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_MIFARE_1K,
+        .uid = { 0x12, 0x34, 0x56, 0x78 },
+        .uid_length = 4,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(test.driver, &picc_config, &index));
+
+    // Arrival resets the interval to the floor
+    test_emulator_wait_for_state(&test, RC522_PICC_STATE_ACTIVE);
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_get_stats(test.scanner, &stats));
+    TEST_ASSERT_EQUAL(10, stats.scan_interval_ms);
+
+    test_emulator_stop(&test);
+}
+#endif
@@ -0,0 +1,273 @@
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "unity.h"
+#include "rc522.h"
+#include "rc522_picc.h"
+#include "rc522_driver_internal.h"
+#include "rc522_recorder_internal.h"
+#include "rc522_picc_internal.h"
+#include "driver/rc522_emulator.h"
+#include "driver/rc522_recorder.h"
+#include "driver/rc522_replay.h"
+#include "picc/rc522_ntag.h"
+
+#define TEST_RECORDER_TIMEOUT_MS  (2000)
+#define TEST_RECORDER_BUFFER_SIZE (16 * 1024)
+
+typedef struct
+{
+    rc522_handle_t scanner;
+    SemaphoreHandle_t done;
+    rc522_picc_t picc;
+    esp_err_t read_ret;
+    uint8_t page[NTAG_PAGE_SIZE];
+} test_recorder_session_t;
+
+static void test_recorder_on_picc_state_changed(void *arg, esp_event_base_t base, int32_t event_id, void *data)
+{
+    test_recorder_session_t *session = (test_recorder_session_t *)arg;
+    rc522_picc_state_changed_event_t *event = (rc522_picc_state_changed_event_t *)data;
+    rc522_picc_t *picc = event->picc;
+
+    if (picc->state != RC522_PICC_STATE_ACTIVE) {
+        return;
+    }
+
+    memcpy(&session->picc, picc, sizeof(rc522_picc_t));
+    session->read_ret = rc522_ntag_read(session->scanner, picc, 4, session->page);
+
+    xSemaphoreGive(session->done);
+}
+
+/**
+ * Runs the scanner until the first PICC is active and its page 4 is read
+ */
+static void test_recorder_run_session(rc522_driver_handle_t driver, test_recorder_session_t *session)
+{
+    session->done = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(session->done);
+
+    rc522_config_t scanner_config = {
+        .driver = driver,
+    };
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_create(&scanner_config, &session->scanner));
+    TEST_ASSERT_EQUAL(ESP_OK,
+        rc522_register_events(
+            session->scanner, RC522_EVENT_PICC_STATE_CHANGED, test_recorder_on_picc_state_changed, session));
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_start(session->scanner));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(session->done, pdMS_TO_TICKS(TEST_RECORDER_TIMEOUT_MS)));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(session->scanner));
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_destroy(session->scanner));
+    vSemaphoreDelete(session->done);
+}
+
+TEST_CASE("Recorded session is replayed without hardware", "[recorder]")
+{
+    rc522_driver_handle_t emulator;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_create(&(rc522_emulator_config_t) { 0 }, &emulator));
+
+    rc522_driver_handle_t recorder;
+    rc522_recorder_config_t recorder_config = {
+        .driver = emulator,
+        .buffer_size = TEST_RECORDER_BUFFER_SIZE,
+    };
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_recorder_create(&recorder_config, &recorder));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_install(recorder));
+
+    rc522_emulator_picc_config_t picc_config = {
+        .type = RC522_EMULATOR_PICC_NTAG213,
+        .uid = { 0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0xF6 },
+        .uid_length = 7,
+    };
+
+    uint8_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_picc_add(emulator, &picc_config, &index));
+
+    test_recorder_session_t recorded = { 0 };
+    test_recorder_run_session(recorder, &recorded);
+    TEST_ASSERT_EQUAL(ESP_OK, recorded.read_ret);
+
+    uint8_t *log = malloc(TEST_RECORDER_BUFFER_SIZE);
+    TEST_ASSERT_NOT_NULL(log);
+
+    size_t log_length;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_recorder_read(recorder, log, TEST_RECORDER_BUFFER_SIZE, &log_length));
+    TEST_ASSERT_GREATER_THAN(0, log_length);
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_uninstall(recorder));
+
+    rc522_driver_handle_t replay;
+    rc522_replay_config_t replay_config = {
+        .log = log,
+        .length = log_length,
+    };
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_replay_create(&replay_config, &replay));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_install(replay));
+
+    test_recorder_session_t replayed = { 0 };
+    test_recorder_run_session(replay, &replayed);
+
+    TEST_ASSERT_EQUAL(ESP_OK, replayed.read_ret);
+    TEST_ASSERT_EQUAL(7, replayed.picc.uid.length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(picc_config.uid, replayed.picc.uid.value, 7);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(recorded.page, replayed.page, NTAG_PAGE_SIZE);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_uninstall(replay));
+    free(log);
+}
+
+TEST_CASE("Replay rejects transaction that differs from the record", "[recorder]")
+{
+    uint8_t log[2 * RC522_RECORD_HEADER_SIZE + 1 + 4];
+    uint8_t written = 0x3D;
+    uint8_t error[4];
+    rc522_record_encode_error(ESP_ERR_TIMEOUT, error);
+
+    rc522_record_t write = { .type = RC522_RECORD_WRITE, .address = 0x11, .length = 1, .payload = &written };
+    rc522_record_encode_header(&write, log);
+    log[RC522_RECORD_HEADER_SIZE] = written;
+
+    rc522_record_t read = {
+        .type = RC522_RECORD_READ | RC522_RECORD_FLAG_ERROR,
+        .address = 0x04,
+        .length = sizeof(error),
+        .payload = error,
+    };
+    rc522_record_encode_header(&read, log + RC522_RECORD_HEADER_SIZE + 1);
+    memcpy(log + 2 * RC522_RECORD_HEADER_SIZE + 1, error, sizeof(error));
+
+    rc522_driver_handle_t replay;
+    TEST_ASSERT_EQUAL(
+        ESP_OK, rc522_replay_create(&(rc522_replay_config_t) { .log = log, .length = sizeof(log) }, &replay));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_install(replay));
+
+    uint8_t value = 0x3D;
+    rc522_bytes_t bytes = { .ptr = &value, .length = 1 };
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_send(replay, 0x11, &bytes));
+
+    // Recorded error is returned instead of the data
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, rc522_driver_receive(replay, 0x04, &bytes));
+
+    bool finished = false;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_replay_finished(replay, &finished));
+    TEST_ASSERT_TRUE(finished);
+
+    TEST_ASSERT_EQUAL(RC522_ERR_REPLAY_MISMATCH, rc522_driver_send(replay, 0x11, &bytes));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_uninstall(replay));
+
+    // Written bytes differ
+    TEST_ASSERT_EQUAL(
+        ESP_OK, rc522_replay_create(&(rc522_replay_config_t) { .log = log, .length = sizeof(log) }, &replay));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_install(replay));
+
+    value = 0x3F;
+    TEST_ASSERT_EQUAL(RC522_ERR_REPLAY_MISMATCH, rc522_driver_send(replay, 0x11, &bytes));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_uninstall(replay));
+}
+
+TEST_CASE("Recorder drops the oldest records when the buffer is full", "[recorder]")
+{
+    const size_t record_size = RC522_RECORD_HEADER_SIZE + 1;
+
+    rc522_driver_handle_t emulator;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_create(&(rc522_emulator_config_t) { 0 }, &emulator));
+
+    rc522_driver_handle_t recorder;
+    rc522_recorder_config_t recorder_config = {
+        .driver = emulator,
+        .buffer_size = 3 * record_size,
+    };
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_recorder_create(&recorder_config, &recorder));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_install(recorder));
+
+    for (uint8_t address = 0x11; address <= 0x15; address++) {
+        uint8_t value = address;
+        rc522_bytes_t bytes = { .ptr = &value, .length = 1 };
+
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_send(recorder, address, &bytes));
+    }
+
+    uint8_t log[3 * record_size];
+    size_t log_length;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, rc522_recorder_read(recorder, log, sizeof(log) - 1, &log_length));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_recorder_read(recorder, log, sizeof(log), &log_length));
+    TEST_ASSERT_EQUAL(sizeof(log), log_length);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        rc522_record_t record;
+
+        TEST_ASSERT_EQUAL(ESP_OK, rc522_record_decode(log, log_length, i * record_size, &record));
+        TEST_ASSERT_EQUAL(RC522_RECORD_WRITE, record.type);
+        TEST_ASSERT_EQUAL(0x13 + i, record.address);
+        TEST_ASSERT_EQUAL(0x13 + i, record.payload[0]);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_recorder_clear(recorder));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_recorder_read(recorder, log, sizeof(log), &log_length));
+    TEST_ASSERT_EQUAL(0, log_length);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_uninstall(recorder));
+}
+
+TEST_CASE("Timer reload is written only when the timeout changes", "[recorder]")
+{
+    rc522_driver_handle_t emulator;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_emulator_create(&(rc522_emulator_config_t) { 0 }, &emulator));
+
+    rc522_driver_handle_t recorder;
+    rc522_recorder_config_t recorder_config = {
+        .driver = emulator,
+        .buffer_size = TEST_RECORDER_BUFFER_SIZE,
+    };
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_recorder_create(&recorder_config, &recorder));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_install(recorder));
+
+    rc522_handle_t scanner;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_create(&(rc522_config_t) { .driver = recorder }, &scanner));
+
+    // Empty field, scanner keeps sending REQA
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_start(scanner));
+    vTaskDelay(pdMS_TO_TICKS(500));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_pause(scanner));
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_destroy(scanner));
+
+    uint8_t *log = malloc(TEST_RECORDER_BUFFER_SIZE);
+    TEST_ASSERT_NOT_NULL(log);
+
+    size_t log_length;
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_recorder_read(recorder, log, TEST_RECORDER_BUFFER_SIZE, &log_length));
+
+    uint16_t reqa_count = 0;
+    uint16_t reload_writes = 0;
+    rc522_record_t record;
+
+    for (size_t offset = 0; rc522_record_decode(log, log_length, offset, &record) == ESP_OK;
+         offset += RC522_RECORD_HEADER_SIZE + record.length) {
+        if ((record.type & RC522_RECORD_TYPE_MASK) != RC522_RECORD_WRITE) {
+            continue;
+        }
+
+        if (record.address == RC522_PCD_FIFO_DATA_REG && record.payload[0] == RC522_PICC_CMD_REQA) {
+            reqa_count++;
+        }
+
+        if (record.address == RC522_PCD_TIMER_RELOAD_MSB_REG || record.address == RC522_PCD_TIMER_RELOAD_LSB_REG) {
+            reload_writes++;
+        }
+    }
+
+    // Default timeout set by the init, and the short one set by the first REQA
+    TEST_ASSERT_GREATER_THAN(1, reqa_count);
+    TEST_ASSERT_EQUAL(4, reload_writes);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rc522_driver_uninstall(recorder));
+    free(log);
+}